@@ -22,6 +22,12 @@
 #define MOTOR_DRIVER_SLEEP_PIN GPIO_NUM_17
 #define EXTRA_IO_PIN           GPIO_NUM_14
 
+// I2C buses of the PWM expanders
+#define I2C0_SDA_PIN GPIO_NUM_21
+#define I2C0_SCL_PIN GPIO_NUM_22
+#define I2C1_SDA_PIN GPIO_NUM_18 // Second bus for additional expanders
+#define I2C1_SCL_PIN GPIO_NUM_4
+
 // Lights connected directly to ESP32
 #define BOOM_LIGHTS_PIN  GPIO_NUM_26
 #define BEACON_LIGHT_PIN GPIO_NUM_13
@@ -33,27 +39,7 @@
 #define ROOF_BACK_LIGHTS_PIN  2
 #define ROOF_FRONT_LIGHTS_PIN 3
 
-// Limit switches
-#define BOOM_LOW_LIMIT_PIN        GPIO_NUM_19
-#define BOOM_HIGH_LIMIT_PIN       GPIO_NUM_23
-#define BUCKET_ROLL_IN_LIMIT_PIN  GPIO_NUM_33
-#define BUCKET_ROLL_OUT_LIMIT_PIN GPIO_NUM_25
-#define STICK_ROLL_IN_LIMIT_PIN   GPIO_NUM_27
-#define STICK_ROLL_OUT_LIMIT_PIN  GPIO_NUM_12
-#define SWING_CENTER_SWITCH_PIN   GPIO_NUM_32
-
-// Motor driver pins connected via expander
-#define BOOM_MOTOR_POS_PIN         14
-#define BOOM_MOTOR_NEG_PIN         15
-#define BUCKET_MOTOR_POS_PIN       10
-#define BUCKET_MOTOR_NEG_PIN       11
-#define STICK_MOTOR_POS_PIN        9
-#define STICK_MOTOR_NEG_PIN        8
-#define SWING_MOTOR_POS_PIN        12
-#define SWING_MOTOR_NEG_PIN        13
-#define LEFT_TRAVEL_MOTOR_POS_PIN  6
-#define LEFT_TRAVEL_MOTOR_NEG_PIN  7
-#define RIGHT_TRAVEL_MOTOR_POS_PIN 5
-#define RIGHT_TRAVEL_MOTOR_NEG_PIN 4
+// Swing center switch. Motor pins and limit switches are described in machine_config.h
+#define SWING_CENTER_SWITCH_PIN GPIO_NUM_32
 
 #endif // _CONSTANTS_H
\ No newline at end of file
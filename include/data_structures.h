@@ -13,10 +13,17 @@
 #include <stdint.h>
 
 #include "constants.h"
+#include "telemetry.h"
 
 // The structure type of the data that will be sent over ESP-NOW from the Controller to the Excavator
 typedef struct controller_data_struct
 {
+    /*
+     * Replay protection. The epoch must increase with every Controller boot, e.g. a boot count kept
+     * in its NVS, and the counter with every frame of the epoch. The counter may restart in a new epoch.
+     */
+    uint32_t epoch;
+    uint32_t counter;
     /*
      * The lever positions are stored in an array of 6 elements.
      * The order of the levers is as follows:
@@ -43,8 +50,12 @@ typedef struct controller_data_struct
 // The structure type of the data that will be sent over ESP-NOW from the Excavator to the Controller
 typedef struct excavator_data_struct
 {
-    uint16_t uptime;  // Uptime of the Excavator in seconds
-    uint16_t battery; // Battery level of the Excavator
+    uint32_t counter; // Frame counter for replay protection
+    /*
+     * Encoded telemetry, see telemetry.h. The frame length varies,
+     * only the counter and the used telemetry bytes are sent.
+     */
+    uint8_t telemetry[TELEMETRY_MAX_SIZE];
 } excavator_data_struct;
 
 #endif // DATA_STRUCTURES_H
\ No newline at end of file
@@ -0,0 +1,158 @@
+/**
+ * @file machine_config.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MACHINE_CONFIG_H
+#define MACHINE_CONFIG_H
+
+#include <Arduino.h>
+
+#include "constants.h"
+
+// Lever indexes in controller_data_struct::leverPositions
+enum LeverIndex : uint8_t
+{
+    BOOM_LEVER,
+    BUCKET_LEVER,
+    STICK_LEVER,
+    SWING_LEVER,
+    LEFT_TRAVEL_LEVER,
+    RIGHT_TRAVEL_LEVER
+};
+
+// Axis indexes in MACHINE_AXES
+enum AxisIndex : uint8_t
+{
+    BOOM_AXIS,
+    BUCKET_AXIS,
+    STICK_AXIS,
+    SWING_AXIS,
+    LEFT_TRAVEL_AXIS,
+    RIGHT_TRAVEL_AXIS,
+    // Total number of axes
+    AXIS_COUNT
+};
+
+// Output that drives the motor driver inputs of an axis
+enum MotorOutput : uint8_t
+{
+    MOTOR_OUTPUT_EXPANDER, // PCA9685 channels, updated by the PWM task over I2C
+    MOTOR_OUTPUT_LEDC      // ESP32 GPIOs driven by LEDC channels, updated immediately
+};
+
+// Description of one motor axis
+struct AxisConfig
+{
+    const char *name;
+    MotorOutput output;
+    uint8_t posMotorPin;    // Positive motor terminal: expander channel or GPIO, depending on the output
+    uint8_t negMotorPin;    // Negative motor terminal: expander channel or GPIO, depending on the output
+    bool breakMode;         // Brake instead of coasting when stopped
+    bool reverse;           // Reverse the motor direction
+    gpio_num_t posLimitPin; // Limit switch stopping the positive direction
+    gpio_num_t negLimitPin; // Limit switch stopping the negative direction
+    gpio_num_t centerPin;   // Switch in the middle of the travel, recalibrates the position estimate
+    uint8_t leverIndex;     // Lever that controls the axis
+    int16_t deadband;       // Lever values up to this are treated as neutral
+    int16_t maxSpeed;       // Speed at the full lever deflection, 255 keeps the lever value
+    uint16_t travelMs;      // Full travel at the maximum speed, 0 if the axis has no end of travel
+    uint16_t slowZone;      // Part of the travel before an end in which the speed is reduced, up to 500 permille
+};
+
+// Motor driver pins are connected via expander, limit switches directly to ESP32.
+// An axis wired to free GPIOs can use MOTOR_OUTPUT_LEDC to bypass the I2C bus.
+// The travel times are measured at the full speed without load. The travel axes have no ends.
+constexpr AxisConfig MACHINE_AXES[] = {
+    [BOOM_AXIS] = {.name = "boom",
+        .output = MOTOR_OUTPUT_EXPANDER,
+        .posMotorPin = 14,
+        .negMotorPin = 15,
+        .breakMode = true,
+        .reverse = false,
+        .posLimitPin = GPIO_NUM_19,
+        .negLimitPin = GPIO_NUM_23,
+        .centerPin = GPIO_NUM_NC,
+        .leverIndex = BOOM_LEVER,
+        .deadband = 0,
+        .maxSpeed = 255,
+        .travelMs = 4000,
+        .slowZone = 150},
+    [BUCKET_AXIS] = {.name = "bucket",
+        .output = MOTOR_OUTPUT_EXPANDER,
+        .posMotorPin = 10,
+        .negMotorPin = 11,
+        .breakMode = true,
+        .reverse = false,
+        .posLimitPin = GPIO_NUM_33,
+        .negLimitPin = GPIO_NUM_25,
+        .centerPin = GPIO_NUM_NC,
+        .leverIndex = BUCKET_LEVER,
+        .deadband = 0,
+        .maxSpeed = 255,
+        .travelMs = 3000,
+        .slowZone = 150},
+    [STICK_AXIS] = {.name = "stick",
+        .output = MOTOR_OUTPUT_EXPANDER,
+        .posMotorPin = 9,
+        .negMotorPin = 8,
+        .breakMode = true,
+        .reverse = true,
+        .posLimitPin = GPIO_NUM_27,
+        .negLimitPin = GPIO_NUM_12,
+        .centerPin = GPIO_NUM_NC,
+        .leverIndex = STICK_LEVER,
+        .deadband = 0,
+        .maxSpeed = 255,
+        .travelMs = 3500,
+        .slowZone = 150},
+    [SWING_AXIS] = {.name = "swing",
+        .output = MOTOR_OUTPUT_EXPANDER,
+        .posMotorPin = 12,
+        .negMotorPin = 13,
+        .breakMode = false,
+        .reverse = true,
+        .posLimitPin = GPIO_NUM_NC,
+        .negLimitPin = GPIO_NUM_NC,
+        .centerPin = SWING_CENTER_SWITCH_PIN,
+        .leverIndex = SWING_LEVER,
+        .deadband = 0,
+        .maxSpeed = 255,
+        .travelMs = 9000,
+        .slowZone = 100},
+    [LEFT_TRAVEL_AXIS] = {.name = "left travel",
+        .output = MOTOR_OUTPUT_EXPANDER,
+        .posMotorPin = 6,
+        .negMotorPin = 7,
+        .breakMode = true,
+        .reverse = true,
+        .posLimitPin = GPIO_NUM_NC,
+        .negLimitPin = GPIO_NUM_NC,
+        .centerPin = GPIO_NUM_NC,
+        .leverIndex = LEFT_TRAVEL_LEVER,
+        .deadband = 0,
+        .maxSpeed = 255,
+        .travelMs = 0,
+        .slowZone = 0},
+    [RIGHT_TRAVEL_AXIS] = {.name = "right travel",
+        .output = MOTOR_OUTPUT_EXPANDER,
+        .posMotorPin = 5,
+        .negMotorPin = 4,
+        .breakMode = true,
+        .reverse = true,
+        .posLimitPin = GPIO_NUM_NC,
+        .negLimitPin = GPIO_NUM_NC,
+        .centerPin = GPIO_NUM_NC,
+        .leverIndex = RIGHT_TRAVEL_LEVER,
+        .deadband = 0,
+        .maxSpeed = 255,
+        .travelMs = 0,
+        .slowZone = 0}};
+
+static_assert(sizeof(MACHINE_AXES) / sizeof(MACHINE_AXES[0]) == AXIS_COUNT, "Every axis must be described");
+
+#endif // MACHINE_CONFIG_H
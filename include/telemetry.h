@@ -0,0 +1,245 @@
+/**
+ * @file telemetry.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Telemetry sent from the Excavator to the Controller. This header is shared by both sides.
+ *
+ * Frame layout:
+ *   byte 0 - flags: TELEMETRY_FLAG_KEYFRAME and the format version in the low bits
+ *   byte 1 - sequence number of the keyframe the frame refers to
+ *   then entries of the field ID followed by the zigzag varint of the value
+ *
+ * A keyframe carries the absolute values of all fields. Other frames carry the difference to the
+ * referenced keyframe, so a lost frame never corrupts the following ones. Fast fields are sent
+ * in every frame, slow fields take turns. Fields that are not in a frame keep their last value.
+ */
+
+#define TELEMETRY_VERSION           1
+#define TELEMETRY_FLAG_KEYFRAME     0x80
+#define TELEMETRY_VERSION_MASK      0x0F
+#define TELEMETRY_HEADER_SIZE       2
+#define TELEMETRY_MAX_SIZE          244 // ESP-NOW payload without the frame counter and padding
+#define TELEMETRY_KEYFRAME_INTERVAL 50  // Frames between keyframes
+#define TELEMETRY_SLOW_PER_FRAME    3   // Slow fields sent in every frame
+#define TELEMETRY_MAX_ENTRY_SIZE    6   // Field ID and a 32-bit varint
+
+enum TelemetryField : uint8_t
+{
+    // Fast fields
+    TLM_BOOM_DUTY,           // Commanded motor speeds in the range of -255 to 255
+    TLM_BUCKET_DUTY,
+    TLM_STICK_DUTY,
+    TLM_SWING_DUTY,
+    TLM_LEFT_TRAVEL_DUTY,
+    TLM_RIGHT_TRAVEL_DUTY,
+    TLM_LIMITS,              // Limit switches, two bits per lever: positive, then negative
+    TLM_FAULTS,              // Bitmask of TLM_FAULT_* flags
+    TLM_OTA_STATE,           // See OtaState
+    TLM_OTA_PROGRESS,        // Percent
+    // Slow fields
+    TLM_UPTIME,              // Seconds
+    TLM_BATTERY,             // Millivolts
+    TLM_LIGHT_MODE,          // See LightMode
+    TLM_LOOP_US,             // Duration of the last limit switch and position update
+    TLM_LOOP_MAX_US,         // Longest limit switch and position update
+    TLM_I2C_ERRORS,          // Failed I2C transactions of the PWM expanders
+    TLM_I2C_RECOVERIES,      // I2C bus recoveries
+    TLM_LINK_ACCEPTED,       // Accepted Controller frames
+    TLM_LINK_REJECTED,       // Rejected Controller frames of all reasons
+    TLM_LINK_RX_PATH_MAX_US, // Longest receive path duration
+    // Total number of fields
+    TLM_FIELD_COUNT
+};
+
+// First slow field, the fields before it are sent in every frame
+#define TLM_FIRST_SLOW_FIELD TLM_UPTIME
+
+// Fault flags
+#define TLM_FAULT_PWM          (1 << 0) // PWM output has failed, all motors are stopped
+#define TLM_FAULT_EXPANDER     (1 << 1) // PWM expander did not respond after initialization
+#define TLM_FAULT_UNENCRYPTED  (1 << 2) // ESP-NOW link keys are not provisioned
+#define TLM_FAULT_OTA_PARKED   (1 << 3) // Actuators are parked for an OTA update
+
+static_assert(TELEMETRY_HEADER_SIZE + TLM_FIELD_COUNT * TELEMETRY_MAX_ENTRY_SIZE <= TELEMETRY_MAX_SIZE,
+              "Keyframe does not fit into one frame");
+
+// Write the zigzag varint of the value, return the number of bytes written
+inline size_t telemetryPutVarint(int32_t value, uint8_t *out)
+{
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    size_t len = 0;
+
+    while (zigzag >= 0x80)
+    {
+        out[len++] = (zigzag & 0x7F) | 0x80;
+        zigzag >>= 7;
+    }
+    out[len++] = zigzag;
+    return len;
+}
+
+// Read the zigzag varint, return the number of bytes read or 0 if the data ends
+inline size_t telemetryGetVarint(const uint8_t *data, size_t len, int32_t *value)
+{
+    uint32_t zigzag = 0;
+
+    for (size_t i = 0; i < len && i < 5; i++)
+    {
+        zigzag |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80))
+        {
+            *value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Builds the telemetry frames on the Excavator.
+ */
+class TelemetryEncoder
+{
+public:
+    TelemetryEncoder() : _keySequence(0), _framesSinceKey(TELEMETRY_KEYFRAME_INTERVAL), _slowCursor(0)
+    {
+        memset(_key, 0, sizeof(_key));
+    }
+
+    /**
+     * @brief Encode the next frame.
+     *
+     * @param values Current values of all fields.
+     * @param out Output buffer of TELEMETRY_MAX_SIZE bytes.
+     * @return Number of bytes to send.
+     */
+    size_t encode(const int32_t values[TLM_FIELD_COUNT], uint8_t out[TELEMETRY_MAX_SIZE])
+    {
+        bool keyframe = _framesSinceKey >= TELEMETRY_KEYFRAME_INTERVAL;
+        size_t len = 0;
+
+        if (keyframe)
+        {
+            _keySequence++;
+            _framesSinceKey = 0;
+            memcpy(_key, values, sizeof(_key));
+        }
+        _framesSinceKey++;
+
+        out[len++] = (keyframe ? TELEMETRY_FLAG_KEYFRAME : 0) | TELEMETRY_VERSION;
+        out[len++] = _keySequence;
+
+        for (uint8_t field = 0; field < TLM_FIELD_COUNT; field++)
+        {
+            if (keyframe || field < TLM_FIRST_SLOW_FIELD)
+                len += _putEntry(field, keyframe ? values[field] : _delta(values[field], _key[field]), out + len);
+        }
+
+        // Slow fields take turns in the frames between keyframes
+        if (!keyframe)
+        {
+            const uint8_t slowCount = TLM_FIELD_COUNT - TLM_FIRST_SLOW_FIELD;
+            for (uint8_t i = 0; i < TELEMETRY_SLOW_PER_FRAME && i < slowCount; i++)
+            {
+                uint8_t field = TLM_FIRST_SLOW_FIELD + _slowCursor;
+                _slowCursor = (_slowCursor + 1) % slowCount;
+                len += _putEntry(field, _delta(values[field], _key[field]), out + len);
+            }
+        }
+        return len;
+    }
+
+private:
+    // Difference with the wraparound, e.g. for the counters
+    static int32_t _delta(int32_t value, int32_t key)
+    {
+        return (int32_t)((uint32_t)value - (uint32_t)key);
+    }
+
+    static size_t _putEntry(uint8_t field, int32_t value, uint8_t *out)
+    {
+        out[0] = field;
+        return 1 + telemetryPutVarint(value, out + 1);
+    }
+
+    int32_t _key[TLM_FIELD_COUNT];
+    uint8_t _keySequence;
+    uint8_t _framesSinceKey;
+    uint8_t _slowCursor;
+};
+
+/**
+ * @brief Restores the telemetry values on the Controller.
+ */
+class TelemetryDecoder
+{
+public:
+    TelemetryDecoder() : _hasKey(false), _keySequence(0)
+    {
+        memset(_key, 0, sizeof(_key));
+        memset(_values, 0, sizeof(_values));
+    }
+
+    /**
+     * @brief Decode a received frame.
+     * Frames that refer to a keyframe that was not received are dropped until the next keyframe.
+     *
+     * @return true if the values were updated.
+     */
+    bool decode(const uint8_t *data, size_t len)
+    {
+        if (len < TELEMETRY_HEADER_SIZE || (data[0] & TELEMETRY_VERSION_MASK) != TELEMETRY_VERSION)
+            return false;
+
+        bool keyframe = data[0] & TELEMETRY_FLAG_KEYFRAME;
+        if (!keyframe && (!_hasKey || data[1] != _keySequence))
+            return false;
+
+        // Parse into a copy, so a malformed frame changes nothing
+        int32_t values[TLM_FIELD_COUNT];
+        memcpy(values, _values, sizeof(values));
+
+        for (size_t pos = TELEMETRY_HEADER_SIZE; pos < len;)
+        {
+            uint8_t field = data[pos++];
+            int32_t value;
+            size_t read = telemetryGetVarint(data + pos, len - pos, &value);
+            if (field >= TLM_FIELD_COUNT || read == 0)
+                return false;
+            pos += read;
+            values[field] = keyframe ? value : (int32_t)((uint32_t)_key[field] + (uint32_t)value);
+        }
+
+        memcpy(_values, values, sizeof(_values));
+        if (keyframe)
+        {
+            memcpy(_key, values, sizeof(_key));
+            _keySequence = data[1];
+            _hasKey = true;
+        }
+        return true;
+    }
+
+    int32_t value(TelemetryField field) const { return _values[field]; }
+
+private:
+    int32_t _key[TLM_FIELD_COUNT];
+    int32_t _values[TLM_FIELD_COUNT];
+    bool _hasKey;
+    uint8_t _keySequence;
+};
+
+#endif // TELEMETRY_H
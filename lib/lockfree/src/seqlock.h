@@ -0,0 +1,86 @@
+/**
+ * @file seqlock.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+/**
+ * @brief Snapshot of a value with one writer and any number of readers.
+ *
+ * The writer never waits. A reader retries while a write is in progress, so it always gets a
+ * consistent copy, e.g. of 64-bit sums or several related counters.
+ * The value is stored as atomic words, so concurrent copies are not data races. The words are ordered
+ * by their own release stores and acquire loads instead of fences, which ThreadSanitizer can check.
+ *
+ * @note A reader must not preempt the writer on the same core with a higher priority,
+ * otherwise it would spin until the writer is scheduled again.
+ *
+ * @tparam T Trivially copyable value type.
+ */
+template <typename T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock needs a trivially copyable type");
+
+public:
+    Seqlock() : _sequence(0)
+    {
+        for (size_t i = 0; i < WORDS; ++i)
+            _words[i].store(0, std::memory_order_relaxed);
+    }
+
+    // Publish a new value. Must be called from one task only.
+    void write(const T &value)
+    {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+
+        // A reader that sees any new word also sees the odd sequence
+        for (size_t i = 0; i < WORDS; ++i)
+            _words[i].store(words[i], std::memory_order_release);
+
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Get a consistent copy of the last published value
+    T read() const
+    {
+        uint32_t words[WORDS];
+        uint32_t before, after;
+
+        do
+        {
+            before = _sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; ++i)
+                words[i] = _words[i].load(std::memory_order_acquire);
+            after = _sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> _sequence; // Odd while a write is in progress
+    std::atomic<uint32_t> _words[WORDS];
+};
+
+#endif // SEQLOCK_H
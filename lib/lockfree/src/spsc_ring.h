@@ -0,0 +1,79 @@
+/**
+ * @file spsc_ring.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Bounded FIFO with one producer and one consumer.
+ *
+ * Neither side blocks or disables interrupts, so the producer may be an ISR.
+ * A full ring rejects new elements, the consumer never sees a partially written element.
+ *
+ * @tparam T Element type.
+ * @tparam N Capacity, must be a power of two.
+ */
+template <typename T, size_t N>
+class SpscRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : _head(0), _tail(0), _dropped(0) {}
+
+    // Add an element. Must be called from the producer only.
+    bool push(const T &value)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= N)
+        {
+            _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _buffer[head & (N - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Take the oldest element. Must be called from the consumer only.
+    bool pop(T &value)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+
+        value = _buffer[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+    // Number of elements rejected because the ring was full
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    T _buffer[N];
+    std::atomic<uint32_t> _head; // Written by the producer
+    std::atomic<uint32_t> _tail; // Written by the consumer
+    std::atomic<uint32_t> _dropped;
+};
+
+#endif // SPSC_RING_H
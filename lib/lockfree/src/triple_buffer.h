@@ -0,0 +1,64 @@
+/**
+ * @file triple_buffer.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Latest value handoff with one producer and one consumer.
+ *
+ * The producer always writes into its own buffer and the consumer always reads from its own
+ * buffer, the third one is swapped between them. Neither side waits and old values are skipped,
+ * which suits control data where only the newest value matters.
+ *
+ * @tparam T Value type.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : _back(0), _middle(1), _front(2) {}
+
+    // Publish a new value. Must be called from the producer only.
+    void write(const T &value)
+    {
+        _buffers[_back] = value;
+        _back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+     * @brief Take the newest value. Must be called from the consumer only.
+     *
+     * @param value Output: the newest value, unchanged if nothing new was written.
+     * @return true if a new value was written since the last read.
+     */
+    bool read(T &value)
+    {
+        if (!(_middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX_MASK;
+        value = _buffers[_front];
+        return true;
+    }
+
+private:
+    static constexpr uint32_t FRESH = 0x4; // Set in _middle when the producer swapped in a new value
+    static constexpr uint32_t INDEX_MASK = 0x3;
+
+    T _buffers[3];
+    uint32_t _back;               // Owned by the producer
+    std::atomic<uint32_t> _middle; // Index of the shared buffer and the FRESH flag
+    uint32_t _front;              // Owned by the consumer
+};
+
+#endif // TRIPLE_BUFFER_H
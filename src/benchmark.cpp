@@ -0,0 +1,367 @@
+/**
+ * @file benchmark.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "benchmark.h"
+
+#ifdef BENCHMARK
+
+#include "data_structures.h"
+#include "lights.h"
+#include "limit_debouncer.h"
+#include "link_security.h"
+#include "logger.h"
+#include "machine.h"
+#include "peer_arbiter.h"
+#include "pwm_controller.h"
+#include "pwm_scheduler.h"
+#include "travel_mixer.h"
+
+// Passed by the benchmark environment
+#ifndef BENCHMARK_COMMIT
+#define BENCHMARK_COMMIT "unknown"
+#endif
+
+// Benchmark parameters
+#define BENCHMARK_WARMUP            100
+#define BENCHMARK_ITERATIONS        2000
+#define BENCHMARK_MAX_RESULTS       16
+#define BENCHMARK_FRAME_TIMEOUT_US  20000 // Longest wait for the expander frame of one output change
+#define BENCHMARK_BOOT_TIMEOUT_MS   1000  // Longest wait for the first expander frame after the boot
+
+struct BenchmarkCase
+{
+    const char *name;
+    void (*run)(uint32_t iteration);
+};
+
+struct BenchmarkResult
+{
+    const char *name;
+    double meanNs;
+    double minNs;
+    double maxNs;
+    double stddevNs; // Jitter of the samples
+    double cycles;   // Mean cycles
+    uint32_t minCycles;
+};
+
+// Benchmarked motor, its outputs are not connected while the drivers sleep
+Motor *benchMotor = NULL;
+
+// Motors of the output latency cases. The expander motor drives the roof lights of the first expander,
+// the LEDC motor the first two free LEDC channels without pins attached, so nothing moves.
+constexpr AxisConfig BENCH_EXPANDER_AXIS = {.name = "bench expander",
+                                            .output = MOTOR_OUTPUT_EXPANDER,
+                                            .posMotorPin = ROOF_BACK_LIGHTS_PIN,
+                                            .negMotorPin = ROOF_FRONT_LIGHTS_PIN,
+                                            .breakMode = false,
+                                            .reverse = false,
+                                            .posLimitPin = GPIO_NUM_NC,
+                                            .negLimitPin = GPIO_NUM_NC,
+                                            .centerPin = GPIO_NUM_NC,
+                                            .leverIndex = BOOM_LEVER,
+                                            .deadband = 0,
+                                            .maxSpeed = 255,
+                                            .travelMs = 0,
+                                            .slowZone = 0};
+constexpr AxisConfig BENCH_LEDC_AXIS = {.name = "bench ledc",
+                                        .output = MOTOR_OUTPUT_LEDC,
+                                        .posMotorPin = PWM_NC_PIN,
+                                        .negMotorPin = PWM_NC_PIN,
+                                        .breakMode = false,
+                                        .reverse = false,
+                                        .posLimitPin = GPIO_NUM_NC,
+                                        .negLimitPin = GPIO_NUM_NC,
+                                        .centerPin = GPIO_NUM_NC,
+                                        .leverIndex = BOOM_LEVER,
+                                        .deadband = 0,
+                                        .maxSpeed = 255,
+                                        .travelMs = 0,
+                                        .slowZone = 0};
+
+constexpr uint8_t BENCH_LEDC_CHANNEL = ledcChannelOf(MACHINE_AXES, AXIS_COUNT);
+static_assert(BENCH_LEDC_CHANNEL + 2 <= MOTOR_LEDC_CHANNELS, "No free LEDC channels for the benchmark");
+
+Motor benchExpanderMotor(BENCH_EXPANDER_AXIS);
+Motor benchLedcMotor(BENCH_LEDC_AXIS, BENCH_LEDC_CHANNEL);
+
+// Results of all stages, printed together
+BenchmarkResult benchResults[BENCHMARK_MAX_RESULTS];
+size_t benchResultsCount = 0;
+uint32_t benchOverhead = 0;
+
+// Receive path state, a copy of the one in esp_now_manager.cpp
+const uint8_t benchMac[PEER_MAC_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+PeerArbiter benchArbiter;
+ReplayWindow benchReplay;
+portMUX_TYPE benchMux = portMUX_INITIALIZER_UNLOCKED;
+controller_data_struct benchFrame;
+controller_data_struct benchParsed;
+uint32_t benchCounter = 0;
+
+PwmScheduler benchScheduler;
+LimitDebouncer benchDebouncer;
+
+// Results are accumulated here, so the compiler can't remove the benchmarked code
+volatile uint32_t benchSink = 0;
+
+const int16_t BENCH_SPEEDS[] = {0, 64, 128, 255, -32, -128, -255, 16};
+
+void _benchBaseline(uint32_t iteration)
+{
+    benchSink = iteration;
+}
+
+/**
+ * @brief Filter and copy a Controller frame like the ESP-NOW receive callback.
+ */
+void _benchFrameParse(uint32_t iteration)
+{
+    benchFrame.counter = ++benchCounter;
+    const uint8_t *data = (const uint8_t *)&benchFrame;
+
+    portENTER_CRITICAL(&benchMux);
+    int index = benchArbiter.findPeer(benchMac);
+    portEXIT_CRITICAL(&benchMux);
+
+    uint32_t epoch, counter;
+    memcpy(&epoch, data + offsetof(controller_data_struct, epoch), sizeof(epoch));
+    memcpy(&counter, data + offsetof(controller_data_struct, counter), sizeof(counter));
+
+    portENTER_CRITICAL(&benchMux);
+    bool fresh = index >= 0 && benchReplay.check(epoch, counter);
+    PeerFrameResult result = fresh ? benchArbiter.onFrame(benchMac, millis()) : PEER_REJECTED_UNKNOWN;
+    portEXIT_CRITICAL(&benchMux);
+
+    if (result == PEER_ACCEPTED || result == PEER_ACCEPTED_HANDOVER)
+        memcpy(&benchParsed, data, sizeof(benchParsed));
+}
+
+void _benchTravelMix(uint32_t iteration)
+{
+    int16_t left = BENCH_SPEEDS[iteration % 8];
+    int16_t right = BENCH_SPEEDS[(iteration + 3) % 8];
+    travelMix(TRAVEL_MIXER_DEFAULTS, left, right);
+    benchSink = left + right;
+}
+
+void _benchMotorSetSpeed(uint32_t iteration)
+{
+    benchMotor->setSpeed(BENCH_SPEEDS[iteration % 8]);
+}
+
+void _benchLimitUpdate(uint32_t iteration)
+{
+    benchMotor->updateLimitSwitches(false);
+    benchMotor->updatePosition();
+}
+
+/**
+ * @brief Debounce a burst of five edges that ends on the opposite level.
+ */
+void _benchLimitBurst(uint32_t iteration)
+{
+    uint32_t start = iteration * 100000;
+    bool level = !benchDebouncer.state();
+
+    for (uint8_t i = 0; i < 5; i++)
+        benchDebouncer.edge(start + i * 300, i % 2 == 0 ? level : !level);
+    benchSink = benchDebouncer.update(start + 50000);
+}
+
+/**
+ * @brief Encode the changes of one motor and two lights into the expander bursts.
+ */
+void _benchPwmEncode(uint32_t iteration)
+{
+    uint16_t values[PWM_CHANNELS_PER_EXPANDER];
+    uint8_t buffer[PWM_BURST_BUFFER_SIZE];
+    uint8_t first = 0;
+    uint8_t count;
+
+    benchScheduler.set(14, iteration & 0xFFF);
+    benchScheduler.set(15, ~iteration & 0xFFF);
+    benchScheduler.set(0, iteration & 0x7FF);
+    benchScheduler.set(3, iteration & 0x3FF);
+    uint16_t mask = benchScheduler.take(0, values);
+
+    while (PwmScheduler::nextRun(mask, &first, &count))
+    {
+        benchSink = benchSink + PwmScheduler::encodeRun(values, benchScheduler.phases(0), first, count, buffer);
+        first += count;
+    }
+}
+
+void _benchLightsTick(uint32_t iteration)
+{
+    lightsTick();
+}
+
+/**
+ * @brief Change the speed of the expander motor and wait until the PWM task has written it.
+ * The lights are on the first expander, written by the task of bus 0.
+ */
+void _benchExpanderOutput(uint32_t iteration)
+{
+    uint32_t frames = pwmGetBusStats(0).frames;
+    uint32_t start = micros();
+
+    benchExpanderMotor.setSpeed(BENCH_SPEEDS[iteration % 8]);
+    while (pwmGetBusStats(0).frames == frames && micros() - start < BENCHMARK_FRAME_TIMEOUT_US)
+    {
+    }
+}
+
+/**
+ * @brief Change the speed of the LEDC motor. The duty is latched by the LEDC at the end of its current period.
+ */
+void _benchLedcOutput(uint32_t iteration)
+{
+    benchLedcMotor.setSpeed(BENCH_SPEEDS[iteration % 8]);
+}
+
+const BenchmarkCase outputCases[] = {
+    {"BM_OutputLatencyLedc", _benchLedcOutput},
+    {"BM_OutputLatencyExpander", _benchExpanderOutput},
+};
+
+const BenchmarkCase benchmarkCases[] = {
+    {"BM_FrameParse", _benchFrameParse},
+    {"BM_TravelMix", _benchTravelMix},
+    {"BM_MotorSetSpeed", _benchMotorSetSpeed},
+    {"BM_LimitUpdate", _benchLimitUpdate},
+    {"BM_LimitDebounceBurst", _benchLimitBurst},
+    {"BM_PwmEncode", _benchPwmEncode},
+    {"BM_LightsTick", _benchLightsTick},
+};
+
+/**
+ * @brief Run a case and measure every iteration with the CPU cycle counter.
+ *
+ * @param overhead Cycles of the measurement itself, subtracted from every sample.
+ */
+BenchmarkResult _runCase(const BenchmarkCase &benchCase, uint32_t overhead)
+{
+    for (uint32_t i = 0; i < BENCHMARK_WARMUP; i++)
+        benchCase.run(i);
+
+    uint32_t minCycles = UINT32_MAX;
+    uint32_t maxCycles = 0;
+    uint64_t totalCycles = 0;
+    uint64_t squaredCycles = 0;
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        uint32_t start = ESP.getCycleCount();
+        benchCase.run(BENCHMARK_WARMUP + i);
+        uint32_t cycles = ESP.getCycleCount() - start;
+
+        cycles = cycles > overhead ? cycles - overhead : 0;
+        if (cycles < minCycles)
+            minCycles = cycles;
+        if (cycles > maxCycles)
+            maxCycles = cycles;
+        totalCycles += cycles;
+        squaredCycles += (uint64_t)cycles * cycles;
+    }
+
+    double mhz = ESP.getCpuFreqMHz();
+    double mean = (double)totalCycles / BENCHMARK_ITERATIONS;
+    double variance = (double)squaredCycles / BENCHMARK_ITERATIONS - mean * mean;
+
+    return BenchmarkResult{benchCase.name, mean * 1000.0 / mhz, minCycles * 1000.0 / mhz, maxCycles * 1000.0 / mhz,
+                           sqrt(max(variance, 0.0)) * 1000.0 / mhz, mean, minCycles};
+}
+
+void _runCases(const BenchmarkCase *cases, size_t count)
+{
+    for (size_t i = 0; i < count && benchResultsCount < BENCHMARK_MAX_RESULTS; i++)
+        benchResults[benchResultsCount++] = _runCase(cases[i], benchOverhead);
+}
+
+void _printResults()
+{
+    logPrintf("{\n  \"context\": {\n");
+    logPrintf("    \"date\": \"%s %s\",\n", __DATE__, __TIME__);
+    logPrintf("    \"host_name\": \"%s\",\n", HOSTNAME);
+    logPrintf("    \"executable\": \"firmware@%s\",\n", BENCHMARK_COMMIT);
+    logPrintf("    \"num_cpus\": 2,\n    \"mhz_per_cpu\": %lu,\n", (unsigned long)ESP.getCpuFreqMHz());
+    logPrintf("    \"cpu_scaling_enabled\": false,\n    \"library_build_type\": \"release\",\n");
+    logPrintf("    \"sdk_version\": \"%s\",\n", ESP.getSdkVersion());
+    logPrintf("    \"overhead_cycles\": %lu\n  },\n  \"benchmarks\": [\n", (unsigned long)benchOverhead);
+
+    for (size_t i = 0; i < benchResultsCount; i++)
+    {
+        const BenchmarkResult &result = benchResults[i];
+        logPrintf("    {\"name\": \"%s\", \"run_name\": \"%s\", \"run_type\": \"iteration\", "
+                  "\"repetitions\": 1, \"repetition_index\": 0, \"threads\": 1, \"iterations\": %d, "
+                  "\"real_time\": %.1f, \"cpu_time\": %.1f, \"time_unit\": \"ns\", "
+                  "\"min_ns\": %.1f, \"max_ns\": %.1f, \"stddev_ns\": %.1f, \"cycles\": %.1f}%s\n",
+                  result.name, result.name, BENCHMARK_ITERATIONS, result.meanNs, result.meanNs, result.minNs,
+                  result.maxNs, result.stddevNs, result.cycles, i + 1 < benchResultsCount ? "," : "");
+    }
+    logPrintf("  ]\n}\n");
+}
+
+/**
+ * @brief Run the benchmarks of the control path. The results are printed by benchmarkRunOutputs().
+ *
+ * The samples include the interrupts, compare the minimums when the means are noisy.
+ *
+ * @param motor Motor of an expander axis. It is stopped afterwards. The motor drivers must sleep and
+ * the PWM task must not run yet, so the outputs are only queued.
+ */
+void benchmarkRun(Motor &motor)
+{
+    benchMotor = &motor;
+    benchArbiter.addPeer(benchMac, PEER_PRIORITY_OPERATOR);
+    memset(&benchFrame, 0, sizeof(benchFrame));
+
+    benchOverhead = _runCase({"baseline", _benchBaseline}, 0).minCycles;
+    _runCases(benchmarkCases, sizeof(benchmarkCases) / sizeof(benchmarkCases[0]));
+
+    motor.stop();
+}
+
+/**
+ * @brief Compare the latency and the jitter of a motor command on the LEDC and the expander output,
+ * then print the results of all benchmarks as Google Benchmark JSON, so they can be compared between
+ * commits with its compare.py tool.
+ *
+ * The expander case is measured from the command to the end of the I2C frame of the PWM task, the
+ * LEDC case to the duty written to the LEDC. The roof lights flicker meanwhile, the motors are not used.
+ *
+ * @note Call after pwmTaskInit() and before the lights task starts.
+ */
+void benchmarkRunOutputs()
+{
+    // The expander case needs the outputs written once after the boot
+    uint32_t start = millis();
+    while (pwmGetBusStats(0).frames == 0 && millis() - start < BENCHMARK_BOOT_TIMEOUT_MS)
+        delay(1);
+
+    ledcSetup(BENCH_LEDC_CHANNEL, MOTOR_LEDC_FREQUENCY, MOTOR_LEDC_RESOLUTION);
+    ledcSetup(BENCH_LEDC_CHANNEL + 1, MOTOR_LEDC_FREQUENCY, MOTOR_LEDC_RESOLUTION);
+
+    if (pwmHasFault() || !pwmIsExpanderReady())
+    {
+        // The LEDC case is the first one
+        logPrintf("PWM expander is not ready, only the LEDC output latency is measured\n");
+        _runCases(outputCases, 1);
+    }
+    else
+    {
+        _runCases(outputCases, sizeof(outputCases) / sizeof(outputCases[0]));
+    }
+
+    benchLedcMotor.stop();
+    benchExpanderMotor.stop();
+    _printResults();
+}
+
+#endif // BENCHMARK
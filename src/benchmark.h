@@ -0,0 +1,31 @@
+/**
+ * @file benchmark.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+
+#include "motor.h"
+
+// The control path is benchmarked on the target only in the benchmark build, see the
+// esp-32s-benchmark environment. The results are printed as Google Benchmark JSON.
+#ifdef BENCHMARK
+
+void benchmarkRun(Motor &motor);
+void benchmarkRunOutputs();
+
+#else
+
+inline void benchmarkRun(Motor &motor) {}
+inline void benchmarkRunOutputs() {}
+
+#endif // BENCHMARK
+
+#endif // BENCHMARK_H
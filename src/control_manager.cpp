@@ -0,0 +1,258 @@
+/**
+ * @file control_manager.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "control_manager.h"
+#include <atomic>
+#include <seqlock.h>
+#include <spsc_ring.h>
+#include <triple_buffer.h>
+
+#include "event_loop.h"
+#include "heap_guard.h"
+#include "logger.h"
+#include "supervisor.h"
+#include "task_plan.h"
+
+// Controller frame with its reception time
+struct ControlFrame
+{
+    controller_data_struct data;
+    uint32_t receivedUs;
+    uint32_t sequence;
+};
+
+control_frame_cb_t controlFrameCallback = NULL;
+control_command_cb_t controlCommandCallback = NULL;
+control_update_cb_t controlUpdateCallback = NULL;
+control_stop_cb_t controlStopCallback = NULL;
+
+// Frames are handed over from the Wi-Fi task on core 0, only the newest one is applied
+TripleBuffer<ControlFrame> controlFrames;
+uint32_t controlSequence = 0;
+TaskHandle_t controlTaskHandle = NULL;
+
+// The macro task plays the levers, only the newest vector matters. The shell commands address
+// single axes, so none of them may be skipped.
+TripleBuffer<ControlCommand> controlMacroCommands;
+SpscRing<ControlCommand, CONTROL_COMMAND_QUEUE_SIZE> controlShellCommands;
+
+// Set by any task, taken by the control task
+std::atomic<bool> controlStopRequested(false);
+
+// Statistics are updated only by the control task
+ControlStats controlStats;
+Seqlock<ControlStats> controlStatsSnapshot;
+
+// Task memory is allocated statically
+StackType_t controlTaskStack[TASK_PLAN[TASK_CONTROL].stackSize];
+StaticTask_t controlTaskBuffer;
+
+void _updateStats(uint32_t latencyUs, uint32_t skipped)
+{
+    ControlStats &stats = controlStats;
+    if (stats.frames == 0 || latencyUs < stats.minUs)
+        stats.minUs = latencyUs;
+    if (latencyUs > stats.maxUs)
+        stats.maxUs = latencyUs;
+    stats.lastUs = latencyUs;
+    stats.sumUs += latencyUs;
+    stats.sumSqUs += (uint64_t)latencyUs * latencyUs;
+    stats.skipped += skipped;
+    stats.frames++;
+}
+
+void _publishStats()
+{
+    controlStats.droppedCommands = controlShellCommands.dropped();
+    controlStatsSnapshot.write(controlStats);
+}
+
+void _applyCommand(const ControlCommand &command)
+{
+    controlCommandCallback(command);
+    controlStats.commands++;
+}
+
+/**
+ * @brief Task function for the control path.
+ *
+ * The task is the only one that drives the motors. It sleeps until the ESP-NOW callback submits
+ * a frame, another task submits a command or requests a stop, a limit switch changes or the motors
+ * need a position update, and handles all of them on core 1, so the control path is not delayed by
+ * the Wi-Fi stack and the other tasks of core 0. When the frames stop coming, e.g. the Controller
+ * was switched off or rebooted, the motors are stopped once instead of keeping the last command.
+ *
+ * @param pvParameters A pointer to task parameters (not used in this function).
+ */
+void controlTask(void *pvParameters)
+{
+    ControlFrame frame;
+    ControlCommand command;
+    uint32_t lastSequence = 0;
+    uint32_t lastFrameMs = 0;
+    uint32_t nextUpdateUs = 0;
+    bool linkAlive = false;
+
+    Serial.println("controlTask started");
+
+    // Main task loop
+    for (;;)
+    {
+        // Wake up at least as often as the supervisor requires
+        eventLoopWait(min(nextUpdateUs, (uint32_t)SUPERVISOR_FEED_INTERVAL_MS * 1000));
+        supervisorFeed();
+
+        if (controlMacroCommands.read(command))
+            _applyCommand(command);
+        while (controlShellCommands.pop(command))
+            _applyCommand(command);
+
+        if (controlFrames.read(frame))
+        {
+            lastFrameMs = millis();
+            linkAlive = true;
+            controlFrameCallback(frame.data);
+
+            uint32_t skipped = lastSequence ? frame.sequence - lastSequence - 1 : 0;
+            lastSequence = frame.sequence;
+            _updateStats(micros() - frame.receivedUs, skipped);
+        }
+        else if (linkAlive && millis() - lastFrameMs > CONTROL_LINK_TIMEOUT_MS)
+        {
+            linkAlive = false;
+            controlStopCallback();
+            controlStats.linkLosses++;
+            logPrintf("Controller link lost, motors stopped\n");
+        }
+
+        // A stop wins over the commands taken in the same cycle
+        if (controlStopRequested.exchange(false, std::memory_order_acquire))
+        {
+            controlStopCallback();
+            controlStats.stopRequests++;
+        }
+
+        nextUpdateUs = controlUpdateCallback();
+        _publishStats();
+    }
+}
+
+/**
+ * @brief Initializes the control task.
+ *
+ * @param frameCallback Function that applies a Controller frame to the machine.
+ * @param commandCallback Function that applies a macro or shell command to the machine.
+ * @param updateCallback Function that updates the limit switches and the positions.
+ * @param stopCallback Function that stops the machine.
+ *
+ * @note This function should be called once during the setup phase of the program,
+ * before the ESP-NOW callback is registered and the limit switch interrupts can wake the task.
+ */
+void controlTaskInit(control_frame_cb_t frameCallback, control_command_cb_t commandCallback,
+                     control_update_cb_t updateCallback, control_stop_cb_t stopCallback)
+{
+    controlFrameCallback = frameCallback;
+    controlCommandCallback = commandCallback;
+    controlUpdateCallback = updateCallback;
+    controlStopCallback = stopCallback;
+
+    controlTaskHandle = xTaskCreateStaticPinnedToCore(controlTask,
+                                                      TASK_PLAN[TASK_CONTROL].name,
+                                                      TASK_PLAN[TASK_CONTROL].stackSize,
+                                                      NULL,
+                                                      TASK_PLAN[TASK_CONTROL].priority,
+                                                      controlTaskStack,
+                                                      &controlTaskBuffer,
+                                                      TASK_PLAN[TASK_CONTROL].core);
+    if (controlTaskHandle == NULL)
+    {
+        Serial.println("Failed to create controlTask");
+    }
+    eventLoopInit(controlTaskHandle);
+    heapGuardProtectTask(controlTaskHandle);
+    taskPlanRegister(TASK_CONTROL, controlTaskHandle);
+}
+
+/**
+ * @brief Hand a Controller frame over to the control task. Never blocks.
+ * @note This function should be called from the ESP-NOW callback only.
+ */
+void controlSubmitFrame(const controller_data_struct &data)
+{
+    if (controlTaskHandle == NULL)
+        return;
+
+    ControlFrame frame = {data, micros(), ++controlSequence};
+    controlFrames.write(frame);
+    eventLoopNotify();
+}
+
+/**
+ * @brief Hand the lever positions of the macro playback over to the control task. Never blocks.
+ * Only the newest positions are applied.
+ * @note This function should be called from the macro task only.
+ */
+void controlSubmitLevers(const int16_t levers[LEVERS_COUNT])
+{
+    ControlCommand command = {CONTROL_COMMAND_LEVERS, 0, 0, {}};
+    memcpy(command.levers, levers, sizeof(command.levers));
+    controlMacroCommands.write(command);
+    eventLoopNotify();
+}
+
+/**
+ * @brief Queue a shell command for the control task. Never blocks.
+ * @note This function should be called from the shell task only.
+ *
+ * @return false if the queue is full.
+ */
+bool controlSubmitCommand(const ControlCommand &command)
+{
+    if (!controlShellCommands.push(command))
+        return false;
+    eventLoopNotify();
+    return true;
+}
+
+/**
+ * @brief Request the control task to stop all motors. Never blocks, may be called from any task.
+ * The requests made before the control task runs are applied in its first cycle.
+ */
+void controlRequestStop()
+{
+    controlStopRequested.store(true, std::memory_order_release);
+    eventLoopNotify();
+}
+
+ControlStats controlGetStats()
+{
+    return controlStatsSnapshot.read();
+}
+
+/**
+ * @brief Print the commands of the other tasks and the control path latency: mean and its standard
+ * deviation as the jitter.
+ */
+void controlPrintStats()
+{
+    ControlStats stats = controlGetStats();
+    logPrintf("Control commands: %lu applied, %lu dropped, %lu stop requests\n", (unsigned long)stats.commands,
+              (unsigned long)stats.droppedCommands, (unsigned long)stats.stopRequests);
+    if (stats.frames == 0)
+        return;
+
+    uint32_t mean = stats.sumUs / stats.frames;
+    int64_t variance = (int64_t)(stats.sumSqUs / stats.frames) - (int64_t)mean * mean;
+    uint32_t jitter = sqrtf(variance > 0 ? variance : 0);
+    logPrintf("Control latency: %lu frames, %lu skipped, mean %lu us, jitter %lu us, min %lu us, max %lu us, "
+              "%lu link losses\n",
+              (unsigned long)stats.frames, (unsigned long)stats.skipped, (unsigned long)mean,
+              (unsigned long)jitter, (unsigned long)stats.minUs, (unsigned long)stats.maxUs,
+              (unsigned long)stats.linkLosses);
+}
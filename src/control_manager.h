@@ -0,0 +1,72 @@
+/**
+ * @file control_manager.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef CONTROL_MANAGER_H
+#define CONTROL_MANAGER_H
+
+#include <Arduino.h>
+
+#include "data_structures.h"
+
+// Motors are stopped when no frame was applied for this time
+#define CONTROL_LINK_TIMEOUT_MS 500
+
+// Shell commands queued between two control cycles
+#define CONTROL_COMMAND_QUEUE_SIZE 8
+
+// Command of another task, applied by the control task which is the only one that drives the motors
+enum ControlCommandType : uint8_t
+{
+    CONTROL_COMMAND_LEVERS, // All axes from the lever positions
+    CONTROL_COMMAND_AXIS,   // One axis with a speed
+};
+
+struct ControlCommand
+{
+    ControlCommandType type;
+    uint8_t axis;
+    int16_t speed;
+    int16_t levers[LEVERS_COUNT];
+};
+
+// Applies a Controller frame to the machine
+typedef void (*control_frame_cb_t)(const controller_data_struct &frame);
+// Applies a command of the macro or the shell task to the machine
+typedef void (*control_command_cb_t)(const ControlCommand &command);
+// Updates the limit switches and the positions, returns the time until the next update is needed
+typedef uint32_t (*control_update_cb_t)();
+// Stops the machine when the Controller frames stop coming or another task requested it
+typedef void (*control_stop_cb_t)();
+
+// Latency from the frame reception to the applied outputs
+struct ControlStats
+{
+    uint32_t frames;
+    uint32_t skipped; // Frames replaced by a newer one before the control task took them
+    uint32_t lastUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint64_t sumSqUs;
+    uint32_t linkLosses; // Times the motors were stopped because the frames stopped coming
+    uint32_t stopRequests; // Stops requested by the other tasks
+    uint32_t commands; // Applied macro and shell commands
+    uint32_t droppedCommands; // Shell commands rejected because the queue was full
+};
+
+void controlTaskInit(control_frame_cb_t frameCallback, control_command_cb_t commandCallback,
+                     control_update_cb_t updateCallback, control_stop_cb_t stopCallback);
+void controlSubmitFrame(const controller_data_struct &frame);
+void controlSubmitLevers(const int16_t levers[LEVERS_COUNT]);
+bool controlSubmitCommand(const ControlCommand &command);
+void controlRequestStop();
+ControlStats controlGetStats();
+void controlPrintStats();
+
+#endif // CONTROL_MANAGER_H
@@ -10,22 +10,297 @@
 #include "esp_now_manager.h"
 #include <esp_now.h>
 #include <WiFi.h>
+#include <Preferences.h>
 
 #include "constants.h"
 #include "data_structures.h"
+#include "link_security.h"
+#include "logger.h"
+#include "peer_arbiter.h"
+#include <atomic>
+#include <seqlock.h>
 
-// The MAC address of the Excavator got from platformio_override.ini
-uint8_t controllerMac[] = {CONTROLLER_MAC};
+// NVS storage of the peers paired at runtime
+#define PEERS_NVS_NAMESPACE "peers"
+#define PEERS_NVS_KEY       "table"
 
-// Create a structure to store the peer information
-esp_now_peer_info_t peerInfo;
+// NVS storage of the link keys
+#define KEYS_NVS_NAMESPACE "espnow_keys"
+#define KEYS_NVS_PMK       "pmk"
+#define KEYS_NVS_LMK       "lmk"
+
+// Receive path budget from the callback entry to the end of the user callback
+#define RX_PATH_BUDGET_US 500
+
+// Encrypted peers are limited by the ESP-NOW stack
+static_assert(PEER_MAX_COUNT <= 6, "ESP-NOW supports up to 6 encrypted peers by default");
+static_assert(sizeof(controller_data_struct) <= ESP_NOW_MAX_DATA_LEN, "Controller frame is too big");
+static_assert(sizeof(excavator_data_struct) <= ESP_NOW_MAX_DATA_LEN, "Excavator frame is too big");
+
+#define MAC_FMT       "%02X:%02X:%02X:%02X:%02X:%02X"
+#define MAC_ARGS(mac) (mac)[0], (mac)[1], (mac)[2], (mac)[3], (mac)[4], (mac)[5]
+
+// The MAC address of the Controller got from platformio_override.ini
+const uint8_t controllerMac[] = {CONTROLLER_MAC};
+#ifdef SUPERVISOR_MAC
+// The MAC address of the optional supervisor Controller that may override the operator
+const uint8_t supervisorMac[] = {SUPERVISOR_MAC};
+#endif
+
+// Peer stored in the NVS
+struct PairedPeer
+{
+    uint8_t mac[PEER_MAC_LEN];
+    uint8_t priority;
+};
+
+PeerArbiter peerArbiter;
+portMUX_TYPE peerArbiterMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Replay windows are indexed the same way as the arbiter table
+ReplayWindow replayWindows[PEER_MAX_COUNT];
+
+// Local master key for the peers, valid only if the link is encrypted
+uint8_t linkLmk[LINK_KEY_LEN];
+volatile bool linkEncrypted = false;
+uint32_t txCounter = 0;
+
+// Start of the frame waiting for its send callback, 0 if none
+uint32_t txStartUs = 0;
+
+esp_now_recv_cb_t dataRecvCallback = NULL;
+// Counters are updated only in the Wi-Fi task and published to the readers without locking
+EspNowStats espNowStats;
+Seqlock<EspNowStats> espNowStatsSnapshot;
+volatile uint32_t pairingUntil = 0;
+bool espNowReady = false;
+
+// Peer paired in the receive callback, stored to the NVS by the task that started the pairing
+PairedPeer pendingPeer;
+std::atomic<bool> pendingPeerReady(false);
+TaskHandle_t pairingTask = NULL;
 
 // Callback when data is sent
 void _onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status)
 {
     // Print error message if the data failed to send
     if (status != ESP_NOW_SEND_SUCCESS)
-        Serial.printf("Data was not received by the Controller\n");
+    {
+        logPrintf("Data was not received by the Controller\n");
+    }
+    else if (txStartUs)
+    {
+        // Measure the send path of the current encryption mode
+        uint32_t elapsed = micros() - txStartUs;
+        EspNowLatency &latency = espNowStats.latency[linkEncrypted];
+        latency.txFrames++;
+        latency.txSumUs += elapsed;
+        if (elapsed > latency.txMaxUs)
+            latency.txMaxUs = elapsed;
+        espNowStatsSnapshot.write(espNowStats);
+    }
+    txStartUs = 0;
+}
+
+/**
+ * @brief Add the peer to the ESP-NOW peer list and to the arbiter table.
+ *
+ * @param mac The MAC address of the peer.
+ * @param priority The priority of the peer.
+ * @return true if the peer was added.
+ */
+bool _addPeer(const uint8_t *mac, uint8_t priority)
+{
+    esp_now_peer_info_t peerInfo = {};
+
+    // Setup the peer
+    memcpy(peerInfo.peer_addr, mac, PEER_MAC_LEN);
+    peerInfo.channel = 0;
+    peerInfo.encrypt = linkEncrypted;
+    if (linkEncrypted)
+        memcpy(peerInfo.lmk, linkLmk, LINK_KEY_LEN);
+
+    // Add the peer
+    if (!esp_now_is_peer_exist(mac) && esp_now_add_peer(&peerInfo) != ESP_OK)
+    {
+        logPrintf("Failed to add peer " MAC_FMT "\n", MAC_ARGS(mac));
+        return false;
+    }
+
+    portENTER_CRITICAL(&peerArbiterMux);
+    int index = peerArbiter.addPeer(mac, priority);
+    portEXIT_CRITICAL(&peerArbiterMux);
+
+    if (index < 0)
+    {
+        logPrintf("Peer table is full, " MAC_FMT " not added\n", MAC_ARGS(mac));
+        esp_now_del_peer(mac);
+        return false;
+    }
+
+    logPrintf("Peer " MAC_FMT " added with priority %d\n", MAC_ARGS(mac), priority);
+    return true;
+}
+
+/**
+ * @brief Load the peers paired at runtime from the NVS.
+ */
+void _loadPairedPeers()
+{
+    PairedPeer peers[PEER_MAX_COUNT];
+    Preferences prefs;
+
+    if (!prefs.begin(PEERS_NVS_NAMESPACE, true))
+        return;
+
+    size_t count = prefs.getBytes(PEERS_NVS_KEY, peers, sizeof(peers)) / sizeof(PairedPeer);
+    prefs.end();
+
+    for (size_t i = 0; i < count; ++i)
+        _addPeer(peers[i].mac, peers[i].priority);
+}
+
+/**
+ * @brief Append a peer paired at runtime to the NVS.
+ *
+ * @param mac The MAC address of the peer.
+ * @param priority The priority of the peer.
+ */
+void _savePairedPeer(const uint8_t *mac, uint8_t priority)
+{
+    PairedPeer peers[PEER_MAX_COUNT];
+    Preferences prefs;
+
+    if (!prefs.begin(PEERS_NVS_NAMESPACE, false))
+        return;
+
+    size_t count = prefs.getBytes(PEERS_NVS_KEY, peers, sizeof(peers)) / sizeof(PairedPeer);
+    if (count < PEER_MAX_COUNT)
+    {
+        memcpy(peers[count].mac, mac, PEER_MAC_LEN);
+        peers[count].priority = priority;
+        prefs.putBytes(PEERS_NVS_KEY, peers, (count + 1) * sizeof(PairedPeer));
+    }
+    prefs.end();
+}
+
+/**
+ * @brief Load the link keys from the NVS and set the PMK.
+ * The link stays unencrypted if no keys were provisioned.
+ */
+void _loadLinkKeys()
+{
+    uint8_t pmk[LINK_KEY_LEN];
+    Preferences prefs;
+
+    if (!prefs.begin(KEYS_NVS_NAMESPACE, true))
+        return;
+
+    bool loaded = prefs.getBytes(KEYS_NVS_PMK, pmk, LINK_KEY_LEN) == LINK_KEY_LEN &&
+                  prefs.getBytes(KEYS_NVS_LMK, linkLmk, LINK_KEY_LEN) == LINK_KEY_LEN;
+    prefs.end();
+
+    if (loaded && isValidLinkKey(pmk) && isValidLinkKey(linkLmk) && esp_now_set_pmk(pmk) == ESP_OK)
+        linkEncrypted = true;
+}
+
+/**
+ * @brief Filter and dispatch a received frame. Frames are filtered by the sender MAC address before
+ * any parsing, so frames from foreign controllers are dropped at minimal cost. Replayed frames
+ * are dropped before they can take over control.
+ */
+void _handleFrame(const uint8_t *mac, const uint8_t *incomingData, int len, uint32_t startUs)
+{
+    portENTER_CRITICAL_ISR(&peerArbiterMux);
+    int index = peerArbiter.findPeer(mac);
+    portEXIT_CRITICAL_ISR(&peerArbiterMux);
+
+    if (index < 0)
+    {
+        // Pair the first controller that sends a valid frame while pairing is active
+        if ((int32_t)(pairingUntil - millis()) > 0 && len == sizeof(controller_data_struct))
+        {
+            pairingUntil = millis();
+            if (_addPeer(mac, PEER_PRIORITY_OPERATOR) && !pendingPeerReady.load(std::memory_order_acquire))
+            {
+                // The flash write would block the Wi-Fi task, the peer is stored by the pairing task
+                memcpy(pendingPeer.mac, mac, PEER_MAC_LEN);
+                pendingPeer.priority = PEER_PRIORITY_OPERATOR;
+                pendingPeerReady.store(true, std::memory_order_release);
+                if (pairingTask)
+                    xTaskNotifyGive(pairingTask);
+            }
+        }
+        espNowStats.rejectedUnknown++;
+        return;
+    }
+
+    if (len != sizeof(controller_data_struct))
+    {
+        espNowStats.rejectedLength++;
+        return;
+    }
+
+    // Only the epoch and the counter are read before the frame is known to be fresh
+    uint32_t epoch, counter;
+    memcpy(&epoch, incomingData + offsetof(controller_data_struct, epoch), sizeof(epoch));
+    memcpy(&counter, incomingData + offsetof(controller_data_struct, counter), sizeof(counter));
+
+    portENTER_CRITICAL_ISR(&peerArbiterMux);
+    bool fresh = replayWindows[index].check(epoch, counter);
+    PeerFrameResult result = fresh ? peerArbiter.onFrame(mac, millis()) : PEER_REJECTED_UNKNOWN;
+    portEXIT_CRITICAL_ISR(&peerArbiterMux);
+
+    if (!fresh)
+    {
+        espNowStats.rejectedReplay++;
+        return;
+    }
+
+    switch (result)
+    {
+        case PEER_ACCEPTED:
+            break;
+        case PEER_ACCEPTED_HANDOVER:
+            espNowStats.handovers++;
+            logPrintf("Control handed over to " MAC_FMT "\n", MAC_ARGS(mac));
+            break;
+        case PEER_REJECTED_LOWER_PRIORITY:
+            espNowStats.rejectedPriority++;
+            return;
+        case PEER_REJECTED_LOCKED_OUT:
+            espNowStats.rejectedLockout++;
+            return;
+        default:
+            return;
+    }
+
+    espNowStats.accepted++;
+    if (dataRecvCallback)
+        dataRecvCallback(mac, incomingData, len);
+
+    // Measure the receive path, it is executed in the Wi-Fi task and delays all other frames
+    uint32_t elapsed = micros() - startUs;
+    espNowStats.rxPathLastUs = elapsed;
+    if (elapsed > espNowStats.rxPathMaxUs)
+        espNowStats.rxPathMaxUs = elapsed;
+    if (elapsed > RX_PATH_BUDGET_US)
+        espNowStats.rxPathOverBudget++;
+
+    EspNowLatency &latency = espNowStats.latency[linkEncrypted];
+    latency.rxFrames++;
+    latency.rxPathSumUs += elapsed;
+    if (elapsed > latency.rxPathMaxUs)
+        latency.rxPathMaxUs = elapsed;
+}
+
+/**
+ * @brief Internal receive callback. The counters are published after every frame.
+ */
+void _onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len)
+{
+    _handleFrame(mac, incomingData, len, micros());
+    espNowStatsSnapshot.write(espNowStats);
 }
 
 void initEspNow()
@@ -37,33 +312,171 @@ void initEspNow()
         return;
     }
 
-    // Setup the peer
-    memcpy(peerInfo.peer_addr, controllerMac, 6);
-    peerInfo.channel = 0;
-    peerInfo.encrypt = false;
+    // Encrypt the link if the keys were provisioned
+    _loadLinkKeys();
+    if (!linkEncrypted)
+        Serial.println("ESP-NOW link keys are not provisioned, the link is not encrypted and the frame "
+                       "counters can be forged, so the replay check protects nothing");
 
-    // Add the peer
-    if (esp_now_add_peer(&peerInfo) != ESP_OK)
-    {
-        Serial.println("Failed to add peer");
-        return;
-    }
+    // Register the compile-time peers and the peers paired at runtime
+    _addPeer(controllerMac, PEER_PRIORITY_OPERATOR);
+#ifdef SUPERVISOR_MAC
+    _addPeer(supervisorMac, PEER_PRIORITY_SUPERVISOR);
+#endif
+    _loadPairedPeers();
 
     // Register for a callback function that will be called when data is sent
     esp_now_register_send_cb(_onDataSent);
+
+    // Register the filtering callback for received data
+    esp_now_register_recv_cb(_onDataRecv);
+
+    espNowReady = true;
 }
 
 void registerDataRecvCallback(esp_now_recv_cb_t callback)
 {
-    esp_now_register_recv_cb(callback);
+    dataRecvCallback = callback;
 }
 
-void sendDataToController(const excavator_data_struct &data)
+/**
+ * @brief Send the encoded telemetry to the Controller that is in control.
+ *
+ * @param telemetry Encoded telemetry frame, see TelemetryEncoder.
+ * @param len Length of the telemetry frame.
+ */
+void sendDataToController(const uint8_t *telemetry, size_t len)
 {
-    // Send the data
-    esp_err_t result = esp_now_send(controllerMac, (uint8_t *)&data, sizeof(data));
+    uint8_t mac[PEER_MAC_LEN];
+
+    // Send the data only to the controller that is in control
+    portENTER_CRITICAL(&peerArbiterMux);
+    uint8_t active = peerArbiter.activeIndex();
+    if (active != PEER_NONE)
+        memcpy(mac, peerArbiter.peer(active).mac, PEER_MAC_LEN);
+    portEXIT_CRITICAL(&peerArbiterMux);
+
+    if (active == PEER_NONE)
+        return;
+
+    if (len > TELEMETRY_MAX_SIZE)
+        return;
+
+    // Stamp the frame counter
+    excavator_data_struct frame;
+    frame.counter = ++txCounter;
+    memcpy(frame.telemetry, telemetry, len);
+
+    // Send the data, only one frame at a time is measured
+    uint32_t startUs = micros();
+    esp_err_t result = esp_now_send(mac, (uint8_t *)&frame, offsetof(excavator_data_struct, telemetry) + len);
+    if (result == ESP_OK && txStartUs == 0)
+        txStartUs = startUs ? startUs : 1;
 
     // Print error message if something went wrong
     if (result != ESP_OK)
-        Serial.printf("Error sending data: %s\n", esp_err_to_name(result));
-}
\ No newline at end of file
+        logPrintf("Error sending data: %s\n", esp_err_to_name(result));
+}
+
+/**
+ * @brief Accept the first unknown controller that sends a valid frame within the given time.
+ * The paired controller gets the operator priority. The calling task is notified when a controller
+ * is paired and must store it with espNowSavePairedPeer().
+ *
+ * @param durationMs Duration of the pairing window in milliseconds.
+ */
+void espNowStartPairing(uint32_t durationMs)
+{
+    pairingTask = xTaskGetCurrentTaskHandle();
+    pairingUntil = millis() + durationMs;
+    logPrintf("ESP-NOW pairing started for %lu ms\n", (unsigned long)durationMs);
+}
+
+/**
+ * @brief Store the controller paired in the receive callback to the NVS, if there is one.
+ * @note Blocks for the flash write, so it must be called from a core 0 task, see espNowStartPairing().
+ */
+void espNowSavePairedPeer()
+{
+    if (!pendingPeerReady.load(std::memory_order_acquire))
+        return;
+
+    _savePairedPeer(pendingPeer.mac, pendingPeer.priority);
+    pendingPeerReady.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief Remove all peers paired at runtime. The compile-time peers are kept.
+ * @note The change takes effect after reboot.
+ */
+void espNowClearPairedPeers()
+{
+    Preferences prefs;
+    if (prefs.begin(PEERS_NVS_NAMESPACE, false))
+    {
+        prefs.remove(PEERS_NVS_KEY);
+        prefs.end();
+    }
+}
+
+/**
+ * @brief Store new link keys in the NVS and encrypt all registered peers with them.
+ * @note The Controllers must be provisioned with the same keys, otherwise their frames are dropped.
+ *
+ * @param pmk Primary master key.
+ * @param lmk Local master key of the peers.
+ * @return true if the keys were stored and applied.
+ */
+bool espNowProvisionKeys(const uint8_t pmk[LINK_KEY_LEN], const uint8_t lmk[LINK_KEY_LEN])
+{
+    if (!isValidLinkKey(pmk) || !isValidLinkKey(lmk))
+        return false;
+
+    Preferences prefs;
+    if (!prefs.begin(KEYS_NVS_NAMESPACE, false))
+        return false;
+
+    bool stored = prefs.putBytes(KEYS_NVS_PMK, pmk, LINK_KEY_LEN) == LINK_KEY_LEN &&
+                  prefs.putBytes(KEYS_NVS_LMK, lmk, LINK_KEY_LEN) == LINK_KEY_LEN;
+    prefs.end();
+
+    if (!stored || esp_now_set_pmk(pmk) != ESP_OK)
+        return false;
+
+    memcpy(linkLmk, lmk, LINK_KEY_LEN);
+    linkEncrypted = true;
+
+    // Re-key all registered peers and start the replay protection from scratch
+    for (uint8_t i = 0; i < peerArbiter.count(); ++i)
+    {
+        esp_now_peer_info_t peerInfo = {};
+        memcpy(peerInfo.peer_addr, peerArbiter.peer(i).mac, PEER_MAC_LEN);
+        peerInfo.channel = 0;
+        peerInfo.encrypt = true;
+        memcpy(peerInfo.lmk, linkLmk, LINK_KEY_LEN);
+        if (esp_now_mod_peer(&peerInfo) != ESP_OK)
+            logPrintf("Failed to encrypt peer " MAC_FMT "\n", MAC_ARGS(peerInfo.peer_addr));
+
+        portENTER_CRITICAL(&peerArbiterMux);
+        replayWindows[i].reset();
+        portEXIT_CRITICAL(&peerArbiterMux);
+    }
+
+    Serial.println("ESP-NOW link keys provisioned");
+    return true;
+}
+
+bool espNowIsReady()
+{
+    return espNowReady;
+}
+
+/**
+ * @brief Get a consistent snapshot of the receive path counters. Safe to call from any task.
+ */
+EspNowStats getEspNowStats()
+{
+    EspNowStats stats = espNowStatsSnapshot.read();
+    stats.encrypted = linkEncrypted;
+    return stats;
+}
@@ -13,9 +13,46 @@
 #include <esp_now.h>
 
 #include "data_structures.h"
+#include "link_security.h"
+
+#define ESP_NOW_PAIRING_WINDOW_MS 30000
+
+// Link latency of one encryption mode
+struct EspNowLatency
+{
+    uint32_t rxFrames;
+    uint32_t rxPathMaxUs;
+    uint64_t rxPathSumUs;
+    uint32_t txFrames;
+    uint32_t txMaxUs; // From esp_now_send() to the send callback: encryption, airtime and the ACK
+    uint64_t txSumUs;
+};
+
+// Frame counters of the receive path
+struct EspNowStats
+{
+    uint32_t accepted;
+    uint32_t handovers;
+    uint32_t rejectedUnknown;
+    uint32_t rejectedPriority;
+    uint32_t rejectedLockout;
+    uint32_t rejectedLength;
+    uint32_t rejectedReplay;
+    uint32_t rxPathLastUs;     // Receive path duration of the last accepted frame
+    uint32_t rxPathMaxUs;      // Longest receive path duration
+    uint32_t rxPathOverBudget; // Frames that exceeded the receive path budget
+    bool encrypted;            // Link is encrypted with the provisioned keys
+    EspNowLatency latency[2];  // Unencrypted and encrypted, both are filled when the keys are provisioned at runtime
+};
 
 void initEspNow();
 void registerDataRecvCallback(esp_now_recv_cb_t callback);
-void sendDataToController(const excavator_data_struct &data);
+void sendDataToController(const uint8_t *telemetry, size_t len);
+void espNowStartPairing(uint32_t durationMs = ESP_NOW_PAIRING_WINDOW_MS);
+void espNowSavePairedPeer();
+void espNowClearPairedPeers();
+bool espNowProvisionKeys(const uint8_t pmk[LINK_KEY_LEN], const uint8_t lmk[LINK_KEY_LEN]);
+bool espNowIsReady();
+EspNowStats getEspNowStats();
 
-#endif // ESP_NOW_MANAGER_H
\ No newline at end of file
+#endif // ESP_NOW_MANAGER_H
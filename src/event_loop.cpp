@@ -0,0 +1,90 @@
+/**
+ * @file event_loop.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "event_loop.h"
+#include <seqlock.h>
+
+#include "logger.h"
+
+TaskHandle_t eventLoopTask = NULL;
+
+// Notified by the interrupts and the tasks, the wakeups are recorded by the loop only
+EventLoopTracker eventLoopTracker;
+Seqlock<EventLoopStats> eventLoopStatsSnapshot;
+
+/**
+ * @brief Set the task that is woken by the events, the control task.
+ * @note This function should be called once during the setup phase, before the events are notified.
+ *
+ * @param task The task that calls eventLoopWait().
+ */
+void eventLoopInit(TaskHandle_t task)
+{
+    eventLoopTracker.reset(micros());
+    eventLoopTask = task;
+}
+
+/**
+ * @brief Wake the event loop from a task, e.g. when a frame or a command is submitted or a motor starts
+ * and its position must be tracked.
+ */
+void eventLoopNotify()
+{
+    if (eventLoopTask == NULL)
+        return;
+
+    eventLoopTracker.notify(micros());
+    xTaskNotifyGive(eventLoopTask);
+}
+
+/**
+ * @brief Wake the event loop from an interrupt, e.g. on a limit switch edge.
+ */
+void IRAM_ATTR eventLoopNotifyFromIsr()
+{
+    if (eventLoopTask == NULL)
+        return;
+
+    eventLoopTracker.notify(micros());
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(eventLoopTask, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+/**
+ * @brief Sleep until an event notifies the loop or the timeout expires.
+ *
+ * @param timeoutUs Time until the loop has work without an event.
+ */
+void eventLoopWait(uint32_t timeoutUs)
+{
+    TickType_t ticks = pdMS_TO_TICKS(EventLoopTracker::timeoutMs(timeoutUs));
+    uint32_t start = micros();
+    bool event = ulTaskNotifyTake(pdTRUE, ticks) > 0;
+
+    eventLoopTracker.wakeup(event, start, timeoutUs, micros());
+    eventLoopStatsSnapshot.write(eventLoopTracker.stats());
+}
+
+EventLoopStats eventLoopGetStats()
+{
+    return eventLoopStatsSnapshot.read();
+}
+
+void eventLoopPrintStats()
+{
+    EventLoopStats stats = eventLoopGetStats();
+    logPrintf("Event loop: %lu wakeups (%lu events, %lu timers), %lu/s, max %lu/s, event latency max %lu us, "
+              "timer late max %lu us\n",
+              (unsigned long)stats.wakeups, (unsigned long)stats.eventWakeups, (unsigned long)stats.timerWakeups,
+              (unsigned long)stats.wakeupsPerSecond, (unsigned long)stats.maxWakeupsPerSecond,
+              (unsigned long)stats.maxEventLatencyUs, (unsigned long)stats.maxTimerLateUs);
+}
@@ -0,0 +1,24 @@
+/**
+ * @file event_loop.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <Arduino.h>
+
+#include "event_loop_tracker.h"
+
+void eventLoopInit(TaskHandle_t task);
+void eventLoopNotify();
+void eventLoopNotifyFromIsr();
+void eventLoopWait(uint32_t timeoutUs);
+EventLoopStats eventLoopGetStats();
+void eventLoopPrintStats();
+
+#endif // EVENT_LOOP_H
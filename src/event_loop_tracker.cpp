@@ -0,0 +1,77 @@
+/**
+ * @file event_loop_tracker.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "event_loop_tracker.h"
+#include <string.h>
+
+EventLoopTracker::EventLoopTracker() : _pending(false), _notifyUs(0)
+{
+    reset(0);
+}
+
+/**
+ * @brief Clear the statistics and the pending notification.
+ *
+ * @param nowUs Current time, the first second of the wakeup rate starts from it.
+ */
+void EventLoopTracker::reset(uint32_t nowUs)
+{
+    _pending.store(false);
+    _notifyUs.store(0, std::memory_order_relaxed);
+    memset(&_stats, 0, sizeof(_stats));
+    _secondStartUs = nowUs;
+    _secondWakeups = 0;
+}
+
+/**
+ * @brief Record a wakeup of the loop.
+ *
+ * @param event true if the loop was notified, false if its timeout expired.
+ * @param waitStartUs Time the loop started to wait.
+ * @param timeoutUs Requested timeout of the wait.
+ * @param nowUs Time the loop runs again.
+ */
+void EventLoopTracker::wakeup(bool event, uint32_t waitStartUs, uint32_t timeoutUs, uint32_t nowUs)
+{
+    _stats.wakeups++;
+    if (event)
+    {
+        _stats.eventWakeups++;
+        uint32_t latency = nowUs - _notifyUs.load(std::memory_order_relaxed);
+        _pending.store(false);
+        if (latency > _stats.maxEventLatencyUs)
+            _stats.maxEventLatencyUs = latency;
+    }
+    else
+    {
+        _stats.timerWakeups++;
+        uint32_t elapsed = nowUs - waitStartUs;
+        if (elapsed > timeoutUs && elapsed - timeoutUs > _stats.maxTimerLateUs)
+            _stats.maxTimerLateUs = elapsed - timeoutUs;
+    }
+
+    _secondWakeups++;
+    if (nowUs - _secondStartUs >= 1000000)
+    {
+        _stats.wakeupsPerSecond = _secondWakeups;
+        if (_secondWakeups > _stats.maxWakeupsPerSecond)
+            _stats.maxWakeupsPerSecond = _secondWakeups;
+        _secondWakeups = 0;
+        _secondStartUs = nowUs;
+    }
+}
+
+/**
+ * @brief Convert the timeout of a wait to milliseconds.
+ * The timeout is rounded up, so the loop does not wake before it.
+ */
+uint32_t EventLoopTracker::timeoutMs(uint32_t timeoutUs)
+{
+    return timeoutUs / 1000 + (timeoutUs % 1000 != 0);
+}
@@ -0,0 +1,61 @@
+/**
+ * @file event_loop_tracker.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef EVENT_LOOP_TRACKER_H
+#define EVENT_LOOP_TRACKER_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Wakeups of the control task, the event loop of the motors
+struct EventLoopStats
+{
+    uint32_t wakeups;
+    uint32_t eventWakeups;        // Woken by a frame, a command, a limit switch edge or a started motor
+    uint32_t timerWakeups;        // Woken by a debounce window, a position update or the idle period
+    uint32_t wakeupsPerSecond;    // Wakeups in the last full second
+    uint32_t maxWakeupsPerSecond;
+    uint32_t maxEventLatencyUs;   // Longest time from a notification to the running loop
+    uint32_t maxTimerLateUs;      // Longest delay of a timer wakeup after the requested time
+};
+
+/**
+ * @brief Tracks the notifications and the wakeups of an event loop.
+ *
+ * The notifications may come from the interrupts and from any task, only the first one since the last
+ * wakeup is timed. The wakeups are reported by the loop itself after its wait. The tracker has no
+ * hardware dependencies, the times are in microseconds and may wrap around.
+ */
+class EventLoopTracker
+{
+public:
+    EventLoopTracker();
+
+    void reset(uint32_t nowUs);
+    void wakeup(bool event, uint32_t waitStartUs, uint32_t timeoutUs, uint32_t nowUs);
+    const EventLoopStats &stats() const { return _stats; }
+
+    // Record a notification. Safe to call from the interrupts.
+    void notify(uint32_t nowUs)
+    {
+        if (!_pending.exchange(true))
+            _notifyUs.store(nowUs, std::memory_order_relaxed);
+    }
+
+    static uint32_t timeoutMs(uint32_t timeoutUs);
+
+private:
+    std::atomic<bool> _pending;
+    std::atomic<uint32_t> _notifyUs; // First notification since the last wakeup
+    EventLoopStats _stats;
+    uint32_t _secondStartUs;
+    uint32_t _secondWakeups;
+};
+
+#endif // EVENT_LOOP_TRACKER_H
@@ -0,0 +1,157 @@
+/**
+ * @file heap_guard.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "heap_guard.h"
+
+#ifdef HEAP_TRACKING
+
+#include "logger.h"
+
+// The allocator functions are wrapped by the linker with -Wl,--wrap=malloc etc.
+extern "C" void *__real_malloc(size_t size);
+extern "C" void *__real_calloc(size_t count, size_t size);
+extern "C" void *__real_realloc(void *ptr, size_t size);
+
+struct ProtectedTask
+{
+    TaskHandle_t handle;
+    bool exempt; // Set while the task runs code that is allowed to allocate
+};
+
+ProtectedTask protectedTasks[HEAP_GUARD_MAX_TASKS];
+uint8_t protectedTasksCount = 0;
+
+volatile bool heapGuardArmed = false;
+volatile uint32_t heapViolations = 0;
+volatile uint32_t heapReportedViolations = 0;
+volatile TaskHandle_t heapLastViolator = NULL;
+volatile size_t heapLastViolationSize = 0;
+
+uint32_t heapFreeAtArm = 0;
+
+ProtectedTask *_findTask(TaskHandle_t handle)
+{
+    for (uint8_t i = 0; i < protectedTasksCount; i++)
+    {
+        if (protectedTasks[i].handle == handle)
+            return &protectedTasks[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Count the allocation if it is made by a protected task after the guard was armed.
+ *
+ * @param size Requested size in bytes.
+ */
+void _checkAllocation(size_t size)
+{
+    if (!heapGuardArmed)
+        return;
+
+    ProtectedTask *task = _findTask(xTaskGetCurrentTaskHandle());
+    if (task == NULL || task->exempt)
+        return;
+
+    heapViolations = heapViolations + 1;
+    heapLastViolator = task->handle;
+    heapLastViolationSize = size;
+
+#ifdef HEAP_GUARD_ASSERT
+    abort();
+#endif
+}
+
+extern "C" void *__wrap_malloc(size_t size)
+{
+    _checkAllocation(size);
+    return __real_malloc(size);
+}
+
+extern "C" void *__wrap_calloc(size_t count, size_t size)
+{
+    _checkAllocation(count * size);
+    return __real_calloc(count, size);
+}
+
+extern "C" void *__wrap_realloc(void *ptr, size_t size)
+{
+    _checkAllocation(size);
+    return __real_realloc(ptr, size);
+}
+
+/**
+ * @brief Add a task whose allocations are counted once the guard is armed.
+ * @note This function should be called during the setup phase, before heapGuardArm().
+ *
+ * @param task Handle of the task.
+ */
+void heapGuardProtectTask(TaskHandle_t task)
+{
+    if (task == NULL || _findTask(task) != NULL)
+        return;
+
+    if (protectedTasksCount >= HEAP_GUARD_MAX_TASKS)
+    {
+        Serial.println("Heap guard task table is full");
+        return;
+    }
+
+    protectedTasks[protectedTasksCount++] = {task, false};
+}
+
+/**
+ * @brief Start counting the allocations. The calling task (the Arduino loop task) is protected too.
+ * @note This function should be called at the end of the setup function.
+ */
+void heapGuardArm()
+{
+    heapGuardProtectTask(xTaskGetCurrentTaskHandle());
+    heapFreeAtArm = esp_get_free_heap_size();
+    heapGuardArmed = true;
+
+    logPrintf("Heap guard armed: %u tasks, free heap %lu bytes\n", protectedTasksCount,
+              (unsigned long)heapFreeAtArm);
+}
+
+// Allow the calling task to allocate, e.g. to write to the NVS
+void heapGuardExemptBegin()
+{
+    ProtectedTask *task = _findTask(xTaskGetCurrentTaskHandle());
+    if (task != NULL)
+        task->exempt = true;
+}
+
+void heapGuardExemptEnd()
+{
+    ProtectedTask *task = _findTask(xTaskGetCurrentTaskHandle());
+    if (task != NULL)
+        task->exempt = false;
+}
+
+/**
+ * @brief Print the heap state when new violations were counted.
+ * @note This function should be called periodically from the loop function.
+ */
+void heapGuardReport()
+{
+    uint32_t violations = heapViolations;
+    if (violations == heapReportedViolations)
+        return;
+    heapReportedViolations = violations;
+
+    TaskHandle_t violator = heapLastViolator;
+    logPrintf("Heap guard: %lu allocations after setup, last %u bytes in %s, free heap %lu bytes "
+              "(%lu at setup), minimum %lu bytes\n",
+              (unsigned long)violations, (unsigned)heapLastViolationSize,
+              violator != NULL ? pcTaskGetName(violator) : "unknown", (unsigned long)esp_get_free_heap_size(),
+              (unsigned long)heapFreeAtArm, (unsigned long)esp_get_minimum_free_heap_size());
+}
+
+#endif // HEAP_TRACKING
@@ -0,0 +1,37 @@
+/**
+ * @file heap_guard.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef HEAP_GUARD_H
+#define HEAP_GUARD_H
+
+#include <Arduino.h>
+
+// Heap allocations of the control tasks are counted only in the heap tracking build,
+// see the esp-32s-heap-tracking environment. Define HEAP_GUARD_ASSERT to abort on the first one.
+#ifdef HEAP_TRACKING
+
+#define HEAP_GUARD_MAX_TASKS 8
+
+void heapGuardProtectTask(TaskHandle_t task);
+void heapGuardArm();
+void heapGuardExemptBegin();
+void heapGuardExemptEnd();
+void heapGuardReport();
+
+#else
+
+inline void heapGuardProtectTask(TaskHandle_t task) {}
+inline void heapGuardArm() {}
+inline void heapGuardExemptBegin() {}
+inline void heapGuardExemptEnd() {}
+inline void heapGuardReport() {}
+
+#endif // HEAP_TRACKING
+
+#endif // HEAP_GUARD_H
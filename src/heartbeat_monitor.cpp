@@ -0,0 +1,110 @@
+/**
+ * @file heartbeat_monitor.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "heartbeat_monitor.h"
+
+HeartbeatMonitor::HeartbeatMonitor() : _count(0)
+{
+    for (size_t i = 0; i < HEARTBEAT_MAX_SLOTS; i++)
+    {
+        _deadlineMs[i] = 0;
+        _lastBeat[i] = 0;
+        _paused[i] = false;
+    }
+}
+
+/**
+ * @brief Add a supervised task. The deadline starts counting immediately.
+ *
+ * @param deadlineMs Longest allowed time between two beats.
+ * @param now Current time.
+ * @return Slot of the task or HEARTBEAT_NO_SLOT if all slots are used.
+ */
+int HeartbeatMonitor::add(uint32_t deadlineMs, uint32_t now)
+{
+    if (_count >= HEARTBEAT_MAX_SLOTS)
+        return HEARTBEAT_NO_SLOT;
+
+    _deadlineMs[_count] = deadlineMs;
+    _lastBeat[_count] = now;
+    _paused[_count] = false;
+    return _count++;
+}
+
+void HeartbeatMonitor::beat(int slot, uint32_t now)
+{
+    if (slot >= 0 && (size_t)slot < _count)
+        _lastBeat[slot] = now;
+}
+
+// Stop checking the slot, e.g. while the task legitimately blocks for a long time
+void HeartbeatMonitor::pause(int slot)
+{
+    if (slot >= 0 && (size_t)slot < _count)
+        _paused[slot] = true;
+}
+
+// Check the slot again, the deadline starts from now
+void HeartbeatMonitor::resume(int slot, uint32_t now)
+{
+    if (slot >= 0 && (size_t)slot < _count)
+    {
+        _lastBeat[slot] = now;
+        _paused[slot] = false;
+    }
+}
+
+/**
+ * @brief Find a task that has missed its deadline.
+ *
+ * @param now Current time.
+ * @return Slot of the task that is silent for the longest time beyond its deadline,
+ * or HEARTBEAT_NO_SLOT if all tasks are on time.
+ */
+int HeartbeatMonitor::overdue(uint32_t now) const
+{
+    int worst = HEARTBEAT_NO_SLOT;
+    uint32_t worstExcess = 0;
+
+    for (size_t i = 0; i < _count; i++)
+    {
+        if (_paused[i])
+            continue;
+
+        uint32_t silence = now - _lastBeat[i];
+        if (silence > _deadlineMs[i] && (worst == HEARTBEAT_NO_SLOT || silence - _deadlineMs[i] > worstExcess))
+        {
+            worst = i;
+            worstExcess = silence - _deadlineMs[i];
+        }
+    }
+    return worst;
+}
+
+uint32_t HeartbeatMonitor::silenceMs(int slot, uint32_t now) const
+{
+    if (slot < 0 || (size_t)slot >= _count)
+        return 0;
+    return now - _lastBeat[slot];
+}
+
+/**
+ * @brief Derive the deadline of a task from its period.
+ *
+ * @param periodMs Period of a periodic task, 0 for a task woken by events.
+ * @param eventIntervalMs Longest wait of an event-driven task before it beats anyway.
+ * @param missedPeriods Number of periods a task may miss.
+ * @param minDeadlineMs Lower bound, covers the occasional long operations like flash writes.
+ */
+uint32_t HeartbeatMonitor::deadlineFor(uint32_t periodMs, uint32_t eventIntervalMs, uint8_t missedPeriods,
+                                       uint32_t minDeadlineMs)
+{
+    uint32_t deadline = (periodMs ? periodMs : eventIntervalMs) * missedPeriods;
+    return deadline > minDeadlineMs ? deadline : minDeadlineMs;
+}
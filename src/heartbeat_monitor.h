@@ -0,0 +1,50 @@
+/**
+ * @file heartbeat_monitor.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef HEARTBEAT_MONITOR_H
+#define HEARTBEAT_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HEARTBEAT_MAX_SLOTS 12
+#define HEARTBEAT_NO_SLOT   -1
+
+/**
+ * @brief Tracks the heartbeats of the supervised tasks against their deadlines.
+ *
+ * Every slot is beaten by one task and checked by the supervisor. A slot is a single word written
+ * by its task, so the beats need no locking. The monitor has no hardware dependencies,
+ * the times are passed in milliseconds and may wrap around.
+ */
+class HeartbeatMonitor
+{
+public:
+    HeartbeatMonitor();
+
+    int add(uint32_t deadlineMs, uint32_t now);
+    void beat(int slot, uint32_t now);
+    void pause(int slot);
+    void resume(int slot, uint32_t now);
+
+    int overdue(uint32_t now) const;
+    uint32_t silenceMs(int slot, uint32_t now) const;
+    size_t count() const { return _count; }
+
+    static uint32_t deadlineFor(uint32_t periodMs, uint32_t eventIntervalMs, uint8_t missedPeriods,
+                                uint32_t minDeadlineMs);
+
+private:
+    uint32_t _deadlineMs[HEARTBEAT_MAX_SLOTS];
+    volatile uint32_t _lastBeat[HEARTBEAT_MAX_SLOTS];
+    volatile bool _paused[HEARTBEAT_MAX_SLOTS];
+    size_t _count;
+};
+
+#endif // HEARTBEAT_MONITOR_H
@@ -8,15 +8,21 @@
  */
 
 #include "lights.h"
+#include <atomic>
 #include <hal/ledc_types.h>
 
 #include "constants.h"
+#include "heap_guard.h"
+#include "logger.h"
 #include "pwm_controller.h"
+#include "supervisor.h"
+#include "task_plan.h"
 
 // Light parameters
 #define LIGHTS_CHANGE_RATE         100   // Rate at which the brightness of the lights changes (PWM units per cycle)
 #define LIGHTS_GPIO_PWM_FREQUENCY  12000 // PWM frequency for GPIO-controlled lights
 #define LIGHTS_GPIO_PWM_RESOLUTION 10    // PWM resolution for GPIO-controlled lights
+#define LIGHTS_DIMMED_PWM          100   // Maximum brightness of the lights when dimmed
 
 // Beacon light parameters
 #define BEACON_GPIO_PWM_FREQUENCY  50  // PWM frequency for beacon light
@@ -25,11 +31,6 @@
 #define BEACON_MAX_DUTY            27  // Experimentally determined maximum duty cycle for the beacon light
 #define BEACON_CHANGE_MODE_DELAY   250 // Minumum delay between toggling the PWM output needed for the mode change
 
-// Task parameters
-#define LIGHTS_TASK_FREQUENCY_HZ (50U)
-#define LIGHTS_TASK_STACK_SIZE   (2 * 1024U)
-#define LIGHTS_TASK_PRIORITY     (tskIDLE_PRIORITY + 1)
-#define LIGHTS_TASK_CORE         1 // Core 0 is used by the WiFi
 
 // LEDC channels
 #define BOOM_LIGHTS_CHANNEL  LEDC_CHANNEL_0
@@ -55,6 +56,23 @@ Light lights[NUM_LIGHTS] = {
 
 LightMode currentLightMode = ALL_LIGHTS_WITH_BLINKING;
 
+// Limits the brightness of all lights, e.g. during the OTA update
+volatile bool lightsDimmed = false;
+
+// Phases of a beacon mode change pulse
+enum BeaconPulse : uint8_t
+{
+    BEACON_PULSE_IDLE,
+    BEACON_PULSE_HIGH, // Max duty, the beacon takes it as a mode change request
+    BEACON_PULSE_LOW   // Min duty, separates the pulses so the beacon sees each of them
+};
+
+// Beacon mode changes requested by the other tasks, the pulses are timed by the lights task
+std::atomic<uint32_t> beaconPendingChanges(0);
+uint32_t beaconPhaseStartMs = 0;
+BeaconPulse beaconPulse = BEACON_PULSE_IDLE;
+TaskHandle_t lightsTaskHandle = NULL;
+
 /**
  * @brief Set the brightness of a light depending on the control method.
  *
@@ -81,15 +99,17 @@ void _setLightBrightness(Light *light, uint16_t value)
  */
 void _updateLight(Light *light)
 {
+    uint16_t targetPWM = lightsDimmed ? min(light->targetPWM, LIGHTS_DIMMED_PWM) : light->targetPWM;
+
     // Increase or decrease brightness based on targetPWM
-    if (light->currentPWM < light->targetPWM)
+    if (light->currentPWM < targetPWM)
     {
-        light->currentPWM = min(light->currentPWM + LIGHTS_CHANGE_RATE, PWM_ON);
+        light->currentPWM = min(light->currentPWM + LIGHTS_CHANGE_RATE, targetPWM);
         _setLightBrightness(light, light->currentPWM);
     }
-    else if (light->currentPWM > light->targetPWM)
+    else if (light->currentPWM > targetPWM)
     {
-        light->currentPWM = max(light->currentPWM - LIGHTS_CHANGE_RATE, PWM_OFF);
+        light->currentPWM = max(light->currentPWM - LIGHTS_CHANGE_RATE, targetPWM);
         _setLightBrightness(light, light->currentPWM);
     }
     // If currentPWM == targetPWM, no action needed
@@ -170,20 +190,85 @@ void _updateLightsMode()
 void nextLightMode()
 {
     currentLightMode = static_cast<LightMode>((currentLightMode + 1) % (ALL_LIGHTS_WITH_BLINKING + 1));
-    Serial.printf("Light mode changed to %d\n", currentLightMode);
+    logPrintf("Light mode changed to %d\n", currentLightMode);
+}
+
+LightMode lightsGetMode()
+{
+    return currentLightMode;
+}
+
+void lightsSetMode(LightMode mode)
+{
+    if (mode > ALL_LIGHTS_WITH_BLINKING)
+        return;
+
+    currentLightMode = mode;
+    logPrintf("Light mode changed to %d\n", currentLightMode);
 }
 
+/**
+ * @brief Time the beacon pulses and start the next requested one.
+ * The beacon changes its mode on a pulse of its PWM input from the min to the max duty cycle. Both the
+ * high and the low phase last at least BEACON_CHANGE_MODE_DELAY, so queued requests are separate pulses.
+ */
+void _updateBeacon()
+{
+    uint32_t now = millis();
+
+    if (beaconPulse != BEACON_PULSE_IDLE && now - beaconPhaseStartMs < BEACON_CHANGE_MODE_DELAY)
+        return;
+
+    if (beaconPulse == BEACON_PULSE_HIGH)
+    {
+        ledcWrite(BEACON_LIGHT_CHANNEL, BEACON_MIN_DUTY);
+        beaconPulse = BEACON_PULSE_LOW;
+        beaconPhaseStartMs = now;
+        return;
+    }
+
+    // The low phase has passed, the next pulse may start right away
+    beaconPulse = BEACON_PULSE_IDLE;
+    if (beaconPendingChanges.load() > 0)
+    {
+        beaconPendingChanges--;
+        ledcWrite(BEACON_LIGHT_CHANNEL, BEACON_MAX_DUTY);
+        beaconPulse = BEACON_PULSE_HIGH;
+        beaconPhaseStartMs = now;
+        logPrintf("Beacon light mode changed\n");
+    }
+}
+
+/**
+ * @brief Update the brightness of all lights, the light mode and the beacon by one cycle.
+ * @note Called by the lights task, or by the benchmarks before the task is started.
+ */
+void lightsTick()
+{
+    // Iterate over all lights and update their brightness
+    for (int i = 0; i < NUM_LIGHTS; ++i)
+        _updateLight(&lights[i]);
+
+    _updateLightsMode();
+    _updateBeacon();
+}
+
+// Task memory is allocated statically
+StackType_t lightsTaskStack[TASK_PLAN[TASK_LIGHTS].stackSize];
+StaticTask_t lightsTaskBuffer;
+
 /**
  * @brief Task function for controlling the lights.
  *
  * This task initializes the lights and continuously updates their states based on the target PWM values.
- * The lights are updated periodically with a frequency defined by LIGHTS_TASK_FREQUENCY_HZ.
+ * The lights are updated periodically with the period from the task plan, a beacon mode change
+ * request wakes the task earlier to start its pulse.
  *
  * @param pvParameters A pointer to task parameters (not used in this function).
  */
 void lightsTask(void *pvParameters)
 {
-    const TickType_t xFrequency = pdMS_TO_TICKS(1000 / LIGHTS_TASK_FREQUENCY_HZ);
+    const TickType_t xFrequency = pdMS_TO_TICKS(TASK_PLAN[TASK_LIGHTS].periodMs);
     TickType_t xLastWakeTime = xTaskGetTickCount();
 
     // Initialize lights
@@ -209,14 +294,18 @@ void lightsTask(void *pvParameters)
     // Main task loop
     for (;;)
     {
-        // Iterate over all lights and update their brightness
-        for (int i = 0; i < NUM_LIGHTS; ++i)
-            _updateLight(&lights[i]);
+        lightsTick();
 
-        _updateLightsMode();
+        supervisorFeed();
 
-        // Wait for the next cycle.
-        xTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // Wait for the next cycle
+        TickType_t now;
+        while ((int32_t)(xLastWakeTime + xFrequency - (now = xTaskGetTickCount())) > 0)
+        {
+            if (ulTaskNotifyTake(pdTRUE, xLastWakeTime + xFrequency - now) > 0)
+                _updateBeacon();
+        }
+        xLastWakeTime += xFrequency;
     }
 }
 
@@ -229,24 +318,39 @@ void lightsTask(void *pvParameters)
  */
 void lightsTaskInit(void)
 {
-    if (pdPASS != xTaskCreatePinnedToCore(lightsTask,
-                                          "lightsTask",
-                                          LIGHTS_TASK_STACK_SIZE,
-                                          NULL,
-                                          LIGHTS_TASK_PRIORITY,
-                                          NULL,
-                                          LIGHTS_TASK_CORE))
+    lightsTaskHandle = xTaskCreateStaticPinnedToCore(lightsTask,
+                                                    TASK_PLAN[TASK_LIGHTS].name,
+                                                    TASK_PLAN[TASK_LIGHTS].stackSize,
+                                                    NULL,
+                                                    TASK_PLAN[TASK_LIGHTS].priority,
+                                                    lightsTaskStack,
+                                                    &lightsTaskBuffer,
+                                                    TASK_PLAN[TASK_LIGHTS].core);
+    if (lightsTaskHandle == NULL)
     {
         Serial.println("Failed to create lightsTask");
     }
+    taskPlanRegister(TASK_LIGHTS, lightsTaskHandle);
+    heapGuardProtectTask(lightsTaskHandle);
 }
 
+/**
+ * @brief Request the next beacon light mode. Never blocks, the pulse is timed by the lights task.
+ * Every request makes one pulse, so quick presses are not lost.
+ */
 void beaconLightChangeMode()
 {
-    Serial.println("Beacon light mode changed");
+    beaconPendingChanges++;
+    if (lightsTaskHandle != NULL)
+        xTaskNotifyGive(lightsTaskHandle);
+}
 
-    // Change the beacon light mode by toggling the PWM output between min and max duty cycle
-    ledcWrite(BEACON_LIGHT_CHANNEL, BEACON_MAX_DUTY);
-    delay(BEACON_CHANGE_MODE_DELAY);
-    ledcWrite(BEACON_LIGHT_CHANNEL, BEACON_MIN_DUTY);
-}
\ No newline at end of file
+/**
+ * @brief Limit the brightness of all lights.
+ *
+ * @param dimmed true to dim the lights, false to restore the brightness of the current mode.
+ */
+void lightsSetDimmed(bool dimmed)
+{
+    lightsDimmed = dimmed;
+}
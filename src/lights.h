@@ -57,7 +57,11 @@ struct Light
 };
 
 void lightsTaskInit();
+void lightsTick();
 void nextLightMode();
+LightMode lightsGetMode();
+void lightsSetMode(LightMode mode);
 void beaconLightChangeMode();
+void lightsSetDimmed(bool dimmed);
 
 #endif // LIGHTS_H
\ No newline at end of file
@@ -0,0 +1,135 @@
+/**
+ * @file limit_debouncer.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "limit_debouncer.h"
+
+#include <string.h>
+
+LimitDebouncer::LimitDebouncer(bool level)
+{
+    reset(level);
+}
+
+/**
+ * @brief Forget the bursts and accept the level as the state. The statistics are cleared.
+ */
+void LimitDebouncer::reset(bool level)
+{
+    _state = level;
+    _level = level;
+    _inBurst = false;
+    _burstStartState = level;
+    _burstStartUs = 0;
+    _lastEdgeUs = 0;
+    _burstEdges = 0;
+    _estimateUs = 0;
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.windowUs = LIMIT_DEBOUNCE_INITIAL_US;
+}
+
+/**
+ * @brief Add a raw edge. A pressed edge is accepted as the state at once.
+ *
+ * @param timeUs Time of the edge.
+ * @param level Level after the edge, true if the switch is pressed.
+ */
+void LimitDebouncer::edge(uint32_t timeUs, bool level)
+{
+    _stats.edges++;
+
+    if (!_inBurst)
+    {
+        _inBurst = true;
+        _burstStartState = _state;
+        _burstStartUs = timeUs;
+        _burstEdges = 0;
+    }
+    _burstEdges++;
+    _lastEdgeUs = timeUs;
+    _level = level;
+
+    if (level && !_state)
+    {
+        _state = true;
+        _stats.transitions++;
+    }
+}
+
+/**
+ * @brief Close the burst when the level is stable for the debounce window or the burst is too long.
+ *
+ * @param nowUs Current time, not earlier than the last edge.
+ * @return true if a burst has ended. The state may have changed, see state().
+ */
+bool LimitDebouncer::update(uint32_t nowUs)
+{
+    uint32_t elapsed = nowUs - _burstStartUs;
+    if (!_inBurst || elapsed < _deadlineUs())
+        return false;
+
+    _inBurst = false;
+    uint32_t lateUs = elapsed - _deadlineUs();
+    if (lateUs > _stats.maxLateUs)
+        _stats.maxLateUs = lateUs;
+
+    uint32_t burstUs = _lastEdgeUs - _burstStartUs;
+    _stats.bounces += _burstEdges - 1;
+    if (burstUs > _stats.maxBurstUs)
+        _stats.maxBurstUs = burstUs;
+    if (burstUs + _stats.windowUs > LIMIT_BURST_MAX_US)
+        _stats.chatters++;
+
+    if (_level != _state)
+    {
+        _state = _level;
+        _stats.transitions++;
+    }
+    if (_level == _burstStartState)
+        _stats.glitches++;
+
+    _adapt(burstUs);
+    return true;
+}
+
+/**
+ * @brief Time until the current burst may end, i.e. when update() should be called next.
+ *
+ * @return 0 if the window has already passed, UINT32_MAX if there is no burst.
+ */
+uint32_t LimitDebouncer::remainingUs(uint32_t nowUs) const
+{
+    if (!_inBurst)
+        return UINT32_MAX;
+
+    uint32_t elapsed = nowUs - _burstStartUs;
+    return elapsed < _deadlineUs() ? _deadlineUs() - elapsed : 0;
+}
+
+// End of the current burst from its start: the window after the last edge, at most LIMIT_BURST_MAX_US
+uint32_t LimitDebouncer::_deadlineUs() const
+{
+    uint32_t deadline = _lastEdgeUs - _burstStartUs + _stats.windowUs;
+    return deadline < LIMIT_BURST_MAX_US ? deadline : LIMIT_BURST_MAX_US;
+}
+
+// Follow a longer burst at once, a shorter one slowly
+void LimitDebouncer::_adapt(uint32_t burstUs)
+{
+    if (burstUs > _estimateUs)
+        _estimateUs = burstUs;
+    else
+        _estimateUs -= (_estimateUs - burstUs) / LIMIT_DEBOUNCE_DECAY;
+
+    uint32_t window = 2 * _estimateUs + LIMIT_DEBOUNCE_MARGIN_US;
+    if (window < LIMIT_DEBOUNCE_MIN_US)
+        window = LIMIT_DEBOUNCE_MIN_US;
+    if (window > LIMIT_DEBOUNCE_MAX_US)
+        window = LIMIT_DEBOUNCE_MAX_US;
+    _stats.windowUs = window;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file limit_debouncer.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef LIMIT_DEBOUNCER_H
+#define LIMIT_DEBOUNCER_H
+
+#include <stdint.h>
+
+// Debounce window limits. The window adapts to the bounce duration of the switch.
+#define LIMIT_DEBOUNCE_MIN_US     2000   // Clean switches, lowest stop latency
+#define LIMIT_DEBOUNCE_MAX_US     100000 // Noisy switches
+#define LIMIT_DEBOUNCE_INITIAL_US 20000  // Until the first bursts are measured
+#define LIMIT_DEBOUNCE_MARGIN_US  1000   // Added to the doubled bounce estimate
+#define LIMIT_DEBOUNCE_DECAY      8      // The estimate decays by 1/DECAY of the difference per shorter burst
+#define LIMIT_BURST_MAX_US        500000 // A chattering switch closes its burst after this time
+
+// Statistics of one limit switch
+struct LimitSwitchStats
+{
+    uint32_t edges;       // Raw edges seen by the interrupt
+    uint32_t transitions; // Accepted state changes
+    uint32_t bounces;     // Extra edges within the bursts
+    uint32_t glitches;    // Bursts that returned to the previous state
+    uint32_t chatters;    // Bursts closed by LIMIT_BURST_MAX_US while the switch kept bouncing
+    uint32_t maxBurstUs;  // Longest burst from the first to the last edge
+    uint32_t windowUs;    // Current debounce window
+    uint32_t maxLateUs;   // Longest delay of a burst end after its window had passed, the polling latency
+    uint32_t dropped;     // Edges lost because the edge buffer was full
+};
+
+/**
+ * @brief Debounces one switch from its timestamped edges.
+ *
+ * Edges close to each other form a burst. The first pressed edge is accepted as the pressed state at
+ * once, so the motor stops without waiting for the bounces. A burst ends when the level is stable for the
+ * debounce window or after LIMIT_BURST_MAX_US, then the level is accepted as the state, so only
+ * the release is delayed. The window follows the measured burst durations: it rises at once on
+ * a longer burst and decays slowly, so clean switches get a short window and noisy ones a long one.
+ * The debouncer has no hardware dependencies, the times are in microseconds and may wrap around.
+ */
+class LimitDebouncer
+{
+public:
+    explicit LimitDebouncer(bool level = false);
+
+    void reset(bool level);
+    void edge(uint32_t timeUs, bool level);
+    bool update(uint32_t nowUs);
+    uint32_t remainingUs(uint32_t nowUs) const;
+
+    bool state() const { return _state; }
+    bool level() const { return _level; }
+    bool inBurst() const { return _inBurst; }
+    const LimitSwitchStats &stats() const { return _stats; }
+
+private:
+    uint32_t _deadlineUs() const;
+    void _adapt(uint32_t burstUs);
+
+    bool _state;  // Debounced state
+    bool _level;  // Level after the last edge
+    bool _inBurst;
+    bool _burstStartState; // State before the burst, a burst that returns to it is a glitch
+    uint32_t _burstStartUs;
+    uint32_t _lastEdgeUs;
+    uint32_t _burstEdges;
+    uint32_t _estimateUs; // Expected burst duration
+    LimitSwitchStats _stats;
+};
+
+#endif // LIMIT_DEBOUNCER_H
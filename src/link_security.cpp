@@ -0,0 +1,111 @@
+/**
+ * @file link_security.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "link_security.h"
+
+/**
+ * @brief Forget all received counters. The next frame is accepted unconditionally.
+ */
+void ReplayWindow::reset()
+{
+    _epoch = 0;
+    _highest = 0;
+    _bitmap = 0;
+    _initialized = false;
+}
+
+/**
+ * @brief Check the frame counter and mark it as received.
+ *
+ * @param epoch The boot epoch of the sender.
+ * @param counter The frame counter within the epoch.
+ * @return true if the frame is new, false if it is a replay or too old.
+ */
+bool ReplayWindow::check(uint32_t epoch, uint32_t counter)
+{
+    if (_initialized && epoch < _epoch)
+        return false;
+
+    if (!_initialized || epoch > _epoch)
+    {
+        _initialized = true;
+        _epoch = epoch;
+        _highest = counter;
+        _bitmap = 1;
+        return true;
+    }
+
+    if (counter > _highest)
+    {
+        uint32_t shift = counter - _highest;
+        _bitmap = shift >= LINK_REPLAY_WINDOW ? 0 : _bitmap << shift;
+        _bitmap |= 1;
+        _highest = counter;
+        return true;
+    }
+
+    uint32_t age = _highest - counter;
+    if (age >= LINK_REPLAY_WINDOW)
+        return false;
+
+    uint64_t mask = (uint64_t)1 << age;
+    if (_bitmap & mask)
+        return false;
+
+    _bitmap |= mask;
+    return true;
+}
+
+/**
+ * @brief Check that the key is usable. All-zero keys are rejected.
+ *
+ * @param key The key to check.
+ * @return true if the key is valid.
+ */
+bool isValidLinkKey(const uint8_t key[LINK_KEY_LEN])
+{
+    for (size_t i = 0; i < LINK_KEY_LEN; ++i)
+    {
+        if (key[i])
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Parse a key from a string of 32 hexadecimal digits.
+ *
+ * @param hex The string to parse.
+ * @param key The parsed key.
+ * @return true if the string is a valid key.
+ */
+bool parseLinkKey(const char *hex, uint8_t key[LINK_KEY_LEN])
+{
+    for (size_t i = 0; i < LINK_KEY_LEN * 2; ++i)
+    {
+        char c = hex[i];
+        uint8_t nibble;
+
+        if (c >= '0' && c <= '9')
+            nibble = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            nibble = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            nibble = c - 'A' + 10;
+        else
+            return false;
+
+        if (i % 2 == 0)
+            key[i / 2] = nibble << 4;
+        else
+            key[i / 2] |= nibble;
+    }
+
+    return hex[LINK_KEY_LEN * 2] == '\0' && isValidLinkKey(key);
+}
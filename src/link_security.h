@@ -0,0 +1,48 @@
+/**
+ * @file link_security.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef LINK_SECURITY_H
+#define LINK_SECURITY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LINK_KEY_LEN         16 // Length of the ESP-NOW PMK and LMK
+#define LINK_REPLAY_WINDOW   64 // Number of recent frame counters tracked for out of order frames
+
+/**
+ * @brief Sliding window replay protection for monotonic frame counters.
+ *
+ * Frames newer than the highest seen counter are always accepted. Older frames are accepted only
+ * once and only if they are within LINK_REPLAY_WINDOW of the highest counter. The counters are
+ * compared within a boot epoch of the sender: a newer epoch restarts the window, so a rebooted
+ * sender is accepted again, and frames of an older epoch are always rejected.
+ */
+class ReplayWindow
+{
+public:
+    ReplayWindow() { reset(); }
+
+    void reset();
+    bool check(uint32_t epoch, uint32_t counter);
+
+    uint32_t epoch() const { return _epoch; }
+    uint32_t highest() const { return _highest; }
+
+private:
+    uint32_t _epoch;
+    uint32_t _highest;
+    uint64_t _bitmap; // Bit N is set if the counter (_highest - N) was received
+    bool _initialized;
+};
+
+bool isValidLinkKey(const uint8_t key[LINK_KEY_LEN]);
+bool parseLinkKey(const char *hex, uint8_t key[LINK_KEY_LEN]);
+
+#endif // LINK_SECURITY_H
@@ -0,0 +1,78 @@
+/**
+ * @file logger.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "logger.h"
+#include <atomic>
+#include <stdarg.h>
+
+// The Serial carries the binary shell frames while muted, any text between them would corrupt the frames
+std::atomic<bool> logMuted(false);
+std::atomic<uint32_t> logMutedMessages(0);
+
+/**
+ * @brief Print a formatted message to the Serial.
+ *
+ * Unlike Serial.printf(), which allocates a buffer on the heap for messages longer than 64 bytes,
+ * the message is formatted on the stack, so logging never allocates memory.
+ *
+ * @param format The printf-style format string.
+ */
+void logPrintf(const char *format, ...)
+{
+    if (logMuted.load(std::memory_order_acquire))
+    {
+        logMutedMessages.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    char buffer[LOG_BUFFER_SIZE];
+    va_list args;
+
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (len < 0)
+        return;
+    if (len >= (int)sizeof(buffer))
+        len = sizeof(buffer) - 1;
+
+    Serial.write((const uint8_t *)buffer, len);
+}
+
+/**
+ * @brief Drop all messages, e.g. while the shell talks to a test rig in the binary mode.
+ *
+ * @param muted true to drop the messages, false to print them again.
+ */
+void logSetMuted(bool muted)
+{
+    if (muted)
+        logMutedMessages.store(0, std::memory_order_relaxed);
+    logMuted.store(muted, std::memory_order_release);
+}
+
+/**
+ * @brief Get the number of messages dropped since the log was muted.
+ */
+uint32_t logMutedCount()
+{
+    return logMutedMessages.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Print the time since the reset at the end of a boot stage.
+ *
+ * @param stage Name of the finished stage.
+ */
+void logBootStage(const char *stage)
+{
+    int64_t us = esp_timer_get_time();
+    logPrintf("Boot: %s at %lu.%03lu ms\n", stage, (unsigned long)(us / 1000), (unsigned long)(us % 1000));
+}
@@ -0,0 +1,23 @@
+/**
+ * @file logger.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+
+// Longer messages are truncated
+#define LOG_BUFFER_SIZE 256
+
+void logPrintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void logBootStage(const char *stage);
+void logSetMuted(bool muted);
+uint32_t logMutedCount();
+
+#endif // LOGGER_H
@@ -0,0 +1,181 @@
+/**
+ * @file machine.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <stddef.h>
+#include <utility>
+
+#include "constants.h"
+#include "machine_config.h"
+#include "motor.h"
+
+/**
+ * @brief Get the first LEDC channel of the axis. Axes with MOTOR_OUTPUT_LEDC take two channels each
+ * in the order of the table.
+ */
+template <size_t N>
+constexpr uint8_t ledcChannelOf(const AxisConfig (&axes)[N], size_t axis)
+{
+    uint8_t channel = MOTOR_LEDC_FIRST_CHANNEL;
+    for (size_t i = 0; i < axis; ++i)
+    {
+        if (axes[i].output == MOTOR_OUTPUT_LEDC)
+            channel += 2;
+    }
+    return channel;
+}
+
+/**
+ * @brief Check the machine description at compile time.
+ *
+ * @return true if every axis uses a valid lever and slow zone, no output pin is used twice
+ * and there are enough LEDC channels.
+ */
+template <size_t N>
+constexpr bool isValidMachine(const AxisConfig (&axes)[N])
+{
+    if (ledcChannelOf(axes, N) > MOTOR_LEDC_CHANNELS)
+        return false;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (axes[i].leverIndex >= LEVERS_COUNT || axes[i].posMotorPin == axes[i].negMotorPin ||
+            axes[i].slowZone > 500)
+            return false;
+
+        for (size_t j = i + 1; j < N; ++j)
+        {
+            // Expander channels and GPIOs are different pin spaces
+            if (axes[i].output != axes[j].output)
+                continue;
+
+            if (axes[i].posMotorPin == axes[j].posMotorPin || axes[i].posMotorPin == axes[j].negMotorPin ||
+                axes[i].negMotorPin == axes[j].posMotorPin || axes[i].negMotorPin == axes[j].negMotorPin)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Set of motors generated from a machine description.
+ *
+ * The motors are built from the axis table at compile time and the lever dispatch is unrolled,
+ * so the control path has no loops over the table and no indirect calls.
+ *
+ * @tparam N Number of axes in the table.
+ * @tparam Axes The axis table.
+ */
+template <size_t N, const AxisConfig (&Axes)[N]>
+class Machine
+{
+public:
+    static constexpr size_t axisCount = N;
+
+    Machine() : Machine(std::make_index_sequence<N>{}) {}
+
+    // Attach the motor outputs and stop all motors
+    void setupOutputs()
+    {
+        for (size_t i = 0; i < N; ++i)
+            _motors[i].setupOutput();
+    }
+
+    // Attach the limit switch interrupts of all axes, the debouncers start from the current levels
+    void setupLimitSwitches()
+    {
+        for (size_t i = 0; i < N; ++i)
+            _motors[i].setupLimitSwitches();
+    }
+
+    // Debounce the limit switches of the axes that have them
+    void updateLimitSwitches()
+    {
+        _updateLimitSwitches(std::make_index_sequence<N>{});
+    }
+
+    // Estimate the positions and enforce the soft limits of the axes with an end of travel
+    void updatePositions()
+    {
+        _updatePositions(std::make_index_sequence<N>{});
+    }
+
+    // Time until any axis needs an update without a new limit switch edge, UINT32_MAX if all are idle
+    uint32_t nextUpdateUs(uint32_t nowUs) const
+    {
+        uint32_t next = UINT32_MAX;
+        for (size_t i = 0; i < N; ++i)
+            next = min(next, _motors[i].nextUpdateUs(nowUs));
+        return next;
+    }
+
+    // Apply the lever positions to the motors
+    void applyLevers(const int16_t levers[LEVERS_COUNT])
+    {
+        _applyLevers(levers, std::make_index_sequence<N>{});
+    }
+
+    // Stop all motors immediately with braking
+    void stopAll()
+    {
+        for (size_t i = 0; i < N; ++i)
+            _motors[i].stopImmediate();
+    }
+
+    // Limit switch states with two bits per lever: positive limit, then negative limit
+    uint16_t limitsMask() const
+    {
+        uint16_t mask = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            mask |= _motors[i].posLimitReached << (Axes[i].leverIndex * 2);
+            mask |= _motors[i].negLimitReached << (Axes[i].leverIndex * 2 + 1);
+        }
+        return mask;
+    }
+
+    Motor &motor(size_t axis) { return _motors[axis]; }
+    static constexpr const AxisConfig &config(size_t axis) { return Axes[axis]; }
+
+private:
+    static_assert(isValidMachine(Axes), "Invalid machine description");
+
+    template <size_t... I>
+    Machine(std::index_sequence<I...>) : _motors{Motor(Axes[I], ledcChannelOf(Axes, I))...}
+    {
+    }
+
+    template <size_t... I>
+    void _updateLimitSwitches(std::index_sequence<I...>)
+    {
+        // Axes without limit switches are skipped at compile time
+        ((Axes[I].posLimitPin != GPIO_NUM_NC || Axes[I].negLimitPin != GPIO_NUM_NC || Axes[I].centerPin != GPIO_NUM_NC
+              ? _motors[I].updateLimitSwitches()
+              : void()),
+         ...);
+    }
+
+    template <size_t... I>
+    void _updatePositions(std::index_sequence<I...>)
+    {
+        ((Axes[I].travelMs != 0 ? _motors[I].updatePosition() : void()), ...);
+    }
+
+    template <size_t... I>
+    void _applyLevers(const int16_t levers[LEVERS_COUNT], std::index_sequence<I...>)
+    {
+        (_motors[I].setSpeed(levers[Axes[I].leverIndex]), ...);
+    }
+
+    Motor _motors[N];
+};
+
+#endif // MACHINE_H
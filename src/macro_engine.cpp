@@ -0,0 +1,281 @@
+/**
+ * @file macro_engine.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "macro_engine.h"
+#include <string.h>
+
+#define LIMIT_MASK(bit) ((uint16_t)(1U << (bit)))
+
+MacroEngine::MacroEngine()
+{
+    _macro.stepsCount = 0;
+    _state = MACRO_IDLE;
+    _stopReason = MACRO_STOP_NONE;
+    _stepIndex = 0;
+    _stepStartMs = 0;
+    _lastLimits = 0;
+}
+
+/**
+ * @brief Start recording a new macro. The previously stored macro is discarded.
+ *
+ * @param nowMs Current time in milliseconds.
+ * @param limits Current limit switches bitmask.
+ */
+void MacroEngine::startRecording(uint32_t nowMs, uint16_t limits)
+{
+    _macro.stepsCount = 0;
+    _state = MACRO_RECORDING;
+    _stopReason = MACRO_STOP_NONE;
+    _stepStartMs = nowMs;
+    _lastLimits = limits;
+}
+
+/**
+ * @brief Record one lever vector sample.
+ * Consecutive samples with the same vector are merged into one step. A limit switch reached while
+ * recording turns the current step into a waypoint: on playback the step lasts until the switch fires.
+ * @note This function should be called for every control frame while recording.
+ *
+ * @param nowMs Current time in milliseconds.
+ * @param levers Lever positions in the range of -255 to 255.
+ * @param limits Current limit switches bitmask.
+ */
+void MacroEngine::record(uint32_t nowMs, const int16_t levers[LEVERS_COUNT], uint16_t limits)
+{
+    if (_state != MACRO_RECORDING)
+        return;
+
+    uint16_t rising = limits & ~_lastLimits;
+    _lastLimits = limits;
+
+    // Skip the idle time before the first movement
+    if (_macro.stepsCount == 0)
+    {
+        if (isOperatorInput(levers))
+            _openStep(nowMs, levers);
+        return;
+    }
+
+    MacroStep &step = _macro.steps[_macro.stepsCount - 1];
+
+    if (rising)
+    {
+        // Use the lowest limit bit as a waypoint of the current step
+        uint8_t bit = 0;
+        while (!(rising & LIMIT_MASK(bit)))
+            bit++;
+        step.type = MACRO_STEP_UNTIL_WAYPOINT;
+        step.waypointBit = bit;
+        _closeStep(nowMs);
+        _openStep(nowMs, levers);
+    }
+    else if (!_isSameVector(step.levers, levers) || nowMs - _stepStartMs >= MACRO_MAX_STEP_DURATION)
+    {
+        _closeStep(nowMs);
+        _openStep(nowMs, levers);
+    }
+}
+
+/**
+ * @brief Stop recording and finalize the macro.
+ *
+ * @param nowMs Current time in milliseconds.
+ * @return true if the recorded macro contains at least one step.
+ */
+bool MacroEngine::stopRecording(uint32_t nowMs)
+{
+    if (_state != MACRO_RECORDING)
+        return false;
+
+    if (_macro.stepsCount > 0)
+    {
+        _closeStep(nowMs);
+
+        // Drop the trailing idle step, the playback stops the motors anyway
+        const MacroStep &last = _macro.steps[_macro.stepsCount - 1];
+        if (last.type == MACRO_STEP_HOLD && !isOperatorInput(last.levers))
+            _macro.stepsCount--;
+    }
+
+    _state = MACRO_IDLE;
+    return _macro.stepsCount > 0;
+}
+
+/**
+ * @brief Start playing the stored macro.
+ *
+ * @param nowMs Current time in milliseconds.
+ * @param limits Current limit switches bitmask.
+ * @return true if the playback was started.
+ */
+bool MacroEngine::startPlayback(uint32_t nowMs, uint16_t limits)
+{
+    if (_state != MACRO_IDLE || _macro.stepsCount == 0)
+        return false;
+
+    _state = MACRO_PLAYING;
+    _stopReason = MACRO_STOP_NONE;
+    _stepIndex = 0;
+    _stepStartMs = nowMs;
+    _lastLimits = limits;
+    return true;
+}
+
+/**
+ * @brief Advance the playback and get the lever vector to apply.
+ * Step boundaries are computed from the step start time, not from the tick time, so the playback
+ * does not drift when ticks are late.
+ * @note This function should be called periodically with the control loop frequency.
+ *
+ * @param nowMs Current time in milliseconds.
+ * @param limits Current limit switches bitmask.
+ * @param levers Output lever positions. Set to neutral when the playback is not running.
+ * @return true while the playback is running.
+ */
+bool MacroEngine::tick(uint32_t nowMs, uint16_t limits, int16_t levers[LEVERS_COUNT])
+{
+    uint16_t rising = limits & ~_lastLimits;
+    _lastLimits = limits;
+
+    while (_state == MACRO_PLAYING)
+    {
+        const MacroStep &step = _macro.steps[_stepIndex];
+        uint32_t elapsed = nowMs - _stepStartMs;
+
+        if (step.type == MACRO_STEP_UNTIL_WAYPOINT)
+        {
+            if (limits & LIMIT_MASK(step.waypointBit))
+            {
+                rising &= ~LIMIT_MASK(step.waypointBit);
+                _stepStartMs = nowMs;
+            }
+            else if (elapsed >= step.durationMs)
+            {
+                abort(MACRO_STOP_WAYPOINT_MISSED);
+                break;
+            }
+            else
+            {
+                break;
+            }
+        }
+        else
+        {
+            if (elapsed < step.durationMs)
+                break;
+            _stepStartMs += step.durationMs;
+        }
+
+        if (++_stepIndex >= _macro.stepsCount)
+        {
+            _state = MACRO_IDLE;
+            _stopReason = MACRO_STOP_FINISHED;
+        }
+    }
+
+    // Any other limit switch means the machine left the recorded path
+    if (_state == MACRO_PLAYING && rising)
+        abort(MACRO_STOP_GUARD);
+
+    if (_state == MACRO_PLAYING)
+        memcpy(levers, _macro.steps[_stepIndex].levers, sizeof(_macro.steps[0].levers));
+    else
+        memset(levers, 0, sizeof(_macro.steps[0].levers));
+
+    return _state == MACRO_PLAYING;
+}
+
+/**
+ * @brief Abort the playback.
+ *
+ * @param reason The reason of the abort.
+ */
+void MacroEngine::abort(MacroStopReason reason)
+{
+    if (_state != MACRO_PLAYING)
+        return;
+
+    _state = MACRO_IDLE;
+    _stopReason = reason;
+}
+
+/**
+ * @brief Check if any lever is deflected by the operator.
+ *
+ * @param levers Lever positions in the range of -255 to 255.
+ * @return true if at least one lever is out of the neutral zone.
+ */
+bool MacroEngine::isOperatorInput(const int16_t levers[LEVERS_COUNT])
+{
+    for (int i = 0; i < LEVERS_COUNT; ++i)
+    {
+        if (levers[i] > MACRO_ABORT_THRESHOLD || levers[i] < -MACRO_ABORT_THRESHOLD)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Replace the stored macro, e.g. with one loaded from the flash.
+ *
+ * @param macro The macro to load.
+ */
+void MacroEngine::load(const Macro &macro)
+{
+    if (_state != MACRO_IDLE || macro.stepsCount > MACRO_MAX_STEPS)
+        return;
+
+    _macro.stepsCount = macro.stepsCount;
+    memcpy(_macro.steps, macro.steps, macro.stepsCount * sizeof(MacroStep));
+}
+
+void MacroEngine::_closeStep(uint32_t nowMs)
+{
+    MacroStep &step = _macro.steps[_macro.stepsCount - 1];
+    uint32_t duration = nowMs - _stepStartMs;
+
+    if (step.type == MACRO_STEP_UNTIL_WAYPOINT)
+    {
+        // Waypoint steps store a timeout instead of the exact duration
+        duration = duration * MACRO_WAYPOINT_TIMEOUT_PCT / 100;
+        if (duration < MACRO_WAYPOINT_MIN_TIMEOUT)
+            duration = MACRO_WAYPOINT_MIN_TIMEOUT;
+    }
+
+    step.durationMs = duration > UINT16_MAX ? UINT16_MAX : duration;
+}
+
+bool MacroEngine::_openStep(uint32_t nowMs, const int16_t levers[LEVERS_COUNT])
+{
+    if (_macro.stepsCount >= MACRO_MAX_STEPS)
+    {
+        // No more space, finish the recording here. The last step is already closed.
+        _state = MACRO_IDLE;
+        return false;
+    }
+
+    MacroStep &step = _macro.steps[_macro.stepsCount++];
+    memcpy(step.levers, levers, sizeof(step.levers));
+    step.durationMs = 0;
+    step.type = MACRO_STEP_HOLD;
+    step.waypointBit = MACRO_NO_WAYPOINT;
+    _stepStartMs = nowMs;
+    return true;
+}
+
+bool MacroEngine::_isSameVector(const int16_t a[LEVERS_COUNT], const int16_t b[LEVERS_COUNT]) const
+{
+    for (int i = 0; i < LEVERS_COUNT; ++i)
+    {
+        if (a[i] - b[i] > MACRO_RECORD_TOLERANCE || b[i] - a[i] > MACRO_RECORD_TOLERANCE)
+            return false;
+    }
+    return true;
+}
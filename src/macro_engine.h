@@ -0,0 +1,108 @@
+/**
+ * @file macro_engine.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MACRO_ENGINE_H
+#define MACRO_ENGINE_H
+
+#include <stdint.h>
+
+#include "constants.h"
+
+// Macro engine parameters
+#define MACRO_MAX_STEPS            128   // Maximum number of steps in one macro
+#define MACRO_RECORD_TOLERANCE     8     // Lever difference treated as the same vector while recording
+#define MACRO_ABORT_THRESHOLD      40    // Lever deflection that aborts the playback
+#define MACRO_WAYPOINT_TIMEOUT_PCT 200   // Waypoint timeout in percent of the recorded step duration
+#define MACRO_WAYPOINT_MIN_TIMEOUT 500   // Minimum waypoint timeout in milliseconds
+#define MACRO_NO_WAYPOINT          0xFF  // Step has no limit switch waypoint
+#define MACRO_MAX_STEP_DURATION    60000 // Longer steps are split while recording
+
+/*
+ * Limit switch states are passed to the engine as a bitmask.
+ * Every lever has two bits: positive limit and negative limit.
+ */
+#define MACRO_LIMIT_BIT(lever, negative) ((lever) * 2 + ((negative) ? 1 : 0))
+
+enum MacroState
+{
+    MACRO_IDLE,
+    MACRO_RECORDING,
+    MACRO_PLAYING
+};
+
+enum MacroStopReason
+{
+    MACRO_STOP_NONE,
+    MACRO_STOP_FINISHED,        // All steps were played
+    MACRO_STOP_OPERATOR,        // Aborted by the operator
+    MACRO_STOP_WAYPOINT_MISSED, // Expected limit switch was not reached in time
+    MACRO_STOP_GUARD            // Unexpected limit switch was reached
+};
+
+enum MacroStepType : uint8_t
+{
+    MACRO_STEP_HOLD,          // Hold the lever vector for a fixed duration
+    MACRO_STEP_UNTIL_WAYPOINT // Hold the lever vector until the limit switch is reached
+};
+
+struct MacroStep
+{
+    int16_t levers[LEVERS_COUNT]; // Lever positions in the range of -255 to 255
+    uint16_t durationMs;          // Hold duration or waypoint timeout
+    MacroStepType type;
+    uint8_t waypointBit; // Limit bit for the waypoint steps
+};
+
+struct Macro
+{
+    uint16_t stepsCount;
+    MacroStep steps[MACRO_MAX_STEPS];
+};
+
+/**
+ * @brief Records and replays timed sequences of lever vectors.
+ *
+ * The engine has no hardware dependencies: time and limit switch states are passed by the caller,
+ * so the same sequence of calls always produces the same output.
+ */
+class MacroEngine
+{
+public:
+    MacroEngine();
+
+    void startRecording(uint32_t nowMs, uint16_t limits);
+    void record(uint32_t nowMs, const int16_t levers[LEVERS_COUNT], uint16_t limits);
+    bool stopRecording(uint32_t nowMs);
+
+    bool startPlayback(uint32_t nowMs, uint16_t limits);
+    bool tick(uint32_t nowMs, uint16_t limits, int16_t levers[LEVERS_COUNT]);
+    void abort(MacroStopReason reason);
+
+    static bool isOperatorInput(const int16_t levers[LEVERS_COUNT]);
+
+    MacroState state() const { return _state; }
+    MacroStopReason stopReason() const { return _stopReason; }
+    uint16_t currentStep() const { return _stepIndex; }
+    const Macro &macro() const { return _macro; }
+    void load(const Macro &macro);
+
+private:
+    void _closeStep(uint32_t nowMs);
+    bool _openStep(uint32_t nowMs, const int16_t levers[LEVERS_COUNT]);
+    bool _isSameVector(const int16_t a[LEVERS_COUNT], const int16_t b[LEVERS_COUNT]) const;
+
+    Macro _macro;
+    MacroState _state;
+    MacroStopReason _stopReason;
+    uint16_t _stepIndex;
+    uint32_t _stepStartMs;
+    uint16_t _lastLimits;
+};
+
+#endif // MACRO_ENGINE_H
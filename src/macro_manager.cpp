@@ -0,0 +1,311 @@
+/**
+ * @file macro_manager.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "macro_manager.h"
+#include <Preferences.h>
+
+#include "heap_guard.h"
+#include "logger.h"
+#include "macro_engine.h"
+#include "supervisor.h"
+#include "task_plan.h"
+
+// Button parameters
+#define MACRO_DOUBLE_PRESS_WINDOW_MS 500 // Two presses within this window start the recording
+
+// NVS storage parameters
+#define MACRO_NVS_NAMESPACE "macro"
+#define MACRO_NVS_KEY       "cycle"
+
+
+MacroEngine macroEngine;
+SemaphoreHandle_t macroMutex;
+StaticSemaphore_t macroMutexBuffer;
+
+macro_apply_cb_t macroApply = NULL;
+macro_limits_cb_t macroLimits = NULL;
+
+// Button presses are counted in the ESP-NOW callback and resolved in the task
+volatile uint8_t macroPendingPresses = 0;
+volatile uint32_t macroFirstPressTime = 0;
+
+const char *_stopReasonToString(MacroStopReason reason)
+{
+    switch (reason)
+    {
+        case MACRO_STOP_FINISHED:
+            return "finished";
+        case MACRO_STOP_OPERATOR:
+            return "aborted by operator";
+        case MACRO_STOP_WAYPOINT_MISSED:
+            return "waypoint missed";
+        case MACRO_STOP_GUARD:
+            return "unexpected limit switch";
+        default:
+            return "none";
+    }
+}
+
+/**
+ * @brief Load the stored macro from the NVS.
+ */
+void _loadMacro()
+{
+    static Macro macro;
+    Preferences prefs;
+
+    if (!prefs.begin(MACRO_NVS_NAMESPACE, true))
+        return;
+
+    size_t len = prefs.getBytes(MACRO_NVS_KEY, &macro, sizeof(macro));
+    prefs.end();
+
+    if (len >= sizeof(macro.stepsCount) && macro.stepsCount <= MACRO_MAX_STEPS &&
+        len >= sizeof(macro.stepsCount) + macro.stepsCount * sizeof(MacroStep))
+    {
+        macroEngine.load(macro);
+        logPrintf("Macro loaded: %d steps\n", macro.stepsCount);
+    }
+}
+
+/**
+ * @brief Save the recorded macro to the NVS. Only the used steps are written.
+ * @note The flash write blocks for a long time, so it must not be called with the macro mutex taken.
+ *
+ * @param macro Copy of the recorded macro.
+ */
+void _saveMacro(const Macro &macro)
+{
+    Preferences prefs;
+
+    if (!prefs.begin(MACRO_NVS_NAMESPACE, false))
+    {
+        logPrintf("Failed to open macro storage\n");
+        return;
+    }
+
+    size_t len = offsetof(Macro, steps) + macro.stepsCount * sizeof(MacroStep);
+    if (prefs.putBytes(MACRO_NVS_KEY, &macro, len) != len)
+        logPrintf("Failed to save macro\n");
+    prefs.end();
+}
+
+/**
+ * @brief Resolve the pending button presses.
+ * Single press stops the recording, aborts or starts the playback. Double press starts the recording.
+ *
+ * @return true if a recording has finished and the macro must be saved.
+ */
+bool _handleButton(uint32_t now)
+{
+    if (macroPendingPresses == 0)
+        return false;
+
+    // Wait for a possible second press
+    if (macroPendingPresses == 1 && now - macroFirstPressTime < MACRO_DOUBLE_PRESS_WINDOW_MS &&
+        macroEngine.state() == MACRO_IDLE)
+        return false;
+
+    bool doublePress = macroPendingPresses > 1;
+    macroPendingPresses = 0;
+
+    switch (macroEngine.state())
+    {
+        case MACRO_IDLE:
+            if (doublePress)
+            {
+                macroEngine.startRecording(now, macroLimits());
+                logPrintf("Macro recording started\n");
+            }
+            else if (macroEngine.startPlayback(now, macroLimits()))
+            {
+                logPrintf("Macro playback started: %d steps\n", macroEngine.macro().stepsCount);
+            }
+            else
+            {
+                logPrintf("No macro recorded\n");
+            }
+            break;
+        case MACRO_RECORDING:
+            if (macroEngine.stopRecording(now))
+            {
+                logPrintf("Macro recorded: %d steps\n", macroEngine.macro().stepsCount);
+                return true;
+            }
+            else
+            {
+                logPrintf("Macro recording is empty\n");
+            }
+            break;
+        case MACRO_PLAYING:
+            macroEngine.abort(MACRO_STOP_OPERATOR);
+            break;
+    }
+    return false;
+}
+
+// Task memory is allocated statically
+StackType_t macroTaskStack[TASK_PLAN[TASK_MACRO].stackSize];
+StaticTask_t macroTaskBuffer;
+
+/**
+ * @brief Task function for the macro playback.
+ *
+ * The stored macro is played with the control loop period from the task plan.
+ *
+ * @param pvParameters A pointer to task parameters (not used in this function).
+ */
+void macroTask(void *pvParameters)
+{
+    const TickType_t xFrequency = pdMS_TO_TICKS(TASK_PLAN[TASK_MACRO].periodMs);
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    int16_t levers[LEVERS_COUNT];
+
+    // Recorded macro copied out of the mutex to be saved, too large for the task stack
+    static Macro recorded;
+
+    // The NVS allocates internally
+    heapGuardExemptBegin();
+    _loadMacro();
+    heapGuardExemptEnd();
+
+    logPrintf("macroTask started\n");
+
+    // Main task loop
+    for (;;)
+    {
+        xSemaphoreTake(macroMutex, portMAX_DELAY);
+
+        uint32_t now = millis();
+        bool save = _handleButton(now);
+        if (save)
+            recorded = macroEngine.macro();
+
+        bool wasPlaying = macroEngine.state() == MACRO_PLAYING;
+        bool playing = macroEngine.tick(now, macroLimits(), levers);
+
+        // Apply the macro output, or neutral levers once when the playback has stopped
+        if (playing || wasPlaying)
+            macroApply(levers);
+
+        if (wasPlaying && !playing)
+            logPrintf("Macro playback stopped at step %d: %s\n", macroEngine.currentStep(),
+                      _stopReasonToString(macroEngine.stopReason()));
+
+        xSemaphoreGive(macroMutex);
+
+        // The control task takes the mutex for every frame, so it is not blocked by the flash write
+        if (save)
+        {
+            heapGuardExemptBegin();
+            _saveMacro(recorded);
+            heapGuardExemptEnd();
+        }
+
+        supervisorFeed();
+
+        // Wait for the next cycle.
+        xTaskDelayUntil(&xLastWakeTime, xFrequency);
+    }
+}
+
+/**
+ * @brief Initializes the macro task.
+ *
+ * @param applyCallback Function that applies the lever vector to the motors.
+ * @param limitsCallback Function that returns the current limit switches bitmask.
+ *
+ * @note This function should be called once during the setup phase of the program.
+ */
+void macroTaskInit(macro_apply_cb_t applyCallback, macro_limits_cb_t limitsCallback)
+{
+    macroApply = applyCallback;
+    macroLimits = limitsCallback;
+
+    macroMutex = xSemaphoreCreateMutexStatic(&macroMutexBuffer);
+    configASSERT(macroMutex);
+
+    TaskHandle_t task = xTaskCreateStaticPinnedToCore(macroTask,
+                                                     TASK_PLAN[TASK_MACRO].name,
+                                                     TASK_PLAN[TASK_MACRO].stackSize,
+                                                     NULL,
+                                                     TASK_PLAN[TASK_MACRO].priority,
+                                                     macroTaskStack,
+                                                     &macroTaskBuffer,
+                                                     TASK_PLAN[TASK_MACRO].core);
+    if (task == NULL)
+    {
+        logPrintf("Failed to create macroTask\n");
+    }
+    taskPlanRegister(TASK_MACRO, task);
+    heapGuardProtectTask(task);
+}
+
+/**
+ * @brief Pass the operator lever positions to the macro engine.
+ * While recording the levers are stored. While playing any lever deflection aborts the playback
+ * and the operator takes over immediately.
+ *
+ * @param levers Lever positions received from the Controller.
+ * @return true if the macro is playing and the levers must not be applied to the motors.
+ */
+bool macroHandleOperatorInput(const int16_t levers[LEVERS_COUNT])
+{
+    bool macroOwnsMotors = false;
+
+    xSemaphoreTake(macroMutex, portMAX_DELAY);
+
+    switch (macroEngine.state())
+    {
+        case MACRO_RECORDING:
+            macroEngine.record(millis(), levers, macroLimits());
+            break;
+        case MACRO_PLAYING:
+            if (MacroEngine::isOperatorInput(levers))
+            {
+                macroEngine.abort(MACRO_STOP_OPERATOR);
+                logPrintf("Macro playback aborted by operator at step %d\n", macroEngine.currentStep());
+            }
+            else
+            {
+                macroOwnsMotors = true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    xSemaphoreGive(macroMutex);
+
+    return macroOwnsMotors;
+}
+
+/**
+ * @brief Register a macro button press. The press is handled in the macro task.
+ */
+void macroButtonPressed()
+{
+    if (macroPendingPresses == 0)
+        macroFirstPressTime = millis();
+    macroPendingPresses = macroPendingPresses + 1;
+}
+
+/**
+ * @brief Abort the macro playback, e.g. before an OTA update.
+ */
+void macroAbort()
+{
+    // May be called before the macro task is initialized, e.g. on a PWM fault at boot
+    if (macroMutex == NULL)
+        return;
+
+    xSemaphoreTake(macroMutex, portMAX_DELAY);
+    macroEngine.abort(MACRO_STOP_OPERATOR);
+    xSemaphoreGive(macroMutex);
+}
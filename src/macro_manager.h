@@ -0,0 +1,27 @@
+/**
+ * @file macro_manager.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MACRO_MANAGER_H
+#define MACRO_MANAGER_H
+
+#include <Arduino.h>
+
+#include "constants.h"
+
+// Applies a lever vector to the motors
+typedef void (*macro_apply_cb_t)(const int16_t levers[LEVERS_COUNT]);
+// Returns the current limit switches bitmask, see MACRO_LIMIT_BIT()
+typedef uint16_t (*macro_limits_cb_t)(void);
+
+void macroTaskInit(macro_apply_cb_t applyCallback, macro_limits_cb_t limitsCallback);
+bool macroHandleOperatorInput(const int16_t levers[LEVERS_COUNT]);
+void macroButtonPressed();
+void macroAbort();
+
+#endif // MACRO_MANAGER_H
@@ -1,121 +1,317 @@
 #include <WiFi.h>
+#include <seqlock.h>
 
+#include "benchmark.h"
 #include "constants.h"
+#include "control_manager.h"
 #include "data_structures.h"
 #include "esp_now_manager.h"
+#include "heap_guard.h"
 #include "lights.h"
-#include "motor.h"
+#include "logger.h"
+#include "machine.h"
+#include "macro_manager.h"
 #include "power_manager.h"
 #include "pwm_controller.h"
+#include "radio_manager.h"
+#include "shell.h"
+#include "supervisor.h"
+#include "task_plan.h"
+#include "telemetry_manager.h"
+#include "travel_manager.h"
 #include "wifi_ota_manager.h"
 
-// Create Motor objects for each motor
-Motor boomMotor(BOOM_MOTOR_POS_PIN, BOOM_MOTOR_NEG_PIN);
-Motor bucketMotor(BUCKET_MOTOR_POS_PIN, BUCKET_MOTOR_NEG_PIN);
-Motor stickMotor(STICK_MOTOR_POS_PIN, STICK_MOTOR_NEG_PIN, true, true);
-Motor swingMotor(SWING_MOTOR_POS_PIN, SWING_MOTOR_NEG_PIN, false, true);
-Motor leftTravelMotor(LEFT_TRAVEL_MOTOR_POS_PIN, LEFT_TRAVEL_MOTOR_NEG_PIN, true, true);
-Motor rightTravelMotor(RIGHT_TRAVEL_MOTOR_POS_PIN, RIGHT_TRAVEL_MOTOR_NEG_PIN, true, true);
+// Speeds and limit switches published by the control task for the other tasks
+struct MachineState
+{
+    int16_t speeds[AXIS_COUNT];
+    uint16_t limits;
+};
+
+// Create Motor objects for each axis of the machine. They are driven by the control task only,
+// the other tasks submit commands to it and read the published state.
+Machine<AXIS_COUNT, MACHINE_AXES> machine;
+Seqlock<MachineState> machineState;
 
 // Create a variable to store the received data
 controller_data_struct receivedData;
 
-// Create a variable to store the data that will be sent to the Controller
-excavator_data_struct dataToSend;
+// Duration of the limit switch and position updates
+uint32_t loopMaxUs = 0;
 
-// Callback when data from Controller received
-void onDataFromController(const uint8_t *mac, const uint8_t *incomingData, int len)
+// Apply lever positions to the motors, called in the control task on core 1. Ignored while the
+// actuators are parked for an OTA update or the PWM output has failed.
+void applyLeverPositions(const int16_t levers[LEVERS_COUNT])
+{
+    if (otaActuatorsParked() || pwmHasFault())
+        return;
+
+    // The travel levers are mixed into the track speeds
+    int16_t mixed[LEVERS_COUNT];
+    memcpy(mixed, levers, sizeof(mixed));
+    travelMixLevers(mixed);
+
+    machine.applyLevers(mixed);
+}
+
+// Apply a macro or shell command, called in the control task on core 1
+void onControlCommand(const ControlCommand &command)
+{
+    if (command.type == CONTROL_COMMAND_LEVERS)
+        applyLeverPositions(command.levers);
+    else if (!otaActuatorsParked() && !pwmHasFault() && command.axis < AXIS_COUNT)
+        machine.motor(command.axis).setSpeed(command.speed);
+}
+
+// Set the speed of one axis from the shell. Rejected while the motors are parked.
+bool setAxisSpeed(uint8_t axis, int16_t speed)
+{
+    if (otaActuatorsParked() || pwmHasFault() || axis >= AXIS_COUNT)
+        return false;
+
+    ControlCommand command = {CONTROL_COMMAND_AXIS, axis, speed, {}};
+    return controlSubmitCommand(command);
+}
+
+// Set the lever positions from the shell
+bool setLeverPositions(const int16_t levers[LEVERS_COUNT])
+{
+    ControlCommand command = {CONTROL_COMMAND_LEVERS, 0, 0, {}};
+    memcpy(command.levers, levers, sizeof(command.levers));
+    return controlSubmitCommand(command);
+}
+
+// Read the limit switch statistics for the shell
+bool getLimitSwitchStats(uint8_t axis, bool positive, LimitSwitchStats &stats)
+{
+    return axis < AXIS_COUNT && machine.motor(axis).limitSwitchStats(positive, stats);
+}
+
+// Stop all motors, called in the control task on core 1
+void stopActuators()
+{
+    macroAbort();
+    machine.stopAll();
+}
+
+// Stop all motors from another task, used when an OTA update starts
+void parkActuators()
+{
+    macroAbort();
+    controlRequestStop();
+}
+
+// Stop all motors when the PWM expander can't be recovered. The expander outputs can't be changed
+// over the failed bus, so the motor drivers are put to sleep until the bus recovers.
+void onPwmFault(bool fault)
+{
+    if (fault)
+        parkActuators();
+    digitalWrite(MOTOR_DRIVER_SLEEP_PIN, fault ? LOW : HIGH);
+}
+
+// Get limit switches states as a bitmask for the macro engine
+uint16_t getLimitSwitchesMask()
+{
+    return machineState.read().limits;
+}
+
+// Update the limit switches, then the position estimates they recalibrate, called in the control
+// task on core 1. Returns the time until the next update is needed without a new event.
+uint32_t updateMachine()
+{
+    uint32_t start = micros();
+
+    machine.updateLimitSwitches();
+    machine.updatePositions();
+
+    MachineState state;
+    for (size_t i = 0; i < AXIS_COUNT; i++)
+        state.speeds[i] = machine.motor(i).commandedSpeed();
+    state.limits = machine.limitsMask();
+    machineState.write(state);
+
+    uint32_t now = micros();
+    if (now - start > loopMaxUs)
+        loopMaxUs = now - start;
+    telemetrySet(TLM_LOOP_US, now - start);
+    telemetrySet(TLM_LOOP_MAX_US, loopMaxUs);
+
+    return machine.nextUpdateUs(now);
+}
+
+// Collect the telemetry fields owned by the main module
+void updateTelemetry()
+{
+    static_assert(TLM_BOOM_DUTY + AXIS_COUNT == TLM_LIMITS, "Every axis must have a duty field");
+
+    MachineState state = machineState.read();
+    for (size_t i = 0; i < AXIS_COUNT; i++)
+        telemetrySet(static_cast<TelemetryField>(TLM_BOOM_DUTY + i), state.speeds[i]);
+    telemetrySet(TLM_LIMITS, state.limits);
+
+    PwmHealth pwmHealth = pwmGetHealth();
+    const EspNowStats &linkStats = getEspNowStats();
+    int32_t faults = 0;
+    if (pwmHealth.fault)
+        faults |= TLM_FAULT_PWM;
+    if (!pwmIsExpanderReady())
+        faults |= TLM_FAULT_EXPANDER;
+    if (!linkStats.encrypted)
+        faults |= TLM_FAULT_UNENCRYPTED;
+    if (otaActuatorsParked())
+        faults |= TLM_FAULT_OTA_PARKED;
+    telemetrySet(TLM_FAULTS, faults);
+
+    telemetrySet(TLM_OTA_STATE, otaGetState());
+    telemetrySet(TLM_OTA_PROGRESS, otaGetProgress());
+    telemetrySet(TLM_UPTIME, millis() / 1000);
+    telemetrySet(TLM_LIGHT_MODE, lightsGetMode());
+    telemetrySet(TLM_I2C_ERRORS, pwmHealth.i2cErrors);
+    telemetrySet(TLM_I2C_RECOVERIES, pwmHealth.recoveries);
+    telemetrySet(TLM_LINK_ACCEPTED, linkStats.accepted);
+    telemetrySet(TLM_LINK_REJECTED, linkStats.rejectedUnknown + linkStats.rejectedPriority +
+                                        linkStats.rejectedLockout + linkStats.rejectedLength +
+                                        linkStats.rejectedReplay);
+    telemetrySet(TLM_LINK_RX_PATH_MAX_US, linkStats.rxPathMaxUs);
+}
+
+// Apply a Controller frame, called in the control task on core 1
+void onControlFrame(const controller_data_struct &frame)
 {
     static bool lastButtonsState[BUTTONS_COUNT] = {0};
+    static bool comboHeld = false;
+    static bool firstFrame = true;
 
-    memcpy(&receivedData, incomingData, sizeof(receivedData));
-    Serial.printf("Received from Controller: Boom: %3d | Bucket: %3d | Stick: %3d | Swing: %3d | "
-                  "Track Left: %3d | Track Right: %3d | Lights: %d | Center Swing: %d | Beacon: %d | Battery: %3d\n",
-                  receivedData.leverPositions[0], receivedData.leverPositions[1], receivedData.leverPositions[2],
-                  receivedData.leverPositions[3], receivedData.leverPositions[4], receivedData.leverPositions[5],
-                  receivedData.buttonsStates[0], receivedData.buttonsStates[1], receivedData.buttonsStates[2],
-                  receivedData.battery);
-
-    // Control motors based on received data
-    boomMotor.setSpeed(receivedData.leverPositions[0]);
-    bucketMotor.setSpeed(receivedData.leverPositions[1]);
-    stickMotor.setSpeed(receivedData.leverPositions[2]);
-    swingMotor.setSpeed(receivedData.leverPositions[3]);
-    leftTravelMotor.setSpeed(receivedData.leverPositions[4]);
-    rightTravelMotor.setSpeed(receivedData.leverPositions[5]);
+    if (firstFrame)
+    {
+        firstFrame = false;
+        logBootStage("first Controller frame");
+    }
+
+    // Control motors based on received data unless a macro is playing
+    if (!macroHandleOperatorInput(frame.leverPositions))
+        applyLeverPositions(frame.leverPositions);
+
+    // Lights and Beacon buttons held together switch the radio profile once. Their changes are
+    // consumed until both are released, so the combo does not switch the lights or the beacon.
+    if (frame.buttonsStates[0] && frame.buttonsStates[2] && !comboHeld)
+    {
+        comboHeld = true;
+        radioToggleProfile();
+    }
+    if (comboHeld)
+    {
+        lastButtonsState[0] = frame.buttonsStates[0];
+        lastButtonsState[2] = frame.buttonsStates[2];
+        comboHeld = frame.buttonsStates[0] || frame.buttonsStates[2];
+    }
 
     // Change light mode
-    if (lastButtonsState[0] != receivedData.buttonsStates[0])
+    if (lastButtonsState[0] != frame.buttonsStates[0])
     {
-        lastButtonsState[0] = receivedData.buttonsStates[0];
+        lastButtonsState[0] = frame.buttonsStates[0];
         nextLightMode();
     }
 
-    // Center swing position
-    if (lastButtonsState[1] != receivedData.buttonsStates[1])
+    // Center swing button controls the macros: single press plays, stops or aborts, double press records
+    if (lastButtonsState[1] != frame.buttonsStates[1])
     {
-        lastButtonsState[1] = receivedData.buttonsStates[1];
-        Serial.println("Center Swing button state changed");
-        // TODO: Implement swing center switch logic
+        lastButtonsState[1] = frame.buttonsStates[1];
+        macroButtonPressed();
     }
 
     // Change beacon light mode
-    if (lastButtonsState[2] != receivedData.buttonsStates[2])
+    if (lastButtonsState[2] != frame.buttonsStates[2])
     {
-        lastButtonsState[2] = receivedData.buttonsStates[2];
+        lastButtonsState[2] = frame.buttonsStates[2];
         beaconLightChangeMode();
     }
+}
 
-    // Update and send data to Controller
-    dataToSend.uptime = millis() / 1000;
-    sendDataToController(dataToSend);
+// Callback when data from Controller received, called in the Wi-Fi task on core 0
+void onDataFromController(const uint8_t *mac, const uint8_t *incomingData, int len)
+{
+    memcpy(&receivedData, incomingData, sizeof(receivedData));
+
+    // Hand the frame over to the control task first, the rest runs in parallel on this core
+    controlSubmitFrame(receivedData);
+
+    radioFrameReceived();
+    logPrintf("Received from Controller: Boom: %3d | Bucket: %3d | Stick: %3d | Swing: %3d | "
+              "Track Left: %3d | Track Right: %3d | Lights: %d | Center Swing: %d | Beacon: %d | Battery: %3d\n",
+              receivedData.leverPositions[BOOM_LEVER], receivedData.leverPositions[BUCKET_LEVER],
+              receivedData.leverPositions[STICK_LEVER], receivedData.leverPositions[SWING_LEVER],
+              receivedData.leverPositions[LEFT_TRAVEL_LEVER], receivedData.leverPositions[RIGHT_TRAVEL_LEVER],
+              receivedData.buttonsStates[0], receivedData.buttonsStates[1], receivedData.buttonsStates[2],
+              receivedData.battery);
+
+    // Update and send telemetry to Controller
+    updateTelemetry();
+    telemetrySend();
 }
 
 void setup()
 {
-    // Setup pins
-    pinMode(SWING_CENTER_SWITCH_PIN, INPUT_PULLUP);
+    // Stage 1: actuators safe. The expanders keep their outputs over a software reset, so the motor
+    // drivers stay asleep until the PWM task has written all channels and wakes them via onPwmFault().
+    pinMode(MOTOR_DRIVER_SLEEP_PIN, OUTPUT);
+    digitalWrite(MOTOR_DRIVER_SLEEP_PIN, LOW);
+    machine.setupOutputs();
 
-    // Init Serial Monitor
+    // Init Serial Monitor, the larger receive buffer is used by the binary shell mode
+    Serial.setRxBufferSize(SHELL_RX_BUFFER_SIZE);
     Serial.begin(115200);
+    logBootStage("actuators safe");
 
-    // Setup PWM
-    pwmTaskInit();
-
-    // Setup lights
-    lightsTaskInit();
-
-    // Setup power manager
-    powerManagerTaskInit();
+    // Report a reset caused by a hung task
+    supervisorPrintResetReason();
 
-    // Setup limit switches
-    boomMotor.setupLimitSwitches(BOOM_LOW_LIMIT_PIN, BOOM_HIGH_LIMIT_PIN);
-    bucketMotor.setupLimitSwitches(BUCKET_ROLL_IN_LIMIT_PIN, BUCKET_ROLL_OUT_LIMIT_PIN);
-    stickMotor.setupLimitSwitches(STICK_ROLL_IN_LIMIT_PIN, STICK_ROLL_OUT_LIMIT_PIN);
+    // The loop task is created by the Arduino core, it is only checked against the plan
+    taskPlanRegister(TASK_LOOP, xTaskGetCurrentTaskHandle());
 
-    // Init Wi-Fi and OTA
-    setupWiFi();
-    setupOTA();
+    // Stage 2: control path. The benchmark build measures it while the drivers still sleep
+    // and the PWM task does not write the outputs yet, then the output latencies with the PWM task.
+    machine.setupLimitSwitches();
+    benchmarkRun(machine.motor(BOOM_AXIS));
+    pwmTaskInit(onPwmFault);
+    benchmarkRunOutputs();
+    travelInit();
+    macroTaskInit(controlSubmitLevers, getLimitSwitchesMask);
+    controlTaskInit(onControlFrame, onControlCommand, updateMachine, stopActuators);
+    logBootStage("control path ready");
 
-    // Init ESP-NOW
+    // Stage 3: ESP-NOW link. Wi-Fi and OTA of the maintenance profile are started later by the OTA task.
+    radioInit(RADIO_DEFAULT_PROFILE, parkActuators);
     initEspNow();
-
-    // Register callback for data received from Controller
     registerDataRecvCallback(onDataFromController);
+    logBootStage("ESP-NOW ready");
+
+    // Stage 4: background services
+    lightsTaskInit();
+    powerManagerTaskInit();
+    otaTaskInit(parkActuators);
+    shellTaskInit(setAxisSpeed, setLeverPositions, getLimitSwitchStats);
+
+    // Supervise all tasks, a hung task stops the motors and resets the chip
+    supervisorTaskInit();
+    logBootStage("services started");
 
     // Finish initialization by logging message
-    Serial.printf("\n%s [%s] initialized\n", HOSTNAME, WiFi.macAddress().c_str());
+    logPrintf("\n%s [%s] initialized\n", HOSTNAME, WiFi.macAddress().c_str());
+
+    // Verify the cores, priorities and stacks of all tasks
+    taskPlanReport();
+
+    // The control path must not allocate from now on
+    heapGuardArm();
 }
 
 void loop()
 {
-    handleOTA();
+    heapGuardReport();
+    supervisorFeed();
 
-    // Update limit switches
-    boomMotor.updateLimitSwitches();
-    bucketMotor.updateLimitSwitches();
-    stickMotor.updateLimitSwitches();
-
-    // Delay for some time to avoid high CPU usage
-    delay(10);
-}
\ No newline at end of file
+    // The motors and the limit switches are handled by the control task
+    vTaskDelay(pdMS_TO_TICKS(TASK_PLAN[TASK_LOOP].periodMs));
+}
@@ -1,123 +1,223 @@
 #include "motor.h"
-#include <FunctionalInterrupt.h>
+#include "event_loop.h"
 #include "pwm_controller.h"
 
 /**
  * @brief Construct a new Motor object.
  *
- * @param posMotorPin The GPIO pin number of the positive motor terminal.
- * @param negMotorPin The GPIO pin number of the negative motor terminal.
- * @param breakMode Flag indicating whether to use braking mode.
- * @param reverse Flag indicating whether to reverse the motor direction.
+ * @param config The description of the motor axis.
+ * @param ledcChannel The first of two LEDC channels, used only with MOTOR_OUTPUT_LEDC.
  */
-Motor::Motor(uint8_t posMotorPin, uint8_t negMotorPin, bool breakMode, bool reverse)
+Motor::Motor(const AxisConfig &config, uint8_t ledcChannel)
+    : posLimitReached(false), negLimitReached(false),
+      _output(config.output), _posMotorPin(config.posMotorPin), _negMotorPin(config.negMotorPin),
+      _ledcChannel(ledcChannel),
+      _breakMode(config.breakMode), _reverse(config.reverse),
+      _deadband(config.deadband), _maxSpeed(config.maxSpeed), _commandedSpeed(0),
+      _requestedSpeed(0), _posLimit(config.posLimitPin), _negLimit(config.negLimitPin),
+      _center(config.centerPin), _centerReached(false),
+      _position(config.travelMs, config.slowZone, config.posLimitPin != GPIO_NUM_NC,
+                config.negLimitPin != GPIO_NUM_NC),
+      _lastPositionUs(0)
 {
-    _posMotorPin = posMotorPin;
-    _negMotorPin = negMotorPin;
-    _breakMode = breakMode;
-    _reverse = reverse;
 }
 
 /**
- * @brief Setup the limit switches for the motor.
- *
- * @param posLimitPin The GPIO pin number of the positive limit switch.
- * @param negLimitPin The GPIO pin number of the negative limit switch.
- * @param debounceTime The debounce time in milliseconds.
+ * @brief Setup the motor output and stop the motor.
+ * Expander outputs are initialized by the PWM task, LEDC outputs are attached here.
  */
-void Motor::setupLimitSwitches(gpio_num_t posLimitPin, gpio_num_t negLimitPin, uint32_t debounceTime)
+void Motor::setupOutput()
 {
-    // Set the debounce time
-    _debounceTime = debounceTime;
+    if (_output == MOTOR_OUTPUT_LEDC)
+    {
+        ledcSetup(_ledcChannel, MOTOR_LEDC_FREQUENCY, MOTOR_LEDC_RESOLUTION);
+        ledcSetup(_ledcChannel + 1, MOTOR_LEDC_FREQUENCY, MOTOR_LEDC_RESOLUTION);
+        ledcAttachPin(_posMotorPin, _ledcChannel);
+        ledcAttachPin(_negMotorPin, _ledcChannel + 1);
+    }
+
+    stop();
+}
 
-    // Set the limit pins
-    if (posLimitPin != GPIO_NUM_NC)
+/**
+ * @brief Write both motor terminals to the configured output.
+ *
+ * @param posPinValue Positive terminal value in the range of PWM_OFF to PWM_ON.
+ * @param negPinValue Negative terminal value in the range of PWM_OFF to PWM_ON.
+ */
+void Motor::_setOutputs(uint16_t posPinValue, uint16_t negPinValue)
+{
+    if (_output == MOTOR_OUTPUT_LEDC)
     {
-        _posLimitPin = posLimitPin;
-        gpio_set_pull_mode(_posLimitPin, GPIO_PULLUP_ONLY);
-        attachInterrupt(digitalPinToInterrupt(_posLimitPin), std::bind(&Motor::_handlePosLimitReached, this), CHANGE);
+        ledcWrite(_ledcChannel, posPinValue);
+        ledcWrite(_ledcChannel + 1, negPinValue);
     }
-    if (negLimitPin != GPIO_NUM_NC)
+    else
     {
-        _negLimitPin = negLimitPin;
-        gpio_set_pull_mode(_negLimitPin, GPIO_PULLUP_ONLY);
-        attachInterrupt(digitalPinToInterrupt(_negLimitPin), std::bind(&Motor::_handleNegLimitReached, this), CHANGE);
+        setMotorPwm(_posMotorPin, _negMotorPin, posPinValue, negPinValue);
     }
 }
 
 /**
- * @brief Update the limit switches state with debouncing and stop the motor if a limit is reached.
- * @note This function should be called in the loop function.
+ * @brief Setup the limit switches of the motor axis.
+ * The interrupts are attached with a plain function and the switch as an argument, so no
+ * heap-allocated function objects are created.
+ */
+void Motor::setupLimitSwitches()
+{
+    _setupLimitSwitch(_posLimit, posLimitReached);
+    _setupLimitSwitch(_negLimit, negLimitReached);
+    _setupLimitSwitch(_center, _centerReached);
+}
+
+void Motor::_setupLimitSwitch(LimitSwitch &limit, bool &reached)
+{
+    if (limit.pin == GPIO_NUM_NC)
+        return;
+
+    pinMode(limit.pin, INPUT_PULLUP);
+    limit.debouncer.reset(!gpio_get_level(limit.pin));
+    limit.stats.write(limit.debouncer.stats());
+    reached = limit.debouncer.state();
+    attachInterruptArg(digitalPinToInterrupt(limit.pin), _limitIsr, &limit, CHANGE);
+}
+
+/**
+ * @brief Debounce the captured limit switch edges and stop the motor if a limit is reached.
+ * Every pressed switch also recalibrates the position estimate.
+ * @note This function should be called periodically from one task, the debounce window is
+ * extended by the call period.
  *
  * @param stopOnLimit Flag indicating whether to stop the motor when a limit is reached.
  */
 void Motor::updateLimitSwitches(bool stopOnLimit)
 {
-    // Check the positive limit switch if it is set
-    if (_posLimitPin != GPIO_NUM_NC)
+    if (_updateLimitSwitch(_posLimit, posLimitReached) && posLimitReached)
     {
-        // Check if the limit state has changed and the debounce time has passed
-        if (_lastPosLimitState != _posLimitState && millis() - _lastPosLimitTriggerTime > _debounceTime)
-        {
-            // Update the last state
-            _lastPosLimitState = _posLimitState;
-            // Set the limit reached flag
-            posLimitReached = _posLimitState;
-            // Update the last trigger time
-            _lastPosLimitTriggerTime = millis();
-            // Stop the motor if the limit is reached and stopOnLimit is true
-            if (posLimitReached && stopOnLimit)
-                stopImmediate();
-        }
+        _position.calibrate(POSITION_FULL_TRAVEL);
+        if (stopOnLimit)
+            stopImmediate();
     }
-
-    // Check the negative limit switch if it is set
-    if (_negLimitPin != GPIO_NUM_NC)
+    if (_updateLimitSwitch(_negLimit, negLimitReached) && negLimitReached)
     {
-        // Check if the limit state has changed and the debounce time has passed
-        if (_lastNegLimitState != _negLimitState && millis() - _lastNegLimitTriggerTime > _debounceTime)
-        {
-            // Update the last state
-            _lastNegLimitState = _negLimitState;
-            // Set the limit reached flag
-            negLimitReached = _negLimitState;
-            // Update the last trigger time
-            _lastNegLimitTriggerTime = millis();
-            // Stop the motor if the limit is reached
-            if (negLimitReached)
-                stopImmediate();
-        }
+        _position.calibrate(0);
+        if (stopOnLimit)
+            stopImmediate();
     }
+    if (_updateLimitSwitch(_center, _centerReached) && _centerReached)
+        _position.calibrate(POSITION_CENTER);
 }
 
 /**
- * @brief Handles the position limit reached event.
+ * @brief Integrate the position estimate and slow the motor down towards the soft limits.
+ * @note This function should be called periodically from the same task as updateLimitSwitches().
+ */
+void Motor::updatePosition()
+{
+    uint32_t now = micros();
+    _position.update(_commandedSpeed, now - _lastPositionUs);
+    _lastPositionUs = now;
+
+    // The allowed speed falls while the axis approaches an end, without waiting for a new lever position
+    if (_requestedSpeed != 0 && _position.limit(_requestedSpeed) != _commandedSpeed)
+        _applySpeed(_requestedSpeed);
+}
+
+/**
+ * @brief Feed the captured edges to the debouncer.
  *
- * This function is called when the position limit is reached. It updates the `_posLimitState`
- * variable based on the level of the `_posLimitPin` GPIO.
+ * @param limit The limit switch.
+ * @param reached Output: the debounced state.
+ * @return true if the debounced state has changed.
+ */
+bool Motor::_updateLimitSwitch(LimitSwitch &limit, bool &reached)
+{
+    if (limit.pin == GPIO_NUM_NC)
+        return false;
+
+    LimitEdge edge;
+    bool fed = false;
+    while (limit.edges.pop(edge))
+    {
+        limit.debouncer.edge(edge.timeUs, edge.level);
+        fed = true;
+    }
+
+    // An edge was lost or too short to be read by the interrupt, the pin level is the truth
+    uint32_t now = micros();
+    bool level = !gpio_get_level(limit.pin);
+    if (level != limit.debouncer.level())
+    {
+        limit.debouncer.edge(now, level);
+        fed = true;
+    }
+
+    // A press is reported before its burst may end, so even a pulse shorter than the update period stops
+    // the motor. The burst is closed by the next update.
+    bool ended = false;
+    if (!limit.debouncer.state() || reached)
+        ended = limit.debouncer.update(now);
+    if (fed || ended)
+    {
+        LimitSwitchStats stats = limit.debouncer.stats();
+        stats.dropped = limit.edges.dropped();
+        limit.stats.write(stats);
+    }
+
+    if (limit.debouncer.state() == reached)
+        return false;
+    reached = limit.debouncer.state();
+    return true;
+}
+
+/**
+ * @brief Time until the axis needs the next update without a new limit switch edge.
  *
- * @note This function is marked with the `IRAM_ATTR` attribute to ensure it is placed in the
- * IRAM (instruction RAM) section of the microcontroller's memory, which allows for faster
- * execution.
+ * @return Time until a debounce window passes or the position must be updated, UINT32_MAX if the
+ * axis is idle.
  */
-void IRAM_ATTR Motor::_handlePosLimitReached()
+uint32_t Motor::nextUpdateUs(uint32_t nowUs) const
 {
-    _posLimitState = !gpio_get_level(_posLimitPin);
+    uint32_t next = min(_posLimit.debouncer.remainingUs(nowUs), _negLimit.debouncer.remainingUs(nowUs));
+    next = min(next, _center.debouncer.remainingUs(nowUs));
+
+    // Only a moving axis changes its estimate, an axis held against a limit waits for an edge or a new lever position
+    if (_position.enabled() && _commandedSpeed != 0)
+        next = min(next, (uint32_t)POSITION_UPDATE_PERIOD_US);
+    return next;
 }
 
 /**
- * @brief Handles the negative limit reached event.
+ * @brief Get the statistics of a limit switch. Safe to call from any task.
  *
- * This function is called when the negative limit is reached. It updates the `_negLimitState`
- * variable based on the level of the `_negLimitPin`.
+ * @return false if the axis has no such limit switch.
+ */
+bool Motor::limitSwitchStats(bool positive, LimitSwitchStats &stats) const
+{
+    const LimitSwitch &limit = positive ? _posLimit : _negLimit;
+    if (limit.pin == GPIO_NUM_NC)
+        return false;
+
+    stats = limit.stats.read();
+    return true;
+}
+
+/**
+ * @brief Capture the limit switch edge with its timestamp and wake the control task.
  *
  * @note This function is marked with the `IRAM_ATTR` attribute to ensure it is placed in the
  * IRAM (instruction RAM) section of the microcontroller's memory, which allows for faster
  * execution.
  */
-void IRAM_ATTR Motor::_handleNegLimitReached()
+void IRAM_ATTR Motor::_limitIsr(void *arg)
 {
-    _negLimitState = !gpio_get_level(_negLimitPin);
+    LimitSwitch *limit = static_cast<LimitSwitch *>(arg);
+    bool drained = limit->edges.empty();
+    limit->edges.push({(uint32_t)micros(), !gpio_get_level(limit->pin)});
+
+    // The control task takes all buffered edges, so only the first edge after that has to wake it
+    if (drained)
+        eventLoopNotifyFromIsr();
 }
 
 /**
@@ -125,22 +225,26 @@ void IRAM_ATTR Motor::_handleNegLimitReached()
  */
 void Motor::stop()
 {
+    _commandedSpeed = 0;
+    _requestedSpeed = 0;
     if (_breakMode)
     {
-        setMotorPwm(_posMotorPin, _negMotorPin, PWM_ON, PWM_ON);
+        _setOutputs(PWM_ON, PWM_ON);
     }
     else
     {
-        setMotorPwm(_posMotorPin, _negMotorPin, PWM_OFF, PWM_OFF);
+        _setOutputs(PWM_OFF, PWM_OFF);
     }
 }
 
 /**
- * @brief Stops the motor immediately (prior of other requests in a queue) with braking.
+ * @brief Stops the motor with braking regardless of the configured braking mode.
  */
 void Motor::stopImmediate()
 {
-    setMotorPwm(_posMotorPin, _negMotorPin, PWM_ON, PWM_ON, true);
+    _commandedSpeed = 0;
+    _requestedSpeed = 0;
+    _setOutputs(PWM_ON, PWM_ON);
 }
 
 /**
@@ -150,27 +254,58 @@ void Motor::stopImmediate()
  */
 void Motor::setSpeed(int16_t speed)
 {
+    // Apply the axis shaping
+    if (speed <= _deadband && speed >= -_deadband)
+    {
+        speed = 0;
+    }
+    else if (_maxSpeed != 255)
+    {
+        speed = (int32_t)speed * _maxSpeed / 255;
+    }
+
     if (_reverse)
     {
         speed = -speed;
     }
 
+    _requestedSpeed = speed;
+    _applySpeed(speed);
+}
+
+/**
+ * @brief Apply the shaped speed within the soft and the hard limits.
+ *
+ * @param speed The speed in the motor direction in the range of -255 to 255.
+ */
+void Motor::_applySpeed(int16_t speed)
+{
+    speed = _position.limit(speed);
+    bool standing = _commandedSpeed == 0;
+
     if (speed > 0)
     {
         if (!posLimitReached)
         {
-            setMotorPwm(_posMotorPin, _negMotorPin, speed, PWM_OFF);
+            _commandedSpeed = speed;
+            _setOutputs(speed, PWM_OFF);
         }
     }
     else if (speed < 0)
     {
         if (!negLimitReached)
         {
-            setMotorPwm(_posMotorPin, _negMotorPin, PWM_OFF, -speed);
+            _commandedSpeed = speed;
+            _setOutputs(PWM_OFF, -speed);
         }
     }
     else
     {
         stop();
     }
+
+    // Nothing was integrated since the last position update while the motor stood. The control task
+    // that applied the speed schedules the next update when it goes to sleep.
+    if (standing && _commandedSpeed != 0 && _position.enabled())
+        _lastPositionUs = micros();
 }
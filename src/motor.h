@@ -2,36 +2,88 @@
 #define MOTOR_H
 
 #include <Arduino.h>
+#include <seqlock.h>
+#include <spsc_ring.h>
+
+#include "limit_debouncer.h"
+#include "machine_config.h"
+#include "position_estimator.h"
+
+// LEDC parameters of the motors with MOTOR_OUTPUT_LEDC.
+// Channels 0-3 are used by the lights, every motor takes two channels starting from the first one.
+#define MOTOR_LEDC_FIRST_CHANNEL 4
+#define MOTOR_LEDC_CHANNELS      16
+#define MOTOR_LEDC_FREQUENCY     20000 // Above the audible range
+#define MOTOR_LEDC_RESOLUTION    10    // Same scale as the expander values, PWM_ON is the full duty
+
+// Limit switch edges buffered between two updates
+#define LIMIT_EDGE_BUFFER_SIZE 16
+
+// Position update period while the motor of an axis with an end of travel is running
+#define POSITION_UPDATE_PERIOD_US 10000
+
+// Edge captured by the limit switch interrupt
+struct LimitEdge
+{
+    uint32_t timeUs;
+    bool level; // true if the switch is pressed
+};
+
+// Limit switch with its edge buffer and debouncer
+struct LimitSwitch
+{
+    explicit LimitSwitch(gpio_num_t pin) : pin(pin) {}
+
+    gpio_num_t pin;
+    SpscRing<LimitEdge, LIMIT_EDGE_BUFFER_SIZE> edges; // Filled by the interrupt
+    LimitDebouncer debouncer;                          // Used only by the updating task
+    Seqlock<LimitSwitchStats> stats;                   // Published for the other tasks
+};
 
 class Motor
 {
 public:
-    Motor(uint8_t posMotorPin, uint8_t negMotorPin, bool breakMode = true, bool reverse = false);
-    void setupLimitSwitches(gpio_num_t posLimitPin, gpio_num_t negLimitPin, uint32_t debounceTime = 50);
+    Motor(const AxisConfig &config, uint8_t ledcChannel = 0);
+    void setupOutput(void);
+    void setupLimitSwitches(void);
     void updateLimitSwitches(bool stopOnLimit = true);
+    bool limitSwitchStats(bool positive, LimitSwitchStats &stats) const;
+    void updatePosition(void);
+    uint32_t nextUpdateUs(uint32_t nowUs) const;
+    const PositionEstimator &position(void) const { return _position; }
     void setSpeed(int16_t speed);
     void stop(void);
     void stopImmediate(void);
+    int16_t commandedSpeed(void) const { return _commandedSpeed; }
 
     // Limit switch flags
     bool posLimitReached, negLimitReached;
 
 private:
-    // Limit switch interrupt handlers
-    void _handlePosLimitReached();
-    void _handleNegLimitReached();
+    // Limit switch interrupt handler, the argument is the LimitSwitch
+    static void _limitIsr(void *arg);
+    static void _setupLimitSwitch(LimitSwitch &limit, bool &reached);
+    static bool _updateLimitSwitch(LimitSwitch &limit, bool &reached);
+    void _applySpeed(int16_t speed);
+    void _setOutputs(uint16_t posPinValue, uint16_t negPinValue);
 
     // Motor variables
+    MotorOutput _output;
     uint8_t _posMotorPin, _negMotorPin;
+    uint8_t _ledcChannel; // Channel of the positive pin, the negative pin uses the next one
     bool _breakMode;
     bool _reverse;
+    int16_t _deadband, _maxSpeed;
+    int16_t _commandedSpeed; // Last speed written to the output, 0 when stopped
+    int16_t _requestedSpeed; // Shaped speed requested by the operator, before the soft limits
 
     // Limit switch variables
-    gpio_num_t _posLimitPin, _negLimitPin;
-    bool _lastPosLimitState, _lastNegLimitState;
-    volatile bool _posLimitState, _negLimitState;
-    uint32_t _lastPosLimitTriggerTime, _lastNegLimitTriggerTime;
-    uint32_t _debounceTime;
+    LimitSwitch _posLimit, _negLimit, _center;
+    bool _centerReached;
+
+    // Dead reckoning of the axis position
+    PositionEstimator _position;
+    uint32_t _lastPositionUs;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+/**
+ * @file ota_state_machine.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "ota_state_machine.h"
+
+OtaStateMachine::OtaStateMachine()
+{
+    _state = OTA_IDLE;
+    _progress = 0;
+    _selfTestStartMs = 0;
+}
+
+/**
+ * @brief Start a new update.
+ * An update is not accepted while the running firmware is not confirmed by the self-test.
+ *
+ * @return true if the update may start and the actuators must be parked.
+ */
+bool OtaStateMachine::begin()
+{
+    if (_state != OTA_IDLE && _state != OTA_FAILED)
+        return false;
+
+    _state = OTA_RECEIVING;
+    _progress = 0;
+    return true;
+}
+
+/**
+ * @brief Update the progress of the image transfer.
+ *
+ * @param done Number of bytes written.
+ * @param total Total size of the image.
+ */
+void OtaStateMachine::progress(uint32_t done, uint32_t total)
+{
+    if (_state != OTA_RECEIVING || total == 0)
+        return;
+
+    _progress = (uint64_t)done * 100 / total;
+    if (_progress > 100)
+        _progress = 100;
+}
+
+/**
+ * @brief Finish the image transfer.
+ *
+ * @return true if the image must be verified now.
+ */
+bool OtaStateMachine::end()
+{
+    if (_state != OTA_RECEIVING)
+        return false;
+
+    _state = OTA_VERIFYING;
+    _progress = 100;
+    return true;
+}
+
+/**
+ * @brief Set the result of the image verification.
+ *
+ * @param valid true if the image hash matches.
+ */
+void OtaStateMachine::verified(bool valid)
+{
+    if (_state != OTA_VERIFYING)
+        return;
+
+    _state = valid ? OTA_REBOOTING : OTA_FAILED;
+}
+
+/**
+ * @brief Abort the update. The actuators are released.
+ */
+void OtaStateMachine::error()
+{
+    if (_state == OTA_RECEIVING || _state == OTA_VERIFYING)
+        _state = OTA_FAILED;
+}
+
+/**
+ * @brief Start the self-test of a new image that waits for confirmation.
+ *
+ * @param nowMs Current time in milliseconds.
+ */
+void OtaStateMachine::startSelfTest(uint32_t nowMs)
+{
+    _state = OTA_SELF_TEST;
+    _selfTestStartMs = nowMs;
+}
+
+/**
+ * @brief Evaluate the self-test. The test passes as soon as all checks are ok and fails
+ * if they are not ok within OTA_SELF_TEST_TIMEOUT_MS.
+ *
+ * @param nowMs Current time in milliseconds.
+ * @param expanderOk The PWM expander is reachable over I2C.
+ * @param espNowOk ESP-NOW is initialized.
+ * @return OTA_SELF_TEST while the test is running, OTA_IDLE if it passed or OTA_ROLLING_BACK if it failed.
+ */
+OtaState OtaStateMachine::selfTestTick(uint32_t nowMs, bool expanderOk, bool espNowOk)
+{
+    if (_state != OTA_SELF_TEST)
+        return _state;
+
+    if (expanderOk && espNowOk)
+        _state = OTA_IDLE;
+    else if (nowMs - _selfTestStartMs >= OTA_SELF_TEST_TIMEOUT_MS)
+        _state = OTA_ROLLING_BACK;
+
+    return _state;
+}
+
+/**
+ * @brief Check if the motors must be kept stopped.
+ *
+ * @return true while the image is being written, verified or the device is rebooting.
+ */
+bool OtaStateMachine::actuatorsParked() const
+{
+    return _state == OTA_RECEIVING || _state == OTA_VERIFYING || _state == OTA_REBOOTING ||
+           _state == OTA_ROLLING_BACK;
+}
+
+const char *otaStateToString(OtaState state)
+{
+    switch (state)
+    {
+        case OTA_IDLE:
+            return "idle";
+        case OTA_RECEIVING:
+            return "receiving";
+        case OTA_VERIFYING:
+            return "verifying";
+        case OTA_REBOOTING:
+            return "rebooting";
+        case OTA_FAILED:
+            return "failed";
+        case OTA_SELF_TEST:
+            return "self-test";
+        case OTA_ROLLING_BACK:
+            return "rolling back";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * @file ota_state_machine.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef OTA_STATE_MACHINE_H
+#define OTA_STATE_MACHINE_H
+
+#include <stdint.h>
+
+#define OTA_SELF_TEST_TIMEOUT_MS 10000 // New firmware must pass the self-test within this time
+
+enum OtaState : uint8_t
+{
+    OTA_IDLE,
+    OTA_RECEIVING,    // Image is being written, actuators are parked
+    OTA_VERIFYING,    // Image is written and its SHA-256 is being checked
+    OTA_REBOOTING,    // Image is valid, rebooting into it
+    OTA_FAILED,       // Update failed, the running firmware stays
+    OTA_SELF_TEST,    // Running a new image that is not confirmed yet
+    OTA_ROLLING_BACK  // Self-test failed, rebooting into the previous image
+};
+
+/**
+ * @brief State machine of the OTA update and of the post-update self-test.
+ *
+ * The machine only tracks the states, all the actions are performed by the caller.
+ */
+class OtaStateMachine
+{
+public:
+    OtaStateMachine();
+
+    bool begin();
+    void progress(uint32_t done, uint32_t total);
+    bool end();
+    void verified(bool valid);
+    void error();
+
+    void startSelfTest(uint32_t nowMs);
+    OtaState selfTestTick(uint32_t nowMs, bool expanderOk, bool espNowOk);
+
+    bool actuatorsParked() const;
+    OtaState state() const { return _state; }
+    uint8_t progressPercent() const { return _progress; }
+
+private:
+    OtaState _state;
+    uint8_t _progress;
+    uint32_t _selfTestStartMs;
+};
+
+const char *otaStateToString(OtaState state);
+
+#endif // OTA_STATE_MACHINE_H
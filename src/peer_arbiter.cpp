@@ -0,0 +1,153 @@
+/**
+ * @file peer_arbiter.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "peer_arbiter.h"
+#include <string.h>
+
+PeerArbiter::PeerArbiter()
+{
+    _count = 0;
+    _active = PEER_NONE;
+}
+
+/**
+ * @brief Register a peer or update the priority of an already registered one.
+ *
+ * @param mac The MAC address of the peer.
+ * @param priority The priority of the peer.
+ * @return Index of the peer in the table or -1 if the table is full.
+ */
+int PeerArbiter::addPeer(const uint8_t mac[PEER_MAC_LEN], uint8_t priority)
+{
+    int index = findPeer(mac);
+
+    if (index < 0)
+    {
+        if (_count >= PEER_MAX_COUNT)
+            return -1;
+
+        index = _count++;
+        memcpy(_peers[index].mac, mac, PEER_MAC_LEN);
+        _peers[index].lastSeenMs = 0;
+        _peers[index].lockedUntilMs = 0;
+        _peers[index].lockedOut = false;
+    }
+
+    _peers[index].priority = priority;
+    return index;
+}
+
+/**
+ * @brief Remove a peer from the table. The peer loses control if it was active.
+ *
+ * @param mac The MAC address of the peer.
+ * @return true if the peer was found and removed.
+ */
+bool PeerArbiter::removePeer(const uint8_t mac[PEER_MAC_LEN])
+{
+    int index = findPeer(mac);
+    if (index < 0)
+        return false;
+
+    // Keep the table packed
+    _count--;
+    if (index != _count)
+        _peers[index] = _peers[_count];
+
+    if (_active == index)
+        _active = PEER_NONE;
+    else if (_active == _count)
+        _active = index;
+
+    return true;
+}
+
+/**
+ * @brief Find a peer by its MAC address.
+ *
+ * @param mac The MAC address of the peer.
+ * @return Index of the peer in the table or -1 if not found.
+ */
+int PeerArbiter::findPeer(const uint8_t mac[PEER_MAC_LEN]) const
+{
+    for (uint8_t i = 0; i < _count; ++i)
+    {
+        if (memcmp(_peers[i].mac, mac, PEER_MAC_LEN) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Decide whether a frame from the given sender should be processed.
+ * @note This function only compares MAC addresses, so it is cheap enough to be called
+ * before any parsing of the frame.
+ *
+ * @param mac The MAC address of the sender.
+ * @param nowMs Current time in milliseconds.
+ * @return The arbitration result.
+ */
+PeerFrameResult PeerArbiter::onFrame(const uint8_t mac[PEER_MAC_LEN], uint32_t nowMs)
+{
+    int index = findPeer(mac);
+    if (index < 0)
+        return PEER_REJECTED_UNKNOWN;
+
+    Peer &sender = _peers[index];
+
+    if (_active == index)
+    {
+        sender.lastSeenMs = nowMs;
+        return PEER_ACCEPTED;
+    }
+
+    if (sender.lockedOut)
+    {
+        if ((int32_t)(sender.lockedUntilMs - nowMs) > 0)
+            return PEER_REJECTED_LOCKED_OUT;
+        sender.lockedOut = false;
+    }
+
+    if (_active == PEER_NONE || isActiveTimedOut(nowMs))
+    {
+        _handover(index, nowMs);
+        return PEER_ACCEPTED_HANDOVER;
+    }
+
+    if (sender.priority > _peers[_active].priority)
+    {
+        // Override: the previous peer can't take control back for a while
+        _peers[_active].lockedUntilMs = nowMs + PEER_LOCKOUT_MS;
+        _peers[_active].lockedOut = true;
+        _handover(index, nowMs);
+        return PEER_ACCEPTED_HANDOVER;
+    }
+
+    return PEER_REJECTED_LOWER_PRIORITY;
+}
+
+/**
+ * @brief Check if the active peer has been silent for too long.
+ *
+ * @param nowMs Current time in milliseconds.
+ * @return true if there is no active peer or it timed out.
+ */
+bool PeerArbiter::isActiveTimedOut(uint32_t nowMs) const
+{
+    if (_active == PEER_NONE)
+        return true;
+    return nowMs - _peers[_active].lastSeenMs > PEER_ACTIVE_TIMEOUT_MS;
+}
+
+void PeerArbiter::_handover(uint8_t index, uint32_t nowMs)
+{
+    _active = index;
+    _peers[index].lastSeenMs = nowMs;
+    _peers[index].lockedOut = false;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file peer_arbiter.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef PEER_ARBITER_H
+#define PEER_ARBITER_H
+
+#include <stdint.h>
+
+// Peer table parameters
+#define PEER_MAX_COUNT         4
+#define PEER_MAC_LEN           6
+#define PEER_ACTIVE_TIMEOUT_MS 1000 // Active peer loses control after this silence
+#define PEER_LOCKOUT_MS        3000 // Overridden peer can't take control back during this time
+#define PEER_NONE              0xFF
+
+// Peer priorities. Higher priority takes over control from a lower one.
+#define PEER_PRIORITY_OPERATOR   1
+#define PEER_PRIORITY_SUPERVISOR 2
+
+enum PeerFrameResult
+{
+    PEER_ACCEPTED,                // Frame is from the active peer
+    PEER_ACCEPTED_HANDOVER,       // Frame is from a peer that just took over control
+    PEER_REJECTED_UNKNOWN,        // Sender is not registered
+    PEER_REJECTED_LOWER_PRIORITY, // Another peer with the same or higher priority is in control
+    PEER_REJECTED_LOCKED_OUT      // Sender was overridden recently
+};
+
+struct Peer
+{
+    uint8_t mac[PEER_MAC_LEN];
+    uint8_t priority;
+    uint32_t lastSeenMs;
+    uint32_t lockedUntilMs;
+    bool lockedOut; // lockedUntilMs is valid
+};
+
+/**
+ * @brief Table of registered controllers that decides which one is in control.
+ *
+ * Only one peer controls the machine at a time. A peer with a higher priority takes over
+ * immediately and locks out the previous one. A silent active peer loses control after
+ * PEER_ACTIVE_TIMEOUT_MS and any registered peer may take it.
+ */
+class PeerArbiter
+{
+public:
+    PeerArbiter();
+
+    int addPeer(const uint8_t mac[PEER_MAC_LEN], uint8_t priority);
+    bool removePeer(const uint8_t mac[PEER_MAC_LEN]);
+    int findPeer(const uint8_t mac[PEER_MAC_LEN]) const;
+
+    PeerFrameResult onFrame(const uint8_t mac[PEER_MAC_LEN], uint32_t nowMs);
+    bool isActiveTimedOut(uint32_t nowMs) const;
+
+    uint8_t count() const { return _count; }
+    uint8_t activeIndex() const { return _active; }
+    const Peer &peer(uint8_t index) const { return _peers[index]; }
+
+private:
+    void _handover(uint8_t index, uint32_t nowMs);
+
+    Peer _peers[PEER_MAX_COUNT];
+    uint8_t _count;
+    uint8_t _active;
+};
+
+#endif // PEER_ARBITER_H
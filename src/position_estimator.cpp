@@ -0,0 +1,83 @@
+/**
+ * @file position_estimator.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "position_estimator.h"
+
+/**
+ * @brief Construct a new PositionEstimator object. The position starts in the center, uncalibrated.
+ *
+ * @param travelMs Time of the full travel at the maximum speed, 0 disables the estimator.
+ * @param slowZonePermille Part of the travel before an end in which the speed is reduced.
+ * @param posSwitch The positive end has a limit switch.
+ * @param negSwitch The negative end has a limit switch.
+ */
+PositionEstimator::PositionEstimator(uint32_t travelMs, uint16_t slowZonePermille, bool posSwitch, bool negSwitch)
+    : _travelMs(travelMs), _slowZone((int64_t)POSITION_FULL_TRAVEL * slowZonePermille / 1000),
+      _posSwitch(posSwitch), _negSwitch(negSwitch), _calibrated(false), _position(POSITION_CENTER)
+{
+}
+
+/**
+ * @brief Set the known position, e.g. when a switch fires.
+ */
+void PositionEstimator::calibrate(int32_t position)
+{
+    _position = position;
+    _calibrated = true;
+}
+
+/**
+ * @brief Integrate the speed the axis was moving with.
+ *
+ * @param speed Motor speed in the range of -255 to 255.
+ * @param elapsedUs Time the speed was applied.
+ */
+void PositionEstimator::update(int16_t speed, uint32_t elapsedUs)
+{
+    if (!enabled())
+        return;
+
+    int64_t delta = (int64_t)speed * elapsedUs * POSITION_FULL_TRAVEL / ((int64_t)POSITION_MAX_SPEED * _travelMs * 1000);
+    int64_t position = _position + delta;
+
+    // The axis can't move past its ends, an estimate beyond them would delay the stop on the way back
+    if (position < 0)
+        position = 0;
+    else if (position > POSITION_FULL_TRAVEL)
+        position = POSITION_FULL_TRAVEL;
+    _position = position;
+}
+
+/**
+ * @brief Reduce the speed towards an end of the travel.
+ *
+ * @param speed Requested speed in the range of -255 to 255.
+ * @return The allowed speed.
+ */
+int16_t PositionEstimator::limit(int16_t speed) const
+{
+    if (!enabled() || !_calibrated || speed == 0)
+        return speed;
+
+    int32_t distance = speed > 0 ? POSITION_FULL_TRAVEL - _position : _position;
+    if (distance > 0 && distance >= _slowZone)
+        return speed;
+
+    int16_t maxSpeed;
+    if (distance > 0)
+        maxSpeed = POSITION_CREEP_SPEED + (int64_t)(POSITION_MAX_SPEED - POSITION_CREEP_SPEED) * distance / _slowZone;
+    else
+        maxSpeed = (speed > 0 ? _posSwitch : _negSwitch) ? POSITION_CREEP_SPEED : 0;
+
+    if (speed > maxSpeed)
+        return maxSpeed;
+    if (speed < -maxSpeed)
+        return -maxSpeed;
+    return speed;
+}
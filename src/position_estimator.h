@@ -0,0 +1,54 @@
+/**
+ * @file position_estimator.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef POSITION_ESTIMATOR_H
+#define POSITION_ESTIMATOR_H
+
+#include <stdint.h>
+
+// Position units: 0 is the negative end of the travel, POSITION_FULL_TRAVEL the positive end
+#define POSITION_FULL_TRAVEL 1000000L
+#define POSITION_CENTER      (POSITION_FULL_TRAVEL / 2)
+#define POSITION_MAX_SPEED   255
+#define POSITION_CREEP_SPEED 96 // Speed at the end of the slow zone, high enough to move the axis
+
+/**
+ * @brief Estimates the axis position by dead reckoning and enforces the soft limits.
+ *
+ * The commanded speed is integrated over time, assuming the axis moves proportionally to the speed
+ * and takes travelMs for the full travel at the maximum speed. The estimate is recalibrated when
+ * a limit or center switch fires. Near an end of the travel the speed is reduced linearly down to
+ * POSITION_CREEP_SPEED. At an end with a limit switch the axis keeps creeping until the switch
+ * stops it and corrects the estimate; at an end without a switch it is stopped.
+ *
+ * The soft limits are enforced only after the first calibration: the position is unknown after
+ * the boot. The estimator has no hardware dependencies.
+ */
+class PositionEstimator
+{
+public:
+    PositionEstimator(uint32_t travelMs, uint16_t slowZonePermille, bool posSwitch, bool negSwitch);
+
+    void calibrate(int32_t position);
+    void update(int16_t speed, uint32_t elapsedUs);
+    int16_t limit(int16_t speed) const;
+
+    bool enabled() const { return _travelMs != 0; }
+    bool calibrated() const { return _calibrated; }
+    int32_t position() const { return _position; }
+
+private:
+    uint32_t _travelMs;  // Full travel at the maximum speed, 0 if the axis has no end of travel
+    int32_t _slowZone;   // Distance to an end in which the speed is reduced
+    bool _posSwitch, _negSwitch;
+    bool _calibrated;
+    int32_t _position;
+};
+
+#endif // POSITION_ESTIMATOR_H
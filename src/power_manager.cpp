@@ -8,11 +8,11 @@
  */
 
 #include "constants.h"
-#include <data_structures.h>
 #include "power_manager.h"
-
-// Interval between battery voltage readings
-#define READ_BATTERY_INTERVAL_MS 1000
+#include "heap_guard.h"
+#include "supervisor.h"
+#include "task_plan.h"
+#include "telemetry_manager.h"
 
 // Formula to calculate the battery voltage
 #define CALCULATE_BATT_MV(mv) ((mv) * 0.925 + 1056)
@@ -20,13 +20,6 @@
 // The number of readings to average
 #define NUM_READINGS 5
 
-// Task parameters
-#define POWER_MANAGER_TASK_FREQUENCY_HZ (50U)
-#define POWER_MANAGER_TASK_STACK_SIZE   (2 * 1024U)
-#define POWER_MANAGER_TASK_PRIORITY     (tskIDLE_PRIORITY + 1)
-
-extern excavator_data_struct dataToSend;
-
 uint32_t lastBatteryReadTime = 0;
 
 uint16_t getAveragedBattVoltage()
@@ -49,6 +42,10 @@ uint16_t getAveragedBattVoltage()
     return CALCULATE_BATT_MV(avgReadMv);
 }
 
+// Task memory is allocated statically
+StackType_t powerManagerTaskStack[TASK_PLAN[TASK_POWER_MANAGER].stackSize];
+StaticTask_t powerManagerTaskBuffer;
+
 /**
  * @brief Task function for managing the power of the machine.
  *
@@ -56,7 +53,7 @@ uint16_t getAveragedBattVoltage()
  */
 void powerManagerTask(void *pvParameters)
 {
-    const TickType_t xFrequency = pdMS_TO_TICKS(READ_BATTERY_INTERVAL_MS);
+    const TickType_t xFrequency = pdMS_TO_TICKS(TASK_PLAN[TASK_POWER_MANAGER].periodMs);
     TickType_t xLastWakeTime = xTaskGetTickCount();
 
     pinMode(BATTERY_VOLTAGE_PIN, INPUT);
@@ -68,7 +65,9 @@ void powerManagerTask(void *pvParameters)
     for (;;)
     {
         // Read the battery voltage
-        dataToSend.battery = getAveragedBattVoltage();
+        telemetrySet(TLM_BATTERY, getAveragedBattVoltage());
+
+        supervisorFeed();
 
         // Wait for the next cycle.
         xTaskDelayUntil(&xLastWakeTime, xFrequency);
@@ -82,13 +81,18 @@ void powerManagerTask(void *pvParameters)
  */
 void powerManagerTaskInit(void)
 {
-    if (pdPASS != xTaskCreate(powerManagerTask,
-                              "powerManagerTask",
-                              POWER_MANAGER_TASK_STACK_SIZE,
-                              NULL,
-                              POWER_MANAGER_TASK_PRIORITY,
-                              NULL))
+    TaskHandle_t task = xTaskCreateStaticPinnedToCore(powerManagerTask,
+                                                     TASK_PLAN[TASK_POWER_MANAGER].name,
+                                                     TASK_PLAN[TASK_POWER_MANAGER].stackSize,
+                                                     NULL,
+                                                     TASK_PLAN[TASK_POWER_MANAGER].priority,
+                                                     powerManagerTaskStack,
+                                                     &powerManagerTaskBuffer,
+                                                     TASK_PLAN[TASK_POWER_MANAGER].core);
+    if (task == NULL)
     {
         Serial.println("Failed to create powerManagerTask");
     }
+    taskPlanRegister(TASK_POWER_MANAGER, task);
+    heapGuardProtectTask(task);
 }
@@ -11,109 +11,572 @@
 #include <SPI.h>
 #include <Adafruit_PWMServoDriver.h>
 
+#include "constants.h"
+#include "heap_guard.h"
+#include "logger.h"
+#include "machine_config.h"
+#include "pwm_phase.h"
+#include "pwm_scheduler.h"
+#include "supervisor.h"
+#include "task_plan.h"
+#include <seqlock.h>
+
 #define MAX_PWM_VALUE       4095
-#define PWM_TASK_STACK_SIZE (2 * 1024U)
-#define PWM_TASK_PRIORITY   (tskIDLE_PRIORITY + 2)
-#define PWM_TASK_CORE       1 // Core 0 is used by the WiFi
-#define QUEUE_LENGTH        50
+#define PWM_FREQUENCY_HZ    1600
+#define PWM_BUS_COUNT       2
+#define PCA9685_I2C_ADDRESS 0x40
+
+// I2C recovery parameters
+#define PWM_I2C_TIMEOUT_MS      10   // Transaction timeout, bounds the time lost on a locked bus
+#define PWM_RECOVERY_ATTEMPTS   3    // Bus clears before the PWM output is declared faulty
+#define PWM_RECOVERY_RETRY_MS   1000 // Recovery retry interval while the output is faulty
+#define I2C_CLEAR_CLOCKS        9    // Clocks that release a slave holding SDA low
+#define I2C_CLEAR_HALF_PERIOD_US 5
+
+// Load currents for the phase plan and the current model
+#define PWM_MOTOR_CURRENT_MA 500 // Running current of one motor
+#define PWM_LIGHT_CURRENT_MA 20  // One light output
 
 /**
- * @brief Structure to hold PWM data. Values are in range 0-255
+ * @brief PCA9685 expander. Its pins are logical channels PWM_CHANNEL(index, pin).
  */
-struct PWMdata
+struct PwmExpander
 {
-    uint8_t pin1;
-    uint16_t value1;
-    uint8_t pin2;
-    uint16_t value2;
+    uint8_t address;
+    uint8_t bus; // 0 is Wire, 1 is Wire1
 };
 
-QueueHandle_t pwmDataQueue;
+// Expanders in the order of the logical channels. Add an entry here to extend the channel space.
+// The host tests build the controller with their own table.
+#ifndef PWM_EXPANDERS_TABLE
+#define PWM_EXPANDERS_TABLE {{PCA9685_I2C_ADDRESS, 0}}
+#endif
 
-Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver();
+constexpr PwmExpander PWM_EXPANDERS[] = PWM_EXPANDERS_TABLE;
 
-void pwmTask(void *pvParameters)
+#define PWM_EXPANDERS_COUNT (sizeof(PWM_EXPANDERS) / sizeof(PWM_EXPANDERS[0]))
+static_assert(PWM_EXPANDERS_COUNT <= PWM_MAX_EXPANDERS, "Too many PWM expanders");
+static_assert(PWM_CHANNEL(1, 0) == PWM_CHANNELS_PER_EXPANDER, "PWM_CHANNEL() does not match the scheduler");
+
+// Check if any expander is connected to the bus
+constexpr bool _busUsed(uint8_t bus)
+{
+    for (uint8_t i = 0; i < PWM_EXPANDERS_COUNT; i++)
+    {
+        if (PWM_EXPANDERS[i].bus == bus)
+            return true;
+    }
+    return false;
+}
+
+// Number of buses with expanders. Only these get a writer task, so only their stacks are allocated.
+constexpr uint8_t _usedBusCount()
+{
+    uint8_t count = 0;
+    for (uint8_t bus = 0; bus < PWM_BUS_COUNT; bus++)
+        count += _busUsed(bus);
+    return count;
+}
+
+#define PWM_USED_BUS_COUNT _usedBusCount()
+static_assert(PWM_USED_BUS_COUNT > 0, "No PWM expanders");
+
+/**
+ * @brief Writer task of one I2C bus. Buses are written in parallel.
+ */
+struct PwmBus
 {
-    PWMdata pwmData;
+    TwoWire *wire;
+    gpio_num_t sdaPin;
+    gpio_num_t sclPin;
+    volatile bool fault;   // Set when the recovery has failed
+    volatile bool written; // Set after all channels were written once
+    TaskHandle_t task;
+    uint32_t lastRetryMs;               // Last recovery attempt of the faulty bus
+    PwmBusStats stats;                  // Updated only by the bus task
+    Seqlock<PwmBusStats> statsSnapshot; // Published copy for the other tasks
+};
+
+PwmBus pwmBuses[PWM_BUS_COUNT] = {{&Wire, I2C0_SDA_PIN, I2C0_SCL_PIN}, {&Wire1, I2C1_SDA_PIN, I2C1_SCL_PIN}};
 
-    // Init PWM with maximum frequency
-    pwm.begin();
-    pwm.setPWMFreq(1600);
+// Writer task stacks, assigned to the used buses in the order of their indexes
+StaticTask_t pwmTaskBuffers[PWM_USED_BUS_COUNT];
+StackType_t pwmTaskStacks[PWM_USED_BUS_COUNT][TASK_PLAN[TASK_PWM].stackSize];
 
-    // Reset all PWM channels
-    for (uint8_t i = 0; i < 16; i++)
+// Latest channel values waiting to be written, shared by all buses
+PwmScheduler pwmScheduler;
+portMUX_TYPE pwmSchedulerMux = portMUX_INITIALIZER_UNLOCKED;
+
+Adafruit_PWMServoDriver pwmDrivers[PWM_EXPANDERS_COUNT];
+
+// Loads of the expander channels, the motor inputs and the lights
+PwmLoad pwmLoads[AXIS_COUNT * 2 + 4];
+size_t pwmLoadsCount = 0;
+
+// Set when the expander acknowledged its address after initialization
+volatile bool expanderReady[PWM_EXPANDERS_COUNT] = {};
+
+pwm_fault_cb_t pwmFaultCallback = NULL;
+// Output state last reported to the callback, the outputs start disabled
+bool pwmOutputsEnabled = false;
+portMUX_TYPE pwmOutputsMux = portMUX_INITIALIZER_UNLOCKED;
+volatile uint32_t pwmI2cErrors = 0;
+volatile uint32_t pwmRecoveries = 0;
+
+/**
+ * @brief Write the changed channels of the expander, one transaction per run of adjacent channels.
+ *
+ * @return false if a transaction has failed. The scheduler still holds the commanded values,
+ * they are restored after the recovery.
+ */
+bool _flushExpander(uint8_t expander)
+{
+    uint16_t values[PWM_CHANNELS_PER_EXPANDER];
+    uint8_t buffer[PWM_BURST_BUFFER_SIZE];
+
+    portENTER_CRITICAL(&pwmSchedulerMux);
+    uint16_t mask = pwmScheduler.take(expander, values);
+    portEXIT_CRITICAL(&pwmSchedulerMux);
+
+    TwoWire *wire = pwmBuses[PWM_EXPANDERS[expander].bus].wire;
+    uint8_t first = 0;
+    uint8_t count;
+    while (PwmScheduler::nextRun(mask, &first, &count))
     {
-        pwm.setPWM(i, 0, 0);
+        size_t len = PwmScheduler::encodeRun(values, pwmScheduler.phases(expander), first, count, buffer);
+        wire->beginTransmission(PWM_EXPANDERS[expander].address);
+        wire->write(buffer, len);
+        if (wire->endTransmission() != 0)
+        {
+            pwmI2cErrors = pwmI2cErrors + 1;
+            return false;
+        }
+        first += count;
     }
+    return true;
+}
 
-    for (;;)
+/**
+ * @brief Write one frame: the changed channels of all expanders of the bus.
+ *
+ * @return false if a transaction has failed.
+ */
+bool _flushBus(uint8_t busIndex)
+{
+    bool ok = true;
+    for (uint8_t i = 0; i < PWM_EXPANDERS_COUNT; i++)
     {
-        if (xQueueReceive(pwmDataQueue, &pwmData, portMAX_DELAY) == pdTRUE)
+        if (PWM_EXPANDERS[i].bus == busIndex)
+            ok &= _flushExpander(i);
+    }
+    return ok;
+}
+
+/**
+ * @brief Initialize the expanders of the bus and schedule all their channels to be written.
+ *
+ * @return true if all expanders acknowledged their address.
+ */
+bool _initExpanders(uint8_t busIndex)
+{
+    TwoWire *wire = pwmBuses[busIndex].wire;
+    bool ready = true;
+
+    for (uint8_t i = 0; i < PWM_EXPANDERS_COUNT; i++)
+    {
+        if (PWM_EXPANDERS[i].bus != busIndex)
+            continue;
+
+        // Init PWM with maximum frequency, the register auto-increment is enabled here too
+        pwmDrivers[i].begin();
+        pwmDrivers[i].setPWMFreq(PWM_FREQUENCY_HZ);
+
+        // Check that the expander responds
+        wire->beginTransmission(PWM_EXPANDERS[i].address);
+        expanderReady[i] = wire->endTransmission() == 0;
+        if (!expanderReady[i])
         {
-            if (pwmData.pin1 != PWM_NC_PIN)
-            {
-                uint16_t pwmValue = map(pwmData.value1, 0, PWM_ON, 0, MAX_PWM_VALUE);
-                pwm.setPWM(pwmData.pin1, 0, pwmValue);
-            }
-            if (pwmData.pin2 != PWM_NC_PIN)
-            {
-                uint16_t pwmValue = map(pwmData.value2, 0, PWM_ON, 0, MAX_PWM_VALUE);
-                pwm.setPWM(pwmData.pin2, 0, pwmValue);
-            }
+            logPrintf("PWM expander 0x%02X is not responding\n", PWM_EXPANDERS[i].address);
+            ready = false;
         }
+
+        // Write all channels from the shadow copy with the next flush
+        portENTER_CRITICAL(&pwmSchedulerMux);
+        pwmScheduler.invalidate(i);
+        portEXIT_CRITICAL(&pwmSchedulerMux);
     }
+    return ready;
 }
 
-void pwmTaskInit(void)
+/**
+ * @brief Release a locked bus: clock out the byte a slave may be holding SDA low in,
+ * then generate a STOP condition and restart the I2C driver.
+ */
+void _clearBus(PwmBus *bus)
 {
-    // Create Queues
-    pwmDataQueue = xQueueCreate(QUEUE_LENGTH, sizeof(PWMdata));
-    configASSERT(pwmDataQueue);
+    bus->wire->end();
+
+    pinMode(bus->sdaPin, INPUT_PULLUP);
+    pinMode(bus->sclPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(bus->sclPin, HIGH);
+
+    for (uint8_t i = 0; i < I2C_CLEAR_CLOCKS && !digitalRead(bus->sdaPin); i++)
+    {
+        digitalWrite(bus->sclPin, LOW);
+        delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+        digitalWrite(bus->sclPin, HIGH);
+        delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+    }
+
+    // STOP: SDA goes high while SCL is high
+    pinMode(bus->sdaPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(bus->sdaPin, LOW);
+    delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+    digitalWrite(bus->sclPin, HIGH);
+    delayMicroseconds(I2C_CLEAR_HALF_PERIOD_US);
+    digitalWrite(bus->sdaPin, HIGH);
 
-    if (pdPASS != xTaskCreatePinnedToCore(pwmTask,
-                                          "pwmTask",
-                                          PWM_TASK_STACK_SIZE,
-                                          NULL,
-                                          PWM_TASK_PRIORITY,
-                                          NULL,
-                                          PWM_TASK_CORE))
+    bus->wire->begin(bus->sdaPin, bus->sclPin);
+    bus->wire->setTimeOut(PWM_I2C_TIMEOUT_MS);
+}
+
+/**
+ * @brief Clear the bus and re-initialize its expanders.
+ *
+ * @param attempts Number of attempts.
+ * @return true if all expanders of the bus respond again.
+ */
+bool _recoverBus(PwmBus *bus, uint8_t busIndex, uint8_t attempts)
+{
+    bool recovered = false;
+
+    // The expander driver allocates its I2C device on every initialization
+    heapGuardExemptBegin();
+    for (uint8_t attempt = 0; attempt < attempts && !recovered; attempt++)
+    {
+        pwmRecoveries = pwmRecoveries + 1;
+        _clearBus(bus);
+        recovered = _initExpanders(busIndex);
+    }
+    heapGuardExemptEnd();
+
+    return recovered;
+}
+
+/**
+ * @brief Report a change of the output state to the callback. The outputs are enabled when every used bus
+ * has written all channels once and has no fault, so the motor drivers are not woken with the outputs
+ * the expanders kept over a reset.
+ */
+void _updateOutputs()
+{
+    bool enabled = true;
+    for (uint8_t i = 0; i < PWM_BUS_COUNT; i++)
     {
-        Serial.println("Failed to create pwmTask");
+        if (_busUsed(i) && (!pwmBuses[i].written || pwmBuses[i].fault))
+            enabled = false;
     }
+
+    portENTER_CRITICAL(&pwmOutputsMux);
+    bool changed = enabled != pwmOutputsEnabled;
+    pwmOutputsEnabled = enabled;
+    portEXIT_CRITICAL(&pwmOutputsMux);
+
+    if (changed && pwmFaultCallback)
+        pwmFaultCallback(!enabled);
+}
+
+void _setBusFault(PwmBus *bus, bool fault)
+{
+    if (bus->fault == fault)
+        return;
+    bus->fault = fault;
+
+    if (fault)
+        logPrintf("PWM output of bus %d failed, all motors stopped\n", (int)(bus - pwmBuses));
+    else
+        logPrintf("PWM output of bus %d recovered\n", (int)(bus - pwmBuses));
+
+    _updateOutputs();
+}
+
+/**
+ * @brief Start the I2C driver and initialize the expanders of the bus. All channels are reset with the first frame.
+ */
+void _startBus(PwmBus *bus)
+{
+    uint8_t busIndex = bus - pwmBuses;
+
+    bus->wire->begin(bus->sdaPin, bus->sclPin);
+    bus->wire->setTimeOut(PWM_I2C_TIMEOUT_MS);
+
+    if (!_initExpanders(busIndex) && !_recoverBus(bus, busIndex, PWM_RECOVERY_ATTEMPTS))
+        _setBusFault(bus, true);
+    bus->lastRetryMs = millis();
+}
+
+/**
+ * @brief One cycle of the writer task: retry the recovery of a faulty bus, then write the pending frame.
+ *
+ * @param pending true if a channel of the bus has changed since the last frame.
+ */
+void _serviceBus(PwmBus *bus, bool pending)
+{
+    uint8_t busIndex = bus - pwmBuses;
+
+    // The commanded values are kept, the output is restored as soon as the expanders respond
+    if (bus->fault && millis() - bus->lastRetryMs >= PWM_RECOVERY_RETRY_MS)
+    {
+        bus->lastRetryMs = millis();
+        if (_recoverBus(bus, busIndex, 1))
+        {
+            _setBusFault(bus, false);
+            pending = true;
+        }
+    }
+
+    if (bus->fault || !pending)
+        return;
+
+    uint32_t start = micros();
+
+    if (!_flushBus(busIndex))
+    {
+        if (_recoverBus(bus, busIndex, PWM_RECOVERY_ATTEMPTS))
+            xTaskNotifyGive(xTaskGetCurrentTaskHandle()); // Restore the channels in the next frame
+        else
+            _setBusFault(bus, true);
+    }
+    else if (!bus->written)
+    {
+        bus->written = true;
+        _updateOutputs();
+    }
+
+    uint32_t duration = micros() - start;
+    bus->stats.lastFrameUs = duration;
+    if (duration > bus->stats.maxFrameUs)
+        bus->stats.maxFrameUs = duration;
+    bus->stats.frames++;
+    bus->statsSnapshot.write(bus->stats);
+}
+
+void pwmTask(void *pvParameters)
+{
+    PwmBus *bus = static_cast<PwmBus *>(pvParameters);
+    bool pending = true;
+
+    _startBus(bus);
+
+    for (;;)
+    {
+        supervisorFeed();
+        _serviceBus(bus, pending);
+
+        // Wait until any channel of this bus changes, but not longer than the supervisor allows
+        pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SUPERVISOR_FEED_INTERVAL_MS)) > 0;
+    }
+}
+
+void _addLoad(uint8_t channel, uint8_t group, uint16_t currentMa)
+{
+    if (channel != PWM_NC_PIN && pwmLoadsCount < sizeof(pwmLoads) / sizeof(pwmLoads[0]))
+        pwmLoads[pwmLoadsCount++] = {channel, group, currentMa};
+}
+
+/**
+ * @brief Stagger the ON counts of the channels, so the loads do not all switch on together.
+ */
+void _planPhases()
+{
+    for (uint8_t i = 0; i < AXIS_COUNT; i++)
+    {
+        if (MACHINE_AXES[i].output != MOTOR_OUTPUT_EXPANDER)
+            continue;
+
+        // Only one input of a motor is modulated at a time
+        _addLoad(MACHINE_AXES[i].posMotorPin, i, PWM_MOTOR_CURRENT_MA);
+        _addLoad(MACHINE_AXES[i].negMotorPin, i, PWM_MOTOR_CURRENT_MA);
+    }
+
+    const uint8_t lightPins[] = {LEFT_HEADLIGHT_PIN, RIGHT_HEADLIGHT_PIN, ROOF_BACK_LIGHTS_PIN, ROOF_FRONT_LIGHTS_PIN};
+    for (uint8_t i = 0; i < sizeof(lightPins); i++)
+        _addLoad(lightPins[i], AXIS_COUNT + i, PWM_LIGHT_CURRENT_MA);
+
+    for (uint8_t i = 0; i < PWM_EXPANDERS_COUNT; i++)
+    {
+        uint16_t phases[PWM_CHANNELS_PER_EXPANDER];
+        pwmPlanPhases(pwmLoads, pwmLoadsCount, i, phases);
+
+        portENTER_CRITICAL(&pwmSchedulerMux);
+        pwmScheduler.setPhases(i, phases);
+        portEXIT_CRITICAL(&pwmSchedulerMux);
+    }
+}
+
+/**
+ * @brief Initializes the PWM writer tasks, one per used I2C bus.
+ *
+ * @param faultCallback Function called when the PWM output fails or recovers. It must stop all motors
+ * by other means, the expander outputs can't be changed while the bus is faulty. It is first called with
+ * false once all channels were written after the boot, the motor drivers must be kept asleep until then.
+ *
+ * @note This function should be called once during the setup phase of the program.
+ */
+void pwmTaskInit(pwm_fault_cb_t faultCallback)
+{
+    pwmFaultCallback = faultCallback;
+    _planPhases();
+
+    for (uint8_t i = 0; i < PWM_EXPANDERS_COUNT; i++)
+        pwmDrivers[i] = Adafruit_PWMServoDriver(PWM_EXPANDERS[i].address, *pwmBuses[PWM_EXPANDERS[i].bus].wire);
+
+    uint8_t slot = 0;
+    for (uint8_t i = 0; i < PWM_BUS_COUNT; i++)
+    {
+        PwmBus &bus = pwmBuses[i];
+
+        if (!_busUsed(i))
+            continue;
+
+        bus.task = xTaskCreateStaticPinnedToCore(pwmTask,
+                                                 i == 0 ? "pwmTask" : "pwmTask1",
+                                                 TASK_PLAN[TASK_PWM].stackSize,
+                                                 &bus,
+                                                 TASK_PLAN[TASK_PWM].priority,
+                                                 pwmTaskStacks[slot],
+                                                 &pwmTaskBuffers[slot],
+                                                 TASK_PLAN[TASK_PWM].core);
+        slot++;
+        if (bus.task == NULL)
+        {
+            Serial.println("Failed to create pwmTask");
+        }
+        taskPlanRegister(TASK_PWM, bus.task);
+        heapGuardProtectTask(bus.task);
+    }
+}
+
+/**
+ * @brief Store the channel value and wake up the writer task of its bus.
+ * @return false if the channel does not exist.
+ */
+bool _setChannel(uint8_t channel, uint16_t value)
+{
+    if (channel == PWM_NC_PIN)
+        return true;
+
+    uint8_t expander = channel / PWM_CHANNELS_PER_EXPANDER;
+    if (expander >= PWM_EXPANDERS_COUNT)
+        return false;
+
+    uint16_t pwmValue = map(value, 0, PWM_ON, 0, MAX_PWM_VALUE);
+
+    portENTER_CRITICAL(&pwmSchedulerMux);
+    bool changed = pwmScheduler.set(channel, pwmValue);
+    portEXIT_CRITICAL(&pwmSchedulerMux);
+
+    TaskHandle_t task = pwmBuses[PWM_EXPANDERS[expander].bus].task;
+    if (changed && task != NULL)
+        xTaskNotifyGive(task);
+    return true;
 }
 
 void setPinPWM(uint8_t pin, uint16_t value)
 {
-    PWMdata pwm;
-    pwm.pin1 = pin;
-    pwm.value1 = value;
-    pwm.pin2 = PWM_NC_PIN;
-    pwm.value2 = 0;
+    if (!_setChannel(pin, value))
+    {
+        logPrintf("PWM channel %d does not exist\n", pin);
+    }
+}
+
+/**
+ * @brief Set both motor terminals. The values are written together in the next bus frame.
+ * Pending values are always replaced by the newest ones, so a stop never waits behind older updates.
+ */
+void setMotorPwm(uint8_t posMotorPin, uint8_t negMotorPin, uint16_t posPinValue, uint16_t negPinValue)
+{
+    if (!_setChannel(posMotorPin, posPinValue) || !_setChannel(negMotorPin, negPinValue))
+    {
+        logPrintf("PWM channel %d or %d does not exist\n", posMotorPin, negMotorPin);
+    }
+}
 
-    // Send data to pwmTask
-    if (xQueueSend(pwmDataQueue, &pwm, 0) != pdTRUE)
+// Check that all expanders acknowledged their address after initialization
+bool pwmIsExpanderReady(void)
+{
+    for (uint8_t i = 0; i < PWM_EXPANDERS_COUNT; i++)
     {
-        Serial.println("Failed to send data to pwmDataQueue");
+        if (!expanderReady[i])
+            return false;
     }
+    return true;
 }
 
-void setMotorPwm(uint8_t posMotorPin, uint8_t negMotorPin, uint16_t posPinValue, uint16_t negPinValue, bool immediate)
+/**
+ * @brief Get the write statistics of the I2C bus.
+ *
+ * @param bus Bus index.
+ * @return Time spent writing one frame of changed channels.
+ */
+PwmBusStats pwmGetBusStats(uint8_t bus)
 {
-    PWMdata pwm;
-    pwm.pin1 = posMotorPin;
-    pwm.value1 = posPinValue;
-    pwm.pin2 = negMotorPin;
-    pwm.value2 = negPinValue;
+    return bus < PWM_BUS_COUNT ? pwmBuses[bus].statsSnapshot.read() : PwmBusStats{};
+}
 
-    if (immediate)
+// Check if the PWM output of any bus has failed and could not be recovered
+bool pwmHasFault(void)
+{
+    for (uint8_t i = 0; i < PWM_BUS_COUNT; i++)
     {
-        // Remove any pending low priority messages
-        xQueueReset(pwmDataQueue);
+        if (pwmBuses[i].fault)
+            return true;
     }
+    return false;
+}
 
-    // Send data to pwmTask
-    if (xQueueSend(pwmDataQueue, &pwm, 0) != pdTRUE)
+/**
+ * @brief Get the I2C error counters of all buses.
+ */
+PwmHealth pwmGetHealth(void)
+{
+    return PwmHealth{pwmI2cErrors, pwmRecoveries, pwmHasFault()};
+}
+
+/**
+ * @brief Print the ON counts of the loaded channels and the modeled peak current of every expander,
+ * with the current outputs and with all loads at half duty, staggered and aligned at count 0.
+ */
+void pwmPrintPhasePlan(void)
+{
+    const uint16_t aligned[PWM_CHANNELS_PER_EXPANDER] = {0};
+    uint16_t halfDuty[PWM_CHANNELS_PER_EXPANDER];
+    for (uint8_t pin = 0; pin < PWM_CHANNELS_PER_EXPANDER; pin++)
+        halfDuty[pin] = PWM_PERIOD_COUNTS / 2;
+
+    for (uint8_t i = 0; i < PWM_EXPANDERS_COUNT; i++)
     {
-        Serial.println("Failed to send data to pwmDataQueue");
+        uint16_t values[PWM_CHANNELS_PER_EXPANDER];
+        portENTER_CRITICAL(&pwmSchedulerMux);
+        pwmScheduler.values(i, values);
+        portEXIT_CRITICAL(&pwmSchedulerMux);
+        const uint16_t *phases = pwmScheduler.phases(i);
+
+        logPrintf("Expander 0x%02X at %d Hz, peak current now %lu mA (aligned %lu mA), at half duty %lu mA "
+                  "(aligned %lu mA)\n",
+                  PWM_EXPANDERS[i].address, PWM_FREQUENCY_HZ,
+                  (unsigned long)pwmPeakCurrentMa(pwmLoads, pwmLoadsCount, i, phases, values),
+                  (unsigned long)pwmPeakCurrentMa(pwmLoads, pwmLoadsCount, i, aligned, values),
+                  (unsigned long)pwmPeakCurrentMa(pwmLoads, pwmLoadsCount, i, phases, halfDuty),
+                  (unsigned long)pwmPeakCurrentMa(pwmLoads, pwmLoadsCount, i, aligned, halfDuty));
+
+        for (size_t j = 0; j < pwmLoadsCount; j++)
+        {
+            if (pwmLoads[j].channel / PWM_CHANNELS_PER_EXPANDER != i)
+                continue;
+            uint8_t pin = pwmLoads[j].channel % PWM_CHANNELS_PER_EXPANDER;
+            logPrintf("  pin %2d: ON at %4u, value %4u, %u mA\n", pin, phases[pin], values[pin],
+                      pwmLoads[j].currentMa);
+        }
     }
-}
\ No newline at end of file
+}
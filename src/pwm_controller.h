@@ -16,9 +16,39 @@
 #define PWM_ON     1023
 #define PWM_NC_PIN 255
 
-void pwmTaskInit(void);
+// Logical channel of the expander pin. Pins of the first expander keep their numbers.
+#define PWM_CHANNEL(expander, pin) ((expander) * 16 + (pin))
+
+/**
+ * @brief Write statistics of one I2C bus.
+ */
+struct PwmBusStats
+{
+    uint32_t lastFrameUs; // Duration of the last frame of changed channels
+    uint32_t maxFrameUs;  // Longest frame since boot
+    uint32_t frames;
+};
+
+/**
+ * @brief I2C health of the PWM output.
+ */
+struct PwmHealth
+{
+    uint32_t i2cErrors;  // Failed I2C transactions
+    uint32_t recoveries; // Bus clears with expander re-initialization
+    bool fault;          // Recovery has failed, the expander outputs are not updated
+};
+
+// Called when the PWM output fails or recovers, and once the outputs are written after the boot
+typedef void (*pwm_fault_cb_t)(bool fault);
+
+void pwmTaskInit(pwm_fault_cb_t faultCallback);
 void setPinPWM(uint8_t pin, uint16_t value);
-void setMotorPwm(uint8_t posMotorPin, uint8_t negMotorPin, uint16_t posPinValue,
-                 uint16_t negPinValue, bool immediate = false);
+void setMotorPwm(uint8_t posMotorPin, uint8_t negMotorPin, uint16_t posPinValue, uint16_t negPinValue);
+bool pwmIsExpanderReady(void);
+PwmBusStats pwmGetBusStats(uint8_t bus);
+bool pwmHasFault(void);
+PwmHealth pwmGetHealth(void);
+void pwmPrintPhasePlan(void);
 
 #endif // PWM_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+/**
+ * @file pwm_phase.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "pwm_phase.h"
+#include <string.h>
+
+// Position of the k-th point of the van der Corput sequence in the period
+uint16_t _vanDerCorput(uint16_t k)
+{
+    uint16_t counts = 0;
+    for (uint16_t bit = PWM_PERIOD_COUNTS / 2; k && bit; bit >>= 1, k >>= 1)
+    {
+        if (k & 1)
+            counts |= bit;
+    }
+    return counts;
+}
+
+/**
+ * @brief Plan the ON counts of the channels of one expander.
+ *
+ * @param loads Loads of all expanders.
+ * @param count Number of loads.
+ * @param expander Expander to plan.
+ * @param phases Output: ON count of every pin, 0 for the pins without a load.
+ */
+void pwmPlanPhases(const PwmLoad *loads, size_t count, uint8_t expander, uint16_t phases[PWM_CHANNELS_PER_EXPANDER])
+{
+    memset(phases, 0, PWM_CHANNELS_PER_EXPANDER * sizeof(phases[0]));
+
+    // Groups of the expander with their largest current
+    uint8_t groups[PWM_CHANNELS_PER_EXPANDER];
+    uint16_t currents[PWM_CHANNELS_PER_EXPANDER];
+    uint8_t groupsCount = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (loads[i].channel / PWM_CHANNELS_PER_EXPANDER != expander)
+            continue;
+
+        uint8_t g = 0;
+        while (g < groupsCount && groups[g] != loads[i].group)
+            g++;
+        if (g == groupsCount)
+        {
+            groups[groupsCount] = loads[i].group;
+            currents[groupsCount++] = loads[i].currentMa;
+        }
+        else if (loads[i].currentMa > currents[g])
+        {
+            currents[g] = loads[i].currentMa;
+        }
+    }
+
+    // Heaviest groups first, equal ones keep their order
+    for (uint8_t i = 1; i < groupsCount; i++)
+    {
+        for (uint8_t j = i; j > 0 && currents[j] > currents[j - 1]; j--)
+        {
+            uint8_t group = groups[j];
+            uint16_t current = currents[j];
+            groups[j] = groups[j - 1];
+            currents[j] = currents[j - 1];
+            groups[j - 1] = group;
+            currents[j - 1] = current;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (loads[i].channel / PWM_CHANNELS_PER_EXPANDER != expander)
+            continue;
+
+        uint8_t g = 0;
+        while (groups[g] != loads[i].group)
+            g++;
+        phases[loads[i].channel % PWM_CHANNELS_PER_EXPANDER] = _vanDerCorput(g);
+    }
+}
+
+// Check if the pin is on at the count of the period
+bool _isOn(uint16_t phase, uint16_t value, uint16_t counts)
+{
+    if (value == 0)
+        return false;
+    if (value >= PWM_PERIOD_COUNTS - 1)
+        return true;
+    return (uint16_t)(counts - phase) % PWM_PERIOD_COUNTS < value;
+}
+
+/**
+ * @brief Model the highest total current of the loads of one expander within a PWM period.
+ * The current is highest right after a channel turns on, so only the ON counts are checked.
+ *
+ * @param values Raw PCA9685 values of the pins, see PwmScheduler::set().
+ * @return Peak current in mA.
+ */
+uint32_t pwmPeakCurrentMa(const PwmLoad *loads, size_t count, uint8_t expander,
+                          const uint16_t phases[PWM_CHANNELS_PER_EXPANDER],
+                          const uint16_t values[PWM_CHANNELS_PER_EXPANDER])
+{
+    uint32_t peak = 0;
+
+    for (size_t i = 0; i <= count; i++)
+    {
+        // Count 0 covers the loads that are fully on
+        uint16_t counts = 0;
+        if (i < count)
+        {
+            if (loads[i].channel / PWM_CHANNELS_PER_EXPANDER != expander)
+                continue;
+            counts = phases[loads[i].channel % PWM_CHANNELS_PER_EXPANDER];
+        }
+
+        uint32_t total = 0;
+        for (size_t j = 0; j < count; j++)
+        {
+            uint8_t pin = loads[j].channel % PWM_CHANNELS_PER_EXPANDER;
+            if (loads[j].channel / PWM_CHANNELS_PER_EXPANDER == expander && _isOn(phases[pin], values[pin], counts))
+                total += loads[j].currentMa;
+        }
+        if (total > peak)
+            peak = total;
+    }
+    return peak;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file pwm_phase.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef PWM_PHASE_H
+#define PWM_PHASE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pwm_scheduler.h"
+
+// PCA9685 counts per PWM period
+#define PWM_PERIOD_COUNTS 4096
+
+// Electrical load on a PWM channel
+struct PwmLoad
+{
+    uint8_t channel;    // Logical channel, see PWM_CHANNEL()
+    uint8_t group;      // Channels of a group never switch together, e.g. the two inputs of one motor
+    uint16_t currentMa; // Current while the channel is on
+};
+
+/*
+ * The PCA9685 turns every channel on at its LEDn_ON count. With all channels on at 0 the loads start
+ * together and their inrush currents add up. The phase plan spreads the ON counts of the groups over
+ * the period: the groups are ordered by their current and placed on the van der Corput sequence
+ * (0, 1/2, 1/4, 3/4, ...), so the heaviest loads are the furthest apart. The expanders run from
+ * their own oscillators, so every expander is planned on its own.
+ */
+void pwmPlanPhases(const PwmLoad *loads, size_t count, uint8_t expander, uint16_t phases[PWM_CHANNELS_PER_EXPANDER]);
+
+uint32_t pwmPeakCurrentMa(const PwmLoad *loads, size_t count, uint8_t expander,
+                          const uint16_t phases[PWM_CHANNELS_PER_EXPANDER],
+                          const uint16_t values[PWM_CHANNELS_PER_EXPANDER]);
+
+#endif // PWM_PHASE_H
@@ -0,0 +1,159 @@
+/**
+ * @file pwm_scheduler.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "pwm_scheduler.h"
+#include <string.h>
+
+PwmScheduler::PwmScheduler()
+{
+    memset(_values, 0, sizeof(_values));
+    memset(_phases, 0, sizeof(_phases));
+    memset(_dirty, 0, sizeof(_dirty));
+}
+
+/**
+ * @brief Set the value of a logical channel. The value is written on the next flush of its expander.
+ *
+ * @param channel Logical channel, see PWM_CHANNEL().
+ * @param value Raw PCA9685 value in the range of 0 to 4095.
+ * @return true if the value has changed and the expander must be flushed.
+ */
+bool PwmScheduler::set(uint8_t channel, uint16_t value)
+{
+    if (channel >= PWM_MAX_CHANNELS)
+        return false;
+
+    uint8_t expander = channel / PWM_CHANNELS_PER_EXPANDER;
+    uint8_t pin = channel % PWM_CHANNELS_PER_EXPANDER;
+
+    if (_values[expander][pin] == value)
+        return false;
+
+    _values[expander][pin] = value;
+    _dirty[expander] |= 1U << pin;
+    return true;
+}
+
+/**
+ * @brief Set the ON counts of the expander pins. All channels are written with the next flush.
+ *
+ * @param phases ON count of every pin in the range of 0 to 4095, see pwmPlanPhases().
+ */
+void PwmScheduler::setPhases(uint8_t expander, const uint16_t phases[PWM_CHANNELS_PER_EXPANDER])
+{
+    if (expander >= PWM_MAX_EXPANDERS)
+        return;
+
+    for (uint8_t pin = 0; pin < PWM_CHANNELS_PER_EXPANDER; pin++)
+        _phases[expander][pin] = phases[pin] & 0xFFF;
+    _dirty[expander] = 0xFFFF;
+}
+
+/**
+ * @brief Mark all channels of the expander as changed, e.g. after it was reset.
+ */
+void PwmScheduler::invalidate(uint8_t expander)
+{
+    if (expander < PWM_MAX_EXPANDERS)
+        _dirty[expander] = 0xFFFF;
+}
+
+/**
+ * @brief Take the changed channels of the expander.
+ *
+ * @param expander Expander index.
+ * @param values Output: copy of all channel values of the expander.
+ * @return Bitmask of the changed channels. The mask is cleared.
+ */
+uint16_t PwmScheduler::take(uint8_t expander, uint16_t values[PWM_CHANNELS_PER_EXPANDER])
+{
+    if (expander >= PWM_MAX_EXPANDERS)
+        return 0;
+
+    uint16_t mask = _dirty[expander];
+    if (mask)
+    {
+        memcpy(values, _values[expander], sizeof(_values[expander]));
+        _dirty[expander] = 0;
+    }
+    return mask;
+}
+
+/**
+ * @brief Copy the current values of the expander channels without taking the changes.
+ */
+void PwmScheduler::values(uint8_t expander, uint16_t values[PWM_CHANNELS_PER_EXPANDER]) const
+{
+    if (expander < PWM_MAX_EXPANDERS)
+        memcpy(values, _values[expander], sizeof(_values[expander]));
+}
+
+/**
+ * @brief Find the next run of adjacent set bits.
+ *
+ * @param mask Bitmask of the changed channels.
+ * @param first Input: channel to start the search from. Output: first channel of the run.
+ * @param count Output: number of channels in the run.
+ * @return true if a run was found.
+ */
+bool PwmScheduler::nextRun(uint16_t mask, uint8_t *first, uint8_t *count)
+{
+    uint8_t pin = *first;
+    while (pin < PWM_CHANNELS_PER_EXPANDER && !(mask & (1U << pin)))
+        pin++;
+    if (pin >= PWM_CHANNELS_PER_EXPANDER)
+        return false;
+
+    *first = pin;
+    while (pin < PWM_CHANNELS_PER_EXPANDER && (mask & (1U << pin)))
+        pin++;
+    *count = pin - *first;
+    return true;
+}
+
+/**
+ * @brief Encode a run of channels as one auto-increment write starting at its LEDn_ON_L register.
+ * Every channel is turned on at its phase and off its value later. The values 0 and 4095 use the
+ * full off and full on bits, such channels do not switch at all.
+ *
+ * @return Number of bytes to write.
+ */
+size_t PwmScheduler::encodeRun(const uint16_t values[PWM_CHANNELS_PER_EXPANDER],
+                               const uint16_t phases[PWM_CHANNELS_PER_EXPANDER], uint8_t first, uint8_t count,
+                               uint8_t buffer[PWM_BURST_BUFFER_SIZE])
+{
+    size_t len = 0;
+    buffer[len++] = PCA9685_LED0_ON_L + first * PCA9685_BYTES_PER_LED;
+
+    for (uint8_t pin = first; pin < first + count; pin++)
+    {
+        uint16_t on, off;
+        if (values[pin] == 0)
+        {
+            on = 0;
+            off = PCA9685_FULL;
+        }
+        else if (values[pin] >= 0xFFF)
+        {
+            on = PCA9685_FULL;
+            off = 0;
+        }
+        else
+        {
+            on = phases[pin];
+            off = (phases[pin] + values[pin]) & 0xFFF;
+        }
+
+        buffer[len++] = on & 0xFF;
+        buffer[len++] = on >> 8;
+        buffer[len++] = off & 0xFF;
+        buffer[len++] = off >> 8;
+    }
+    return len;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file pwm_scheduler.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef PWM_SCHEDULER_H
+#define PWM_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Scheduler parameters
+#define PWM_MAX_EXPANDERS         4
+#define PWM_CHANNELS_PER_EXPANDER 16
+#define PWM_MAX_CHANNELS          (PWM_MAX_EXPANDERS * PWM_CHANNELS_PER_EXPANDER)
+
+// PCA9685 registers
+#define PCA9685_LED0_ON_L       0x06
+#define PCA9685_BYTES_PER_LED   4
+#define PCA9685_FULL            0x1000 // Full on in LEDn_ON, full off in LEDn_OFF
+#define PWM_BURST_BUFFER_SIZE   (1 + PWM_CHANNELS_PER_EXPANDER * PCA9685_BYTES_PER_LED)
+
+/**
+ * @brief Collects the channel values of several PCA9685 expanders and turns them into I2C bursts.
+ *
+ * Only the latest value of a channel is kept, so a slow bus never builds up a backlog.
+ * Each flush of an expander writes every run of adjacent changed channels in one transaction
+ * using the register auto-increment, so the number of transactions does not grow with the number of channels.
+ * Every channel turns on at its phase, so the channels do not all switch at the start of the period.
+ * The scheduler has no hardware dependencies and is not thread-safe, the caller serializes the access.
+ */
+class PwmScheduler
+{
+public:
+    PwmScheduler();
+
+    bool set(uint8_t channel, uint16_t value);
+    void setPhases(uint8_t expander, const uint16_t phases[PWM_CHANNELS_PER_EXPANDER]);
+    void invalidate(uint8_t expander);
+    uint16_t take(uint8_t expander, uint16_t values[PWM_CHANNELS_PER_EXPANDER]);
+    void values(uint8_t expander, uint16_t values[PWM_CHANNELS_PER_EXPANDER]) const;
+    const uint16_t *phases(uint8_t expander) const { return _phases[expander]; }
+
+    static bool nextRun(uint16_t mask, uint8_t *first, uint8_t *count);
+    static size_t encodeRun(const uint16_t values[PWM_CHANNELS_PER_EXPANDER],
+                            const uint16_t phases[PWM_CHANNELS_PER_EXPANDER], uint8_t first, uint8_t count,
+                            uint8_t buffer[PWM_BURST_BUFFER_SIZE]);
+
+private:
+    uint16_t _values[PWM_MAX_EXPANDERS][PWM_CHANNELS_PER_EXPANDER];
+    uint16_t _phases[PWM_MAX_EXPANDERS][PWM_CHANNELS_PER_EXPANDER]; // LEDn_ON counts
+    uint16_t _dirty[PWM_MAX_EXPANDERS];
+};
+
+#endif // PWM_SCHEDULER_H
@@ -0,0 +1,205 @@
+/**
+ * @file radio_manager.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "radio_manager.h"
+#include <WiFi.h>
+#include <esp_wifi.h>
+
+#include "heap_guard.h"
+#include "logger.h"
+#include <seqlock.h>
+#include "wifi_ota_manager.h"
+
+// Frames separated by a longer gap are treated as a link loss and not counted in the jitter
+#define JITTER_MAX_GAP_US 1000000
+
+RadioProfile currentProfile = RADIO_PROFILE_DRIVE;
+volatile RadioProfile requestedProfile = RADIO_PROFILE_DRIVE;
+radio_park_cb_t radioParkCallback = NULL;
+
+// Time of the last Controller frame or of the maintenance profile start
+volatile uint32_t lastFrameMs = 0;
+bool apChannelChecked = false;
+
+// Statistics are updated in the receive path and published to the readers without locking
+JitterStats jitterStats[RADIO_PROFILES_COUNT];
+Seqlock<JitterStats> jitterStatsSnapshots[RADIO_PROFILES_COUNT];
+uint32_t lastFrameTimeUs = 0;
+
+const char *_profileToString(RadioProfile profile)
+{
+    return profile == RADIO_PROFILE_DRIVE ? "drive" : "maintenance";
+}
+
+/**
+ * @brief Apply the radio profile.
+ *
+ * @param profile The profile to apply.
+ */
+void _applyProfile(RadioProfile profile)
+{
+    if (profile == RADIO_PROFILE_DRIVE)
+    {
+        // Leave the AP so the radio does not follow its channel and does not wake for beacons
+        if (currentProfile == RADIO_PROFILE_MAINTENANCE)
+        {
+            stopOTA();
+            stopWiFi();
+        }
+        esp_wifi_set_ps(WIFI_PS_NONE);
+        esp_wifi_set_channel(RADIO_DRIVE_CHANNEL, WIFI_SECOND_CHAN_NONE);
+    }
+    else
+    {
+        // ESP-NOW follows the channel of the AP, the motors must not keep the last command meanwhile
+        if (radioParkCallback)
+            radioParkCallback();
+        setupWiFi();
+        setupOTA();
+        apChannelChecked = false;
+    }
+
+    currentProfile = profile;
+    requestedProfile = profile;
+    lastFrameTimeUs = 0;
+    lastFrameMs = millis();
+    logPrintf("Radio profile: %s\n", _profileToString(profile));
+}
+
+/**
+ * @brief Initialize the radio with the given profile.
+ * The radio starts in the drive profile, so ESP-NOW is up without waiting for the access point.
+ * The maintenance profile is applied later by handleRadio() in the background.
+ * @note This function should be called before initEspNow(), ESP-NOW needs the station interface.
+ *
+ * @param profile The profile to start with.
+ * @param parkCallback Function that stops all actuators before the maintenance profile is applied.
+ */
+void radioInit(RadioProfile profile, radio_park_cb_t parkCallback)
+{
+    radioParkCallback = parkCallback;
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+    _applyProfile(RADIO_PROFILE_DRIVE);
+    radioRequestProfile(profile);
+}
+
+/**
+ * @brief Request a profile change. The change is applied in handleRadio(),
+ * so this function may be called from the ESP-NOW callback.
+ *
+ * @param profile The requested profile.
+ */
+void radioRequestProfile(RadioProfile profile)
+{
+    requestedProfile = profile;
+}
+
+void radioToggleProfile()
+{
+    radioRequestProfile(currentProfile == RADIO_PROFILE_DRIVE ? RADIO_PROFILE_MAINTENANCE : RADIO_PROFILE_DRIVE);
+}
+
+/**
+ * @brief Check the maintenance profile. ESP-NOW follows the channel of the access point, so a
+ * Controller on the drive channel is cut off until the profile returns to drive after the timeout.
+ */
+void _checkMaintenance()
+{
+    if (!apChannelChecked && WiFi.isConnected())
+    {
+        apChannelChecked = true;
+        if (WiFi.channel() != RADIO_DRIVE_CHANNEL)
+            logPrintf("Access point is on channel %d, not on the drive channel %d: the Controller is cut off, "
+                      "the drive profile returns in %d s\n",
+                      WiFi.channel(), RADIO_DRIVE_CHANNEL, RADIO_MAINTENANCE_TIMEOUT_MS / 1000);
+    }
+
+    if (millis() - lastFrameMs > RADIO_MAINTENANCE_TIMEOUT_MS && requestedProfile == RADIO_PROFILE_MAINTENANCE)
+    {
+        logPrintf("No Controller frame in the maintenance profile for %d s\n", RADIO_MAINTENANCE_TIMEOUT_MS / 1000);
+        radioRequestProfile(RADIO_PROFILE_DRIVE);
+    }
+}
+
+/**
+ * @brief Apply the pending profile change. The profile is not changed during an OTA update.
+ * @note This function should be called periodically from the OTA task, it owns the Wi-Fi.
+ */
+void handleRadio()
+{
+    if (currentProfile == RADIO_PROFILE_MAINTENANCE && !otaActuatorsParked())
+        _checkMaintenance();
+
+    if (requestedProfile != currentProfile && !otaActuatorsParked())
+    {
+        radioPrintJitterStats(currentProfile);
+
+        // Starting and stopping the WiFi allocates, this is allowed only on a profile change
+        heapGuardExemptBegin();
+        _applyProfile(requestedProfile);
+        heapGuardExemptEnd();
+    }
+}
+
+RadioProfile radioGetProfile()
+{
+    return currentProfile;
+}
+
+/**
+ * @brief Update the inter-arrival statistics of the current profile.
+ * @note This function should be called for every accepted Controller frame.
+ */
+void radioFrameReceived()
+{
+    lastFrameMs = millis();
+
+    uint32_t now = micros();
+    uint32_t interval = now - lastFrameTimeUs;
+    bool first = lastFrameTimeUs == 0;
+    lastFrameTimeUs = now;
+
+    if (first || interval > JITTER_MAX_GAP_US)
+        return;
+
+    JitterStats &stats = jitterStats[currentProfile];
+    if (stats.frames == 0 || interval < stats.minUs)
+        stats.minUs = interval;
+    if (interval > stats.maxUs)
+        stats.maxUs = interval;
+    stats.sumUs += interval;
+    stats.sumSqUs += (uint64_t)interval * interval;
+    stats.frames++;
+    jitterStatsSnapshots[currentProfile].write(stats);
+}
+
+JitterStats radioGetJitterStats(RadioProfile profile)
+{
+    return jitterStatsSnapshots[profile].read();
+}
+
+/**
+ * @brief Print the inter-arrival statistics of the profile: mean interval and its standard deviation.
+ *
+ * @param profile The profile to print.
+ */
+void radioPrintJitterStats(RadioProfile profile)
+{
+    JitterStats stats = radioGetJitterStats(profile);
+    if (stats.frames == 0)
+        return;
+
+    uint32_t mean = stats.sumUs / stats.frames;
+    int64_t variance = (int64_t)(stats.sumSqUs / stats.frames) - (int64_t)mean * mean;
+    uint32_t jitter = sqrtf(variance > 0 ? variance : 0);
+    logPrintf("Frame interval in %s profile: %lu frames, mean %lu us, jitter %lu us, min %lu us, max %lu us\n",
+              _profileToString(profile), (unsigned long)stats.frames, (unsigned long)mean, (unsigned long)jitter,
+              (unsigned long)stats.minUs, (unsigned long)stats.maxUs);
+}
@@ -0,0 +1,61 @@
+/**
+ * @file radio_manager.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef RADIO_MANAGER_H
+#define RADIO_MANAGER_H
+
+#include <Arduino.h>
+
+// Wi-Fi channel used for ESP-NOW in the drive profile. The Controller must use the same channel.
+#ifndef RADIO_DRIVE_CHANNEL
+#define RADIO_DRIVE_CHANNEL 1
+#endif
+
+// The maintenance profile returns to drive when no Controller frame was received for this time,
+// e.g. when the access point is on another channel than the Controller
+#ifndef RADIO_MAINTENANCE_TIMEOUT_MS
+#define RADIO_MAINTENANCE_TIMEOUT_MS 300000
+#endif
+
+// Profile applied after boot
+#ifndef RADIO_DEFAULT_PROFILE
+#define RADIO_DEFAULT_PROFILE RADIO_PROFILE_DRIVE
+#endif
+
+enum RadioProfile
+{
+    RADIO_PROFILE_DRIVE,       // Fixed channel, no AP association, power save off, ESP-NOW only
+    RADIO_PROFILE_MAINTENANCE, // Connected to the AP, OTA enabled
+    // Total number of profiles
+    RADIO_PROFILES_COUNT
+};
+
+// Inter-arrival statistics of the Controller frames
+struct JitterStats
+{
+    uint32_t frames;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint64_t sumSqUs;
+};
+
+// Stops all actuators before the radio leaves the drive profile
+typedef void (*radio_park_cb_t)(void);
+
+void radioInit(RadioProfile profile, radio_park_cb_t parkCallback);
+void radioRequestProfile(RadioProfile profile);
+void radioToggleProfile();
+void handleRadio();
+RadioProfile radioGetProfile();
+void radioFrameReceived();
+JitterStats radioGetJitterStats(RadioProfile profile);
+void radioPrintJitterStats(RadioProfile profile);
+
+#endif // RADIO_MANAGER_H
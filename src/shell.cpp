@@ -0,0 +1,496 @@
+/**
+ * @file shell.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "shell.h"
+#include <WiFi.h>
+
+#include "control_manager.h"
+#include "esp_now_manager.h"
+#include "event_loop.h"
+#include "lights.h"
+#include "logger.h"
+#include "machine_config.h"
+#include "macro_manager.h"
+#include "pwm_controller.h"
+#include "radio_manager.h"
+#include "shell_parser.h"
+#include "supervisor.h"
+#include "task_plan.h"
+#include "travel_manager.h"
+#include "wifi_ota_manager.h"
+
+// Error codes of the SHELL_OP_ERROR reply
+#define SHELL_ERROR_DAMAGED  1 // Frame is too long or the CRC does not match
+#define SHELL_ERROR_UNKNOWN  2 // Unknown opcode
+#define SHELL_ERROR_PAYLOAD  3 // Wrong payload length or value
+#define SHELL_ERROR_REJECTED 4 // Motors are parked
+
+struct ShellCommand
+{
+    const char *name;
+    const char *help;
+    void (*handler)(const ShellLine &line);
+};
+
+ShellParser shellParser;
+
+shell_axis_cb_t shellAxisCallback = NULL;
+shell_levers_cb_t shellLeversCallback = NULL;
+shell_limit_stats_cb_t shellLimitStatsCallback = NULL;
+
+// Task memory is allocated statically
+StackType_t shellTaskStack[TASK_PLAN[TASK_SHELL].stackSize];
+StaticTask_t shellTaskBuffer;
+
+// Read a little-endian int16 from the binary payload
+int16_t _getInt16(const uint8_t *data)
+{
+    return (int16_t)(data[0] | (data[1] << 8));
+}
+
+void _putUint32(uint32_t value, uint8_t *out)
+{
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
+
+void _sendFrame(uint8_t opcode, const uint8_t *payload, size_t len)
+{
+    uint8_t out[SHELL_COBS_BUFFER];
+    size_t encoded = shellEncodeFrame(opcode, payload, len, out);
+    Serial.write(out, encoded);
+}
+
+void _sendError(uint8_t opcode, uint8_t error)
+{
+    uint8_t payload[] = {opcode, error};
+    _sendFrame(SHELL_OP_ERROR, payload, sizeof(payload));
+}
+
+/**
+ * @brief Find the axis by its index or name.
+ *
+ * @return Axis index or AXIS_COUNT if there is no such axis.
+ */
+uint8_t _findAxis(const char *arg)
+{
+    char *end;
+    long index = strtol(arg, &end, 10);
+    if (*end == '\0')
+        return index >= 0 && index < AXIS_COUNT ? index : AXIS_COUNT;
+
+    for (uint8_t i = 0; i < AXIS_COUNT; i++)
+    {
+        if (strcmp(MACHINE_AXES[i].name, arg) == 0)
+            return i;
+    }
+    return AXIS_COUNT;
+}
+
+bool _stopAll()
+{
+    int16_t levers[LEVERS_COUNT] = {0};
+    return shellLeversCallback(levers);
+}
+
+void _cmdHelp(const ShellLine &line);
+
+void _cmdSpeed(const ShellLine &line)
+{
+    uint8_t axis = line.argc == 3 ? _findAxis(line.argv[1]) : AXIS_COUNT;
+    if (axis == AXIS_COUNT)
+    {
+        Serial.println("Usage: speed <axis> <-255..255>");
+        return;
+    }
+
+    int16_t speed = constrain(atoi(line.argv[2]), -255, 255);
+    if (!shellAxisCallback(axis, speed))
+        Serial.println("Motors are parked or busy");
+}
+
+void _cmdStop(const ShellLine &line)
+{
+    if (!_stopAll())
+        Serial.println("Motors are busy");
+}
+
+void _cmdLight(const ShellLine &line)
+{
+    if (line.argc != 2)
+    {
+        Serial.println("Usage: light <0..5>");
+        return;
+    }
+    lightsSetMode(static_cast<LightMode>(atoi(line.argv[1])));
+}
+
+void _cmdStats(const ShellLine &line)
+{
+    const EspNowStats &link = getEspNowStats();
+    logPrintf("Link: %s, accepted %lu, handovers %lu, rejected: unknown %lu, priority %lu, lockout %lu, "
+              "length %lu, replay %lu\n",
+              link.encrypted ? "encrypted" : "not encrypted", (unsigned long)link.accepted,
+              (unsigned long)link.handovers, (unsigned long)link.rejectedUnknown,
+              (unsigned long)link.rejectedPriority, (unsigned long)link.rejectedLockout,
+              (unsigned long)link.rejectedLength, (unsigned long)link.rejectedReplay);
+    logPrintf("Receive path: last %lu us, max %lu us, over budget %lu\n", (unsigned long)link.rxPathLastUs,
+              (unsigned long)link.rxPathMaxUs, (unsigned long)link.rxPathOverBudget);
+    if (!link.encrypted)
+        logPrintf("Link keys are not provisioned, the replay check protects nothing\n");
+
+    // Latency with and without encryption, both are known when the keys were provisioned at runtime
+    for (uint8_t encrypted = 0; encrypted < 2; encrypted++)
+    {
+        const EspNowLatency &latency = link.latency[encrypted];
+        if (latency.rxFrames == 0 && latency.txFrames == 0)
+            continue;
+        logPrintf("Latency %s: receive path mean %lu us, max %lu us (%lu frames), send to ACK mean %lu us, "
+                  "max %lu us (%lu frames)\n",
+                  encrypted ? "encrypted" : "unencrypted",
+                  (unsigned long)(latency.rxFrames ? latency.rxPathSumUs / latency.rxFrames : 0),
+                  (unsigned long)latency.rxPathMaxUs, (unsigned long)latency.rxFrames,
+                  (unsigned long)(latency.txFrames ? latency.txSumUs / latency.txFrames : 0),
+                  (unsigned long)latency.txMaxUs, (unsigned long)latency.txFrames);
+    }
+
+    PwmHealth pwm = pwmGetHealth();
+    logPrintf("PWM: %s, I2C errors %lu, recoveries %lu\n", pwm.fault ? "failed" : "ok",
+              (unsigned long)pwm.i2cErrors, (unsigned long)pwm.recoveries);
+    for (uint8_t bus = 0; bus < 2; bus++)
+    {
+        PwmBusStats stats = pwmGetBusStats(bus);
+        if (stats.frames)
+            logPrintf("I2C bus %d: %lu frames, last %lu us, max %lu us\n", bus, (unsigned long)stats.frames,
+                      (unsigned long)stats.lastFrameUs, (unsigned long)stats.maxFrameUs);
+    }
+
+    radioPrintJitterStats(radioGetProfile());
+    controlPrintStats();
+    eventLoopPrintStats();
+    supervisorPrintResetReason();
+    logPrintf("Heap: free %lu bytes, minimum %lu bytes\n", (unsigned long)esp_get_free_heap_size(),
+              (unsigned long)esp_get_minimum_free_heap_size());
+}
+
+void _cmdTasks(const ShellLine &line)
+{
+    taskPlanReport();
+}
+
+void _cmdConfig(const ShellLine &line)
+{
+    logPrintf("%s [%s], radio profile %d\n", HOSTNAME, WiFi.macAddress().c_str(), radioGetProfile());
+    for (uint8_t i = 0; i < AXIS_COUNT; i++)
+    {
+        const AxisConfig &axis = MACHINE_AXES[i];
+        logPrintf("Axis %d %s: %s pins %d/%d, lever %d, %s, %s, limits %d/%d, deadband %d, max speed %d\n", i,
+                  axis.name, axis.output == MOTOR_OUTPUT_LEDC ? "GPIO" : "expander", axis.posMotorPin,
+                  axis.negMotorPin, axis.leverIndex, axis.breakMode ? "brake" : "coast",
+                  axis.reverse ? "reversed" : "normal", axis.posLimitPin, axis.negLimitPin, axis.deadband,
+                  axis.maxSpeed);
+    }
+}
+
+void _cmdLimits(const ShellLine &line)
+{
+    LimitSwitchStats stats;
+
+    for (uint8_t i = 0; i < AXIS_COUNT; i++)
+    {
+        for (bool positive : {true, false})
+        {
+            if (!shellLimitStatsCallback(i, positive, stats))
+                continue;
+
+            logPrintf("%s %c: %lu edges, %lu transitions, %lu bounces, %lu glitches, %lu chatters, max burst %lu us, "
+                      "window %lu us, late max %lu us, dropped %lu\n",
+                      MACHINE_AXES[i].name, positive ? '+' : '-', (unsigned long)stats.edges,
+                      (unsigned long)stats.transitions, (unsigned long)stats.bounces,
+                      (unsigned long)stats.glitches, (unsigned long)stats.chatters, (unsigned long)stats.maxBurstUs,
+                      (unsigned long)stats.windowUs, (unsigned long)stats.maxLateUs, (unsigned long)stats.dropped);
+        }
+    }
+}
+
+void _cmdPair(const ShellLine &line)
+{
+    uint32_t durationMs = line.argc == 2 ? atoi(line.argv[1]) * 1000 : ESP_NOW_PAIRING_WINDOW_MS;
+    espNowStartPairing(durationMs);
+}
+
+void _cmdUnpair(const ShellLine &line)
+{
+    espNowClearPairedPeers();
+}
+
+void _cmdKeys(const ShellLine &line)
+{
+    uint8_t pmk[LINK_KEY_LEN], lmk[LINK_KEY_LEN];
+
+    if (line.argc != 3 || !parseLinkKey(line.argv[1], pmk) || !parseLinkKey(line.argv[2], lmk))
+    {
+        Serial.println("Usage: keys <pmk: 32 hex digits> <lmk: 32 hex digits>");
+        return;
+    }
+    if (!espNowProvisionKeys(pmk, lmk))
+        Serial.println("Failed to provision the link keys");
+}
+
+void _cmdOtaPassword(const ShellLine &line)
+{
+    if (line.argc != 2)
+    {
+        Serial.println("Usage: otapw <password>");
+        return;
+    }
+    Serial.println(setOtaPassword(line.argv[1]) ? "OTA password stored, it takes effect after reboot"
+                                                : "Failed to store the OTA password");
+}
+
+void _cmdRadio(const ShellLine &line)
+{
+    if (line.argc == 2 && strcmp(line.argv[1], "drive") == 0)
+        radioRequestProfile(RADIO_PROFILE_DRIVE);
+    else if (line.argc == 2 && strcmp(line.argv[1], "maintenance") == 0)
+        radioRequestProfile(RADIO_PROFILE_MAINTENANCE);
+    else
+        Serial.println("Usage: radio <drive|maintenance>");
+}
+
+void _cmdMacro(const ShellLine &line)
+{
+    if (line.argc == 2 && strcmp(line.argv[1], "press") == 0)
+        macroButtonPressed();
+    else if (line.argc == 2 && strcmp(line.argv[1], "abort") == 0)
+        macroAbort();
+    else
+        Serial.println("Usage: macro <press|abort>");
+}
+
+void _cmdTravel(const ShellLine &line)
+{
+    TravelMixerConfig config = travelGetConfig();
+
+    if (line.argc == 1)
+    {
+        travelPrintConfig();
+        return;
+    }
+
+    if (line.argc == 2 && strcmp(line.argv[1], "tank") == 0)
+        config.mode = TRAVEL_MODE_TANK;
+    else if (line.argc == 2 && strcmp(line.argv[1], "mixed") == 0)
+        config.mode = TRAVEL_MODE_MIXED;
+    else if (line.argc == 4 && strcmp(line.argv[1], "trim") == 0)
+    {
+        config.trimLeft = atoi(line.argv[2]);
+        config.trimRight = atoi(line.argv[3]);
+    }
+    else if (line.argc == 3 && strcmp(line.argv[1], "counter") == 0)
+        config.counterRotationMax = atoi(line.argv[2]);
+    else if (line.argc == 3 && strcmp(line.argv[1], "straight") == 0)
+        config.straightBand = atoi(line.argv[2]);
+    else
+    {
+        Serial.println("Usage: travel [tank|mixed|trim <left> <right>|counter <0..255>|straight <0..255>]");
+        return;
+    }
+
+    if (!travelSetConfig(config))
+        Serial.println("Invalid or not stored travel configuration, the trims are 0..1000 permille");
+    travelPrintConfig();
+}
+
+void _cmdPwm(const ShellLine &line)
+{
+    pwmPrintPhasePlan();
+}
+
+void _cmdBinary(const ShellLine &line)
+{
+    Serial.println("Binary mode, the log is muted, send SHELL_OP_TEXT_MODE to return");
+    logSetMuted(true);
+    shellParser.setMode(SHELL_MODE_BINARY);
+}
+
+const ShellCommand shellCommands[] = {
+    {"help", "List the commands", _cmdHelp},
+    {"speed", "speed <axis> <-255..255> - set the axis speed", _cmdSpeed},
+    {"stop", "Stop all motors", _cmdStop},
+    {"light", "light <0..5> - set the light mode", _cmdLight},
+    {"stats", "Print the link, PWM, radio, control, loop, reset and heap statistics", _cmdStats},
+    {"tasks", "Verify the cores, priorities and stacks of the tasks", _cmdTasks},
+    {"config", "Print the machine configuration", _cmdConfig},
+    {"limits", "Print the bounce statistics and debounce windows of the limit switches", _cmdLimits},
+    {"pair", "pair [seconds] - accept a new Controller", _cmdPair},
+    {"unpair", "Forget the Controllers paired at runtime", _cmdUnpair},
+    {"keys", "keys <pmk> <lmk> - provision the ESP-NOW link keys", _cmdKeys},
+    {"otapw", "otapw <password> - store the OTA password", _cmdOtaPassword},
+    {"radio", "radio <drive|maintenance> - switch the radio profile", _cmdRadio},
+    {"macro", "macro <press|abort> - press the macro button or abort the playback", _cmdMacro},
+    {"travel", "travel [tank|mixed|trim|counter|straight] - configure the travel mixer", _cmdTravel},
+    {"pwm", "Print the PWM phase plan and the modeled peak currents", _cmdPwm},
+    {"binary", "Switch to the binary mode", _cmdBinary},
+};
+
+void _cmdHelp(const ShellLine &line)
+{
+    for (const ShellCommand &command : shellCommands)
+        logPrintf("%-8s %s\n", command.name, command.help);
+}
+
+void _handleLine(const ShellLine &line)
+{
+    for (const ShellCommand &command : shellCommands)
+    {
+        if (strcmp(command.name, line.argv[0]) == 0)
+        {
+            command.handler(line);
+            return;
+        }
+    }
+    logPrintf("Unknown command: %s, type help\n", line.argv[0]);
+}
+
+/**
+ * @brief Execute a binary frame. Set commands are not acknowledged to keep the stream fast,
+ * only errors and queries are answered.
+ */
+void _handleFrame(const ShellFrame &frame)
+{
+    switch (frame.opcode)
+    {
+        case SHELL_OP_SET_AXIS:
+            if (frame.len != 3 || frame.payload[0] >= AXIS_COUNT)
+                _sendError(frame.opcode, SHELL_ERROR_PAYLOAD);
+            else if (!shellAxisCallback(frame.payload[0], constrain(_getInt16(frame.payload + 1), -255, 255)))
+                _sendError(frame.opcode, SHELL_ERROR_REJECTED);
+            break;
+        case SHELL_OP_SET_LEVERS:
+        {
+            if (frame.len != LEVERS_COUNT * sizeof(int16_t))
+            {
+                _sendError(frame.opcode, SHELL_ERROR_PAYLOAD);
+                break;
+            }
+            int16_t levers[LEVERS_COUNT];
+            for (uint8_t i = 0; i < LEVERS_COUNT; i++)
+                levers[i] = constrain(_getInt16(frame.payload + i * sizeof(int16_t)), -255, 255);
+            if (!shellLeversCallback(levers))
+                _sendError(frame.opcode, SHELL_ERROR_REJECTED);
+            break;
+        }
+        case SHELL_OP_SET_LIGHTS:
+            if (frame.len != 1 || frame.payload[0] > ALL_LIGHTS_WITH_BLINKING)
+                _sendError(frame.opcode, SHELL_ERROR_PAYLOAD);
+            else
+                lightsSetMode(static_cast<LightMode>(frame.payload[0]));
+            break;
+        case SHELL_OP_STOP:
+            if (!_stopAll())
+                _sendError(frame.opcode, SHELL_ERROR_REJECTED);
+            break;
+        case SHELL_OP_GET_STATS:
+        {
+            const EspNowStats &link = getEspNowStats();
+            PwmHealth pwm = pwmGetHealth();
+            uint32_t counters[] = {link.accepted, link.rejectedReplay, link.rxPathMaxUs, pwm.i2cErrors,
+                                   pwm.recoveries, pwm.fault, pwmGetBusStats(0).maxFrameUs};
+            uint8_t payload[sizeof(counters)];
+            for (uint8_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+                _putUint32(counters[i], payload + i * sizeof(uint32_t));
+            _sendFrame(frame.opcode | SHELL_OP_REPLY, payload, sizeof(payload));
+            break;
+        }
+        case SHELL_OP_TEXT_MODE:
+            shellParser.setMode(SHELL_MODE_TEXT);
+            logSetMuted(false);
+            logPrintf("Text mode, %lu log messages were dropped\n", (unsigned long)logMutedCount());
+            break;
+        default:
+            _sendError(frame.opcode, SHELL_ERROR_UNKNOWN);
+            break;
+    }
+}
+
+/**
+ * @brief Task function for the serial command shell.
+ *
+ * The received bytes are polled with a low priority on core 0, so the shell never delays the control tasks.
+ *
+ * @param pvParameters A pointer to task parameters (not used in this function).
+ */
+void shellTask(void *pvParameters)
+{
+    Serial.println("shellTask started, type help");
+
+    for (;;)
+    {
+        while (Serial.available() > 0)
+        {
+            switch (shellParser.feed(Serial.read()))
+            {
+                case SHELL_LINE:
+                    _handleLine(shellParser.line());
+                    break;
+                case SHELL_FRAME:
+                    _handleFrame(shellParser.frame());
+                    break;
+                case SHELL_ERROR:
+                    if (shellParser.mode() == SHELL_MODE_BINARY)
+                        _sendError(0, SHELL_ERROR_DAMAGED);
+                    else
+                        Serial.println("Command is too long");
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        supervisorFeed();
+
+        // The ESP-NOW callback notifies the task that started the pairing when a controller is paired
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TASK_PLAN[TASK_SHELL].periodMs)) > 0)
+            espNowSavePairedPeer();
+    }
+}
+
+/**
+ * @brief Initializes the shell task.
+ *
+ * @param axisCallback Function that applies a speed to one axis.
+ * @param leversCallback Function that applies a lever vector to the motors.
+ * @param limitStatsCallback Function that reads the statistics of one limit switch.
+ *
+ * @note This function should be called once during the setup phase of the program, after Serial.begin().
+ */
+void shellTaskInit(shell_axis_cb_t axisCallback, shell_levers_cb_t leversCallback,
+                   shell_limit_stats_cb_t limitStatsCallback)
+{
+    shellAxisCallback = axisCallback;
+    shellLeversCallback = leversCallback;
+    shellLimitStatsCallback = limitStatsCallback;
+
+    TaskHandle_t task = xTaskCreateStaticPinnedToCore(shellTask,
+                                                     TASK_PLAN[TASK_SHELL].name,
+                                                     TASK_PLAN[TASK_SHELL].stackSize,
+                                                     NULL,
+                                                     TASK_PLAN[TASK_SHELL].priority,
+                                                     shellTaskStack,
+                                                     &shellTaskBuffer,
+                                                     TASK_PLAN[TASK_SHELL].core);
+    if (task == NULL)
+    {
+        Serial.println("Failed to create shellTask");
+    }
+    taskPlanRegister(TASK_SHELL, task);
+}
@@ -0,0 +1,41 @@
+/**
+ * @file shell.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <Arduino.h>
+
+#include "constants.h"
+#include "limit_debouncer.h"
+
+// Serial receive buffer size, holds the binary frames streamed between two polls of the shell task
+#define SHELL_RX_BUFFER_SIZE 1024
+
+// Binary mode opcodes. Replies have the SHELL_OP_REPLY bit set.
+#define SHELL_OP_SET_AXIS   0x01 // Payload: axis (uint8), speed (int16)
+#define SHELL_OP_SET_LEVERS 0x02 // Payload: LEVERS_COUNT lever positions (int16)
+#define SHELL_OP_SET_LIGHTS 0x03 // Payload: light mode (uint8)
+#define SHELL_OP_STOP       0x04 // No payload
+#define SHELL_OP_GET_STATS  0x10 // No payload, the reply carries the counters (uint32 each)
+#define SHELL_OP_TEXT_MODE  0x7F // No payload, switch back to the text commands
+#define SHELL_OP_REPLY      0x80
+#define SHELL_OP_ERROR      0xFF // Payload: opcode of the rejected frame, or 0 for a damaged frame
+
+// Applies a speed to one axis, returns false if the motors are parked or the command can't be queued
+typedef bool (*shell_axis_cb_t)(uint8_t axis, int16_t speed);
+// Applies a lever vector to the motors, returns false if the command can't be queued
+typedef bool (*shell_levers_cb_t)(const int16_t levers[LEVERS_COUNT]);
+// Reads the statistics of one limit switch, returns false if the axis has no such switch
+typedef bool (*shell_limit_stats_cb_t)(uint8_t axis, bool positive, LimitSwitchStats &stats);
+
+void shellTaskInit(shell_axis_cb_t axisCallback, shell_levers_cb_t leversCallback,
+                   shell_limit_stats_cb_t limitStatsCallback);
+
+#endif // SHELL_H
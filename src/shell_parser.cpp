@@ -0,0 +1,212 @@
+/**
+ * @file shell_parser.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "shell_parser.h"
+#include <string.h>
+
+ShellParser::ShellParser()
+{
+    _mode = SHELL_MODE_TEXT;
+    _len = 0;
+    _overflow = false;
+    _line = {};
+    _frame = {};
+}
+
+/**
+ * @brief Switch the input mode. Partially received data is dropped.
+ */
+void ShellParser::setMode(ShellMode mode)
+{
+    _mode = mode;
+    _len = 0;
+    _overflow = false;
+}
+
+/**
+ * @brief Feed one received byte.
+ *
+ * @return SHELL_LINE or SHELL_FRAME when a command is complete.
+ */
+ShellResult ShellParser::feed(uint8_t byte)
+{
+    return _mode == SHELL_MODE_TEXT ? _feedText(byte) : _feedBinary(byte);
+}
+
+ShellResult ShellParser::_feedText(uint8_t byte)
+{
+    if (byte == '\r')
+        return SHELL_PENDING;
+
+    if (byte != '\n')
+    {
+        if (_len < SHELL_MAX_LINE - 1)
+            _buffer[_len++] = byte;
+        else
+            _overflow = true;
+        return SHELL_PENDING;
+    }
+
+    // End of the line
+    size_t len = _len;
+    bool overflow = _overflow;
+    _len = 0;
+    _overflow = false;
+    if (overflow)
+        return SHELL_ERROR;
+
+    // Split the line into words in place
+    char *text = reinterpret_cast<char *>(_buffer);
+    text[len] = '\0';
+    _line.argc = 0;
+    char *context = NULL;
+    for (char *word = strtok_r(text, " \t", &context); word != NULL && _line.argc < SHELL_MAX_ARGS;
+         word = strtok_r(NULL, " \t", &context))
+        _line.argv[_line.argc++] = word;
+
+    // Empty lines are ignored
+    return _line.argc > 0 ? SHELL_LINE : SHELL_PENDING;
+}
+
+ShellResult ShellParser::_feedBinary(uint8_t byte)
+{
+    if (byte != 0)
+    {
+        if (_len < sizeof(_buffer))
+            _buffer[_len++] = byte;
+        else
+            _overflow = true;
+        return SHELL_PENDING;
+    }
+
+    // End of the frame
+    size_t len = _len;
+    bool overflow = _overflow;
+    _len = 0;
+    _overflow = false;
+    if (len == 0)
+        return SHELL_PENDING;
+    if (overflow)
+        return SHELL_ERROR;
+
+    size_t decoded = shellCobsDecode(_buffer, len, _decoded, sizeof(_decoded));
+    if (decoded < 1 + SHELL_CRC_SIZE)
+        return SHELL_ERROR;
+
+    // The CRC is sent little-endian after the opcode and payload
+    size_t dataLen = decoded - SHELL_CRC_SIZE;
+    uint16_t crc = _decoded[dataLen] | (_decoded[dataLen + 1] << 8);
+    if (crc != shellCrc16(_decoded, dataLen))
+        return SHELL_ERROR;
+
+    _frame.opcode = _decoded[0];
+    _frame.payload = _decoded + 1;
+    _frame.len = dataLen - 1;
+    return SHELL_FRAME;
+}
+
+// CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF
+uint16_t shellCrc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+/**
+ * @brief Encode the data with COBS, so it contains no zero bytes. The delimiter is not added.
+ *
+ * @return Length of the encoded data, at most len + len / 254 + 1 bytes.
+ */
+size_t shellCobsEncode(const uint8_t *data, size_t len, uint8_t *out)
+{
+    size_t codePos = 0;
+    size_t outLen = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] != 0)
+        {
+            out[outLen++] = data[i];
+            code++;
+        }
+
+        if (data[i] == 0 || code == 0xFF)
+        {
+            out[codePos] = code;
+            codePos = outLen++;
+            code = 1;
+        }
+    }
+    out[codePos] = code;
+    return outLen;
+}
+
+/**
+ * @brief Decode COBS data without the delimiter.
+ *
+ * @return Length of the decoded data or 0 if the data is invalid or does not fit.
+ */
+size_t shellCobsDecode(const uint8_t *data, size_t len, uint8_t *out, size_t outSize)
+{
+    size_t outLen = 0;
+
+    for (size_t i = 0; i < len;)
+    {
+        uint8_t code = data[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+
+        for (uint8_t j = 1; j < code; j++)
+        {
+            if (outLen >= outSize)
+                return 0;
+            out[outLen++] = data[i++];
+        }
+
+        // A code below 0xFF is followed by a zero, except at the end of the data
+        if (code < 0xFF && i < len)
+        {
+            if (outLen >= outSize)
+                return 0;
+            out[outLen++] = 0;
+        }
+    }
+    return outLen;
+}
+
+/**
+ * @brief Build a complete binary frame: COBS encoded opcode, payload and CRC with the delimiter.
+ *
+ * @return Number of bytes to send or 0 if the payload is too long.
+ */
+size_t shellEncodeFrame(uint8_t opcode, const uint8_t *payload, size_t len, uint8_t out[SHELL_COBS_BUFFER])
+{
+    uint8_t frame[SHELL_FRAME_BUFFER];
+
+    if (len > SHELL_MAX_PAYLOAD)
+        return 0;
+
+    frame[0] = opcode;
+    memcpy(frame + 1, payload, len);
+    uint16_t crc = shellCrc16(frame, len + 1);
+    frame[len + 1] = crc & 0xFF;
+    frame[len + 2] = crc >> 8;
+
+    size_t encoded = shellCobsEncode(frame, len + 1 + SHELL_CRC_SIZE, out);
+    out[encoded++] = 0;
+    return encoded;
+}
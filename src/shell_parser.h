@@ -0,0 +1,87 @@
+/**
+ * @file shell_parser.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef SHELL_PARSER_H
+#define SHELL_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Parser parameters
+#define SHELL_MAX_LINE     128 // Longest text command including the arguments
+#define SHELL_MAX_ARGS     4   // Command name and its arguments
+#define SHELL_MAX_PAYLOAD  32  // Longest binary frame payload
+#define SHELL_CRC_SIZE     2
+#define SHELL_FRAME_BUFFER (1 + SHELL_MAX_PAYLOAD + SHELL_CRC_SIZE) // Opcode, payload and CRC
+#define SHELL_COBS_BUFFER  (SHELL_FRAME_BUFFER + SHELL_FRAME_BUFFER / 254 + 2) // Encoded frame with the delimiter
+
+enum ShellMode
+{
+    SHELL_MODE_TEXT,  // Lines of space-separated words terminated by '\n'
+    SHELL_MODE_BINARY // COBS encoded frames terminated by 0x00: opcode, payload, CRC-16/CCITT
+};
+
+enum ShellResult
+{
+    SHELL_PENDING, // More bytes are needed
+    SHELL_LINE,    // A text command is ready, see line()
+    SHELL_FRAME,   // A binary frame is ready, see frame()
+    SHELL_ERROR    // The line is too long or the frame is damaged, the data is dropped
+};
+
+struct ShellLine
+{
+    uint8_t argc;
+    char *argv[SHELL_MAX_ARGS];
+};
+
+struct ShellFrame
+{
+    uint8_t opcode;
+    const uint8_t *payload;
+    uint8_t len;
+};
+
+/**
+ * @brief Splits the serial input into text commands or binary frames.
+ *
+ * The parser has no hardware dependencies and needs no heap. The returned line or frame
+ * stays valid until the next call of feed().
+ */
+class ShellParser
+{
+public:
+    ShellParser();
+
+    ShellResult feed(uint8_t byte);
+    void setMode(ShellMode mode);
+    ShellMode mode() const { return _mode; }
+
+    const ShellLine &line() const { return _line; }
+    const ShellFrame &frame() const { return _frame; }
+
+private:
+    ShellResult _feedText(uint8_t byte);
+    ShellResult _feedBinary(uint8_t byte);
+
+    ShellMode _mode;
+    uint8_t _buffer[SHELL_COBS_BUFFER > SHELL_MAX_LINE ? SHELL_COBS_BUFFER : SHELL_MAX_LINE];
+    uint8_t _decoded[SHELL_FRAME_BUFFER];
+    size_t _len;
+    bool _overflow; // Drop the input until the end of the line or frame
+    ShellLine _line;
+    ShellFrame _frame;
+};
+
+uint16_t shellCrc16(const uint8_t *data, size_t len);
+size_t shellCobsEncode(const uint8_t *data, size_t len, uint8_t *out);
+size_t shellCobsDecode(const uint8_t *data, size_t len, uint8_t *out, size_t outSize);
+size_t shellEncodeFrame(uint8_t opcode, const uint8_t *payload, size_t len, uint8_t out[SHELL_COBS_BUFFER]);
+
+#endif // SHELL_PARSER_H
@@ -0,0 +1,282 @@
+/**
+ * @file supervisor.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "supervisor.h"
+#include <esp_task_wdt.h>
+
+#include "constants.h"
+#include "heartbeat_monitor.h"
+#include "logger.h"
+#include "task_plan.h"
+
+// Heartbeat deadlines
+#define SUPERVISOR_MISSED_PERIODS  3    // Periods a task may miss
+#define SUPERVISOR_MIN_DEADLINE_MS 1000 // Covers the flash writes and the Wi-Fi start
+
+// The hardware watchdog catches the tasks that stop the scheduler, e.g. a hang in a critical section,
+// and the supervisor itself. It must be longer than all heartbeat deadlines.
+#define SUPERVISOR_TWDT_TIMEOUT_S 5
+
+#define SUPERVISOR_RESET_DELAY_MS 100 // Time to flush the logs before the reset
+#define SUPERVISOR_RECORD_MAGIC   0x53555052
+
+// Reason of the last reset caused by the supervisor
+enum SupervisorResetReason : uint8_t
+{
+    SUPERVISOR_RESET_HEARTBEAT, // A task missed its heartbeat deadline
+    SUPERVISOR_RESET_WATCHDOG   // The hardware task watchdog has fired
+};
+
+// Reset record kept in the RTC memory, it survives the software and watchdog resets
+struct SupervisorResetRecord
+{
+    uint32_t magic;
+    uint8_t reason;
+    uint8_t task; // TaskId, TASK_COUNT if unknown
+    uint32_t silenceMs;
+    uint32_t uptimeS;
+    uint32_t resets; // Supervisor resets in a row
+};
+
+RTC_NOINIT_ATTR SupervisorResetRecord supervisorResetRecord;
+
+// Copy of the record of the last reset, taken at boot
+SupervisorResetRecord supervisorLastReset;
+esp_reset_reason_t supervisorResetReason;
+
+// Supervised task with its heartbeat slot
+struct SupervisedTask
+{
+    TaskHandle_t handle;
+    TaskId id;
+    int slot;
+};
+
+HeartbeatMonitor heartbeats;
+SupervisedTask supervisedTasks[HEARTBEAT_MAX_SLOTS];
+volatile uint8_t supervisedTasksCount = 0;
+
+// Task memory is allocated statically
+StackType_t supervisorTaskStack[TASK_PLAN[TASK_SUPERVISOR].stackSize];
+StaticTask_t supervisorTaskBuffer;
+
+const char *_resetReasonToString(esp_reset_reason_t reason)
+{
+    switch (reason)
+    {
+        case ESP_RST_POWERON:
+            return "power-on";
+        case ESP_RST_SW:
+            return "software";
+        case ESP_RST_PANIC:
+            return "panic";
+        case ESP_RST_INT_WDT:
+            return "interrupt watchdog";
+        case ESP_RST_TASK_WDT:
+            return "task watchdog";
+        case ESP_RST_WDT:
+            return "other watchdog";
+        case ESP_RST_BROWNOUT:
+            return "brownout";
+        default:
+            return "other";
+    }
+}
+
+// Find the supervised task by its handle
+SupervisedTask *_findTask(TaskHandle_t handle)
+{
+    for (uint8_t i = 0; i < supervisedTasksCount; i++)
+    {
+        if (supervisedTasks[i].handle == handle)
+            return &supervisedTasks[i];
+    }
+    return NULL;
+}
+
+// Stop all motors without waiting for any task, the motor drivers are put to sleep
+void _safeStop()
+{
+    gpio_set_level(MOTOR_DRIVER_SLEEP_PIN, 0);
+}
+
+void _storeResetRecord(SupervisorResetReason reason, int slot, uint32_t now)
+{
+    SupervisorResetRecord &record = supervisorResetRecord;
+    record.resets = supervisorLastReset.magic == SUPERVISOR_RECORD_MAGIC ? supervisorLastReset.resets + 1 : 1;
+    record.reason = reason;
+    record.task = TASK_COUNT;
+    record.silenceMs = 0;
+    for (uint8_t i = 0; i < supervisedTasksCount; i++)
+    {
+        if (supervisedTasks[i].slot == slot)
+        {
+            record.task = supervisedTasks[i].id;
+            record.silenceMs = heartbeats.silenceMs(slot, now);
+        }
+    }
+    record.uptimeS = now / 1000;
+    record.magic = SUPERVISOR_RECORD_MAGIC;
+}
+
+/**
+ * @brief Called by the task watchdog interrupt before the panic reset. Overrides the weak function
+ * of the ESP-IDF. Only stops the motors and stores the reason, the scheduler may be stuck.
+ */
+extern "C" void esp_task_wdt_isr_user_handler(void)
+{
+    _safeStop();
+
+    uint32_t now = esp_timer_get_time() / 1000;
+    _storeResetRecord(SUPERVISOR_RESET_WATCHDOG, heartbeats.overdue(now), now);
+}
+
+/**
+ * @brief Task function of the supervisor.
+ *
+ * A task that misses its heartbeat deadline is treated as hung: the motors are stopped,
+ * the reason is stored in the RTC memory and the chip is reset.
+ *
+ * @param pvParameters A pointer to task parameters (not used in this function).
+ */
+void supervisorTask(void *pvParameters)
+{
+    const TickType_t xFrequency = pdMS_TO_TICKS(TASK_PLAN[TASK_SUPERVISOR].periodMs);
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+
+    esp_task_wdt_add(NULL);
+
+    Serial.println("supervisorTask started");
+
+    // Main task loop
+    for (;;)
+    {
+        esp_task_wdt_reset();
+
+        uint32_t now = millis();
+        int slot = heartbeats.overdue(now);
+        if (slot != HEARTBEAT_NO_SLOT)
+        {
+            _safeStop();
+            _storeResetRecord(SUPERVISOR_RESET_HEARTBEAT, slot, now);
+            logPrintf("%s missed its deadline, silent for %lu ms, resetting\n",
+                      TASK_PLAN[supervisorResetRecord.task].name, (unsigned long)supervisorResetRecord.silenceMs);
+            vTaskDelay(pdMS_TO_TICKS(SUPERVISOR_RESET_DELAY_MS));
+            esp_restart();
+        }
+
+        // Wait for the next cycle.
+        xTaskDelayUntil(&xLastWakeTime, xFrequency);
+    }
+}
+
+/**
+ * @brief Start the supervision of all tasks created from the task plan.
+ * Every task is subscribed to the hardware task watchdog and gets a heartbeat deadline derived from its period.
+ *
+ * @note This function should be called once at the end of the setup, after all tasks are created.
+ */
+void supervisorTaskInit()
+{
+    esp_task_wdt_init(SUPERVISOR_TWDT_TIMEOUT_S, true);
+
+    uint32_t now = millis();
+    for (size_t i = 0; i < taskPlanRegisteredCount() && supervisedTasksCount < HEARTBEAT_MAX_SLOTS; i++)
+    {
+        const RegisteredTask &task = taskPlanRegistered(i);
+        const TaskPlan &plan = TASK_PLAN[task.id];
+        uint32_t deadline = HeartbeatMonitor::deadlineFor(plan.periodMs, SUPERVISOR_FEED_INTERVAL_MS,
+                                                          SUPERVISOR_MISSED_PERIODS, SUPERVISOR_MIN_DEADLINE_MS);
+
+        // The entry is complete before it becomes visible to supervisorFeed()
+        supervisedTasks[supervisedTasksCount] = {task.handle, task.id, heartbeats.add(deadline, now)};
+        supervisedTasksCount = supervisedTasksCount + 1;
+        esp_task_wdt_add(task.handle);
+    }
+
+    TaskHandle_t task = xTaskCreateStaticPinnedToCore(supervisorTask,
+                                                     TASK_PLAN[TASK_SUPERVISOR].name,
+                                                     TASK_PLAN[TASK_SUPERVISOR].stackSize,
+                                                     NULL,
+                                                     TASK_PLAN[TASK_SUPERVISOR].priority,
+                                                     supervisorTaskStack,
+                                                     &supervisorTaskBuffer,
+                                                     TASK_PLAN[TASK_SUPERVISOR].core);
+    if (task == NULL)
+    {
+        Serial.println("Failed to create supervisorTask");
+    }
+    taskPlanRegister(TASK_SUPERVISOR, task);
+}
+
+/**
+ * @brief Report that the calling task is alive. Does nothing before the supervision starts.
+ * @note Every supervised task must call this function at least once per period.
+ */
+void supervisorFeed()
+{
+    SupervisedTask *task = _findTask(xTaskGetCurrentTaskHandle());
+    if (task == NULL)
+        return;
+
+    heartbeats.beat(task->slot, millis());
+    esp_task_wdt_reset();
+}
+
+/**
+ * @brief Stop supervising the calling task, e.g. while it blocks for the whole OTA update.
+ */
+void supervisorPause()
+{
+    SupervisedTask *task = _findTask(xTaskGetCurrentTaskHandle());
+    if (task == NULL)
+        return;
+
+    heartbeats.pause(task->slot);
+    esp_task_wdt_delete(task->handle);
+}
+
+void supervisorResume()
+{
+    SupervisedTask *task = _findTask(xTaskGetCurrentTaskHandle());
+    if (task == NULL)
+        return;
+
+    esp_task_wdt_add(task->handle);
+    heartbeats.resume(task->slot, millis());
+}
+
+/**
+ * @brief Print the reason of the last reset. The first call takes the record from the RTC memory,
+ * so it should be made early in the setup.
+ */
+void supervisorPrintResetReason()
+{
+    static bool taken = false;
+    if (!taken)
+    {
+        taken = true;
+        supervisorResetReason = esp_reset_reason();
+
+        // The RTC memory is not initialized after the power-on
+        if (supervisorResetReason != ESP_RST_POWERON && supervisorResetReason != ESP_RST_BROWNOUT)
+            supervisorLastReset = supervisorResetRecord;
+        supervisorResetRecord.magic = 0;
+    }
+
+    logPrintf("Reset reason: %s\n", _resetReasonToString(supervisorResetReason));
+    if (supervisorLastReset.magic != SUPERVISOR_RECORD_MAGIC)
+        return;
+
+    const SupervisorResetRecord &record = supervisorLastReset;
+    logPrintf("Supervisor reset #%lu by the %s after %lu s: %s silent for %lu ms\n", (unsigned long)record.resets,
+              record.reason == SUPERVISOR_RESET_WATCHDOG ? "task watchdog" : "heartbeat check",
+              (unsigned long)record.uptimeS, record.task < TASK_COUNT ? TASK_PLAN[record.task].name : "unknown task",
+              (unsigned long)record.silenceMs);
+}
@@ -0,0 +1,24 @@
+/**
+ * @file supervisor.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <Arduino.h>
+
+// Longest wait of the event-driven tasks, they feed the supervisor at least this often
+#define SUPERVISOR_FEED_INTERVAL_MS 100
+
+void supervisorTaskInit();
+void supervisorFeed();
+void supervisorPause();
+void supervisorResume();
+void supervisorPrintResetReason();
+
+#endif // SUPERVISOR_H
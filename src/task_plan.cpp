@@ -0,0 +1,95 @@
+/**
+ * @file task_plan.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "task_plan.h"
+
+#include "logger.h"
+
+// Tasks with several instances, e.g. one PWM task per I2C bus, are registered more than once
+#define TASK_REGISTRY_SIZE (TASK_COUNT + 2)
+
+RegisteredTask registeredTasks[TASK_REGISTRY_SIZE];
+uint8_t registeredTasksCount = 0;
+
+/**
+ * @brief Remember a created task for the startup report.
+ *
+ * @param id Planned task.
+ * @param handle Handle of the created task, NULL if the creation has failed.
+ */
+void taskPlanRegister(TaskId id, TaskHandle_t handle)
+{
+    if (handle == NULL || registeredTasksCount >= TASK_REGISTRY_SIZE)
+        return;
+
+    registeredTasks[registeredTasksCount++] = {id, handle};
+}
+
+size_t taskPlanRegisteredCount()
+{
+    return registeredTasksCount;
+}
+
+const RegisteredTask &taskPlanRegistered(size_t index)
+{
+    return registeredTasks[index];
+}
+
+/**
+ * @brief Print the planned and the actual parameters of all tasks and report every deviation
+ * from the plan: a missing task, a wrong core or priority, or a stack that is almost used up.
+ *
+ * @return Number of deviations.
+ */
+uint8_t taskPlanReport()
+{
+    uint8_t deviations = 0;
+    bool started[TASK_COUNT] = {false};
+
+    logPrintf("%-18s %4s %4s %6s %6s %6s\n", "Task", "core", "prio", "period", "stack", "free");
+    for (uint8_t i = 0; i < registeredTasksCount; i++)
+    {
+        const RegisteredTask &task = registeredTasks[i];
+        const TaskPlan &plan = TASK_PLAN[task.id];
+        started[task.id] = true;
+
+        BaseType_t core = xTaskGetAffinity(task.handle);
+        UBaseType_t priority = uxTaskPriorityGet(task.handle);
+        uint32_t freeStack = uxTaskGetStackHighWaterMark(task.handle); // Bytes on the ESP32
+
+        logPrintf("%-18s %4d %4u %6lu %6lu %6lu\n", pcTaskGetName(task.handle), core, priority,
+                  (unsigned long)plan.periodMs, (unsigned long)plan.stackSize, (unsigned long)freeStack);
+
+        if (core != plan.core || priority != plan.priority)
+        {
+            logPrintf("  %s planned on core %d with priority %u\n", plan.name, plan.core, plan.priority);
+            deviations++;
+        }
+        if (freeStack < plan.stackSize / 8)
+        {
+            logPrintf("  %s stack is almost used up\n", plan.name);
+            deviations++;
+        }
+    }
+
+    for (uint8_t id = 0; id < TASK_COUNT; id++)
+    {
+        if (!started[id])
+        {
+            logPrintf("  %s is not running\n", TASK_PLAN[id].name);
+            deviations++;
+        }
+    }
+
+    if (deviations)
+        logPrintf("Task plan: %d deviations\n", deviations);
+    else
+        Serial.println("Task plan verified");
+    return deviations;
+}
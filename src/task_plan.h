@@ -0,0 +1,112 @@
+/**
+ * @file task_plan.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef TASK_PLAN_H
+#define TASK_PLAN_H
+
+#include <Arduino.h>
+
+// Core 1 runs only the real-time pipeline: control with the limit switches, macros and PWM.
+// Core 0 runs the Wi-Fi stack with the ESP-NOW callback, logging, OTA, the shell, the lights and the ADC.
+#define CORE_REALTIME 1
+#define CORE_SYSTEM   0
+
+// Firmware tasks, indexes in TASK_PLAN
+enum TaskId : uint8_t
+{
+    TASK_CONTROL,
+    TASK_PWM,
+    TASK_MACRO,
+    TASK_LOOP,
+    TASK_LIGHTS,
+    TASK_POWER_MANAGER,
+    TASK_OTA,
+    TASK_SHELL,
+    TASK_SUPERVISOR,
+    // Total number of tasks
+    TASK_COUNT
+};
+
+// Scheduling parameters of one task
+struct TaskPlan
+{
+    const char *name;
+    uint32_t stackSize;   // Bytes
+    UBaseType_t priority;
+    BaseType_t core;      // CORE_REALTIME or CORE_SYSTEM
+    uint32_t periodMs;    // 0 for the tasks woken by events
+};
+
+// The priorities are ordered along the control pipeline: a frame is applied by the control task,
+// then written by the PWM task. The Wi-Fi task runs on core 0 with priority 23.
+constexpr TaskPlan TASK_PLAN[] = {
+    [TASK_CONTROL] = {.name = "controlTask",
+        .stackSize = 4 * 1024U,
+        .priority = tskIDLE_PRIORITY + 3,
+        .core = CORE_REALTIME,
+        .periodMs = 0},
+    [TASK_PWM] = {.name = "pwmTask",
+        .stackSize = 2 * 1024U,
+        .priority = tskIDLE_PRIORITY + 2,
+        .core = CORE_REALTIME,
+        .periodMs = 0},
+    [TASK_MACRO] = {.name = "macroTask",
+        .stackSize = 3 * 1024U,
+        .priority = tskIDLE_PRIORITY + 2,
+        .core = CORE_REALTIME,
+        .periodMs = 20},
+    // Created by the Arduino core, the parameters are only checked. The loop only reports the heap
+    // and feeds the supervisor, the motors and the limit switches are handled by the control task.
+    [TASK_LOOP] = {.name = "loopTask",
+        .stackSize = 8 * 1024U,
+        .priority = tskIDLE_PRIORITY + 1,
+        .core = CORE_REALTIME,
+        .periodMs = 100},
+    [TASK_LIGHTS] = {.name = "lightsTask",
+        .stackSize = 2 * 1024U,
+        .priority = tskIDLE_PRIORITY + 1,
+        .core = CORE_SYSTEM,
+        .periodMs = 20},
+    [TASK_POWER_MANAGER] = {.name = "powerManagerTask",
+        .stackSize = 2 * 1024U,
+        .priority = tskIDLE_PRIORITY + 1,
+        .core = CORE_SYSTEM,
+        .periodMs = 1000},
+    [TASK_OTA] = {.name = "otaTask",
+        .stackSize = 4 * 1024U,
+        .priority = tskIDLE_PRIORITY + 1,
+        .core = CORE_SYSTEM,
+        .periodMs = 20},
+    [TASK_SHELL] = {.name = "shellTask",
+        .stackSize = 4 * 1024U,
+        .priority = tskIDLE_PRIORITY + 1,
+        .core = CORE_SYSTEM,
+        .periodMs = 2},
+    // Above all other tasks of core 0, so a runaway task on core 1 can't starve it
+    [TASK_SUPERVISOR] = {.name = "supervisorTask",
+        .stackSize = 3 * 1024U,
+        .priority = tskIDLE_PRIORITY + 4,
+        .core = CORE_SYSTEM,
+        .periodMs = 100}};
+
+static_assert(sizeof(TASK_PLAN) / sizeof(TASK_PLAN[0]) == TASK_COUNT, "Every task must be planned");
+
+// Task created from the plan
+struct RegisteredTask
+{
+    TaskId id;
+    TaskHandle_t handle;
+};
+
+void taskPlanRegister(TaskId id, TaskHandle_t handle);
+uint8_t taskPlanReport();
+size_t taskPlanRegisteredCount();
+const RegisteredTask &taskPlanRegistered(size_t index);
+
+#endif // TASK_PLAN_H
@@ -0,0 +1,43 @@
+/**
+ * @file telemetry_manager.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "telemetry_manager.h"
+
+#include "esp_now_manager.h"
+
+// Latest values of all fields, written by the tasks that own them
+volatile int32_t telemetryValues[TLM_FIELD_COUNT];
+
+TelemetryEncoder telemetryEncoder;
+
+/**
+ * @brief Update a telemetry field. The value is sent with the next frame.
+ * @note This function may be called from any task, a 32-bit write is atomic.
+ */
+void telemetrySet(TelemetryField field, int32_t value)
+{
+    if (field < TLM_FIELD_COUNT)
+        telemetryValues[field] = value;
+}
+
+/**
+ * @brief Encode the current values and send them to the Controller.
+ * @note This function should be called from one task only, the encoder keeps the keyframe state.
+ */
+void telemetrySend()
+{
+    int32_t values[TLM_FIELD_COUNT];
+    uint8_t frame[TELEMETRY_MAX_SIZE];
+
+    for (uint8_t i = 0; i < TLM_FIELD_COUNT; i++)
+        values[i] = telemetryValues[i];
+
+    size_t len = telemetryEncoder.encode(values, frame);
+    sendDataToController(frame, len);
+}
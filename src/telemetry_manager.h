@@ -0,0 +1,20 @@
+/**
+ * @file telemetry_manager.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef TELEMETRY_MANAGER_H
+#define TELEMETRY_MANAGER_H
+
+#include <Arduino.h>
+
+#include "telemetry.h"
+
+void telemetrySet(TelemetryField field, int32_t value);
+void telemetrySend();
+
+#endif // TELEMETRY_MANAGER_H
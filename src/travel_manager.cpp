@@ -0,0 +1,93 @@
+/**
+ * @file travel_manager.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "travel_manager.h"
+#include <Preferences.h>
+#include <seqlock.h>
+
+#include "logger.h"
+#include "machine_config.h"
+
+// NVS storage parameters
+#define TRAVEL_NVS_NAMESPACE "travel"
+#define TRAVEL_NVS_KEY       "mixer"
+
+// Written by the shell, read by the control path without locking
+Seqlock<TravelMixerConfig> travelConfig;
+
+const char *_travelModeToString(TravelMode mode)
+{
+    return mode == TRAVEL_MODE_MIXED ? "mixed" : "tank";
+}
+
+/**
+ * @brief Load the stored mixer configuration from the NVS, or use the defaults.
+ * @note This function should be called once during the setup phase, before the control task starts.
+ */
+void travelInit()
+{
+    TravelMixerConfig config = TRAVEL_MIXER_DEFAULTS;
+    Preferences prefs;
+
+    if (prefs.begin(TRAVEL_NVS_NAMESPACE, true))
+    {
+        TravelMixerConfig stored;
+        if (prefs.getBytes(TRAVEL_NVS_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+            travelMixerConfigValid(stored))
+            config = stored;
+        prefs.end();
+    }
+
+    travelConfig.write(config);
+}
+
+/**
+ * @brief Replace the travel lever positions with the track speeds.
+ *
+ * @param levers Lever positions, the travel levers are changed in place.
+ */
+void travelMixLevers(int16_t levers[LEVERS_COUNT])
+{
+    travelMix(travelConfig.read(), levers[LEFT_TRAVEL_LEVER], levers[RIGHT_TRAVEL_LEVER]);
+}
+
+TravelMixerConfig travelGetConfig()
+{
+    return travelConfig.read();
+}
+
+/**
+ * @brief Apply and store a new mixer configuration.
+ * @note Must be called from one task only, e.g. the shell.
+ *
+ * @return false if the configuration is invalid or could not be stored. A valid configuration
+ * is applied even if it could not be stored.
+ */
+bool travelSetConfig(const TravelMixerConfig &config)
+{
+    if (!travelMixerConfigValid(config))
+        return false;
+
+    travelConfig.write(config);
+
+    Preferences prefs;
+    if (!prefs.begin(TRAVEL_NVS_NAMESPACE, false))
+        return false;
+    bool stored = prefs.putBytes(TRAVEL_NVS_KEY, &config, sizeof(config)) == sizeof(config);
+    prefs.end();
+    return stored;
+}
+
+void travelPrintConfig()
+{
+    TravelMixerConfig config = travelConfig.read();
+    logPrintf("Travel: %s mode, trim %u/%u, counter-rotation max %d, straight band %d\n",
+              _travelModeToString(config.mode), config.trimLeft, config.trimRight, config.counterRotationMax,
+              config.straightBand);
+}
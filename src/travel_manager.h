@@ -0,0 +1,24 @@
+/**
+ * @file travel_manager.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef TRAVEL_MANAGER_H
+#define TRAVEL_MANAGER_H
+
+#include <Arduino.h>
+
+#include "constants.h"
+#include "travel_mixer.h"
+
+void travelInit();
+void travelMixLevers(int16_t levers[LEVERS_COUNT]);
+TravelMixerConfig travelGetConfig();
+bool travelSetConfig(const TravelMixerConfig &config);
+void travelPrintConfig();
+
+#endif // TRAVEL_MANAGER_H
@@ -0,0 +1,72 @@
+/**
+ * @file travel_mixer.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "travel_mixer.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Scale both tracks by the same factor, so the larger one does not exceed the limit.
+ * The ratio of the tracks, i.e. the turn radius, is kept.
+ */
+void _scaleToLimit(int16_t &left, int16_t &right, int16_t limit)
+{
+    int32_t largest = abs(left) > abs(right) ? abs(left) : abs(right);
+    if (largest <= limit)
+        return;
+
+    left = (int32_t)left * limit / largest;
+    right = (int32_t)right * limit / largest;
+}
+
+/**
+ * @brief Check a configuration, e.g. one loaded from the NVS.
+ */
+bool travelMixerConfigValid(const TravelMixerConfig &config)
+{
+    return config.mode < TRAVEL_MODE_COUNT && config.trimLeft <= TRAVEL_TRIM_FULL &&
+           config.trimRight <= TRAVEL_TRIM_FULL && config.counterRotationMax >= 0 &&
+           config.counterRotationMax <= TRAVEL_MAX_SPEED && config.straightBand >= 0 &&
+           config.straightBand <= TRAVEL_MAX_SPEED;
+}
+
+/**
+ * @brief Turn the travel lever positions into the track speeds.
+ *
+ * In the mixed mode the left lever sets the speed and the right lever the steering. Small steering,
+ * or in the tank mode a small difference of the levers moving in the same direction, is treated as
+ * straight travel, so both tracks get the same command. The tracks are limited while they turn in
+ * opposite directions, then the trim slows down the faster track to compensate the motor mismatch.
+ *
+ * @param config Mixer configuration.
+ * @param left Input: left lever or throttle, output: left track speed, in the range of -255 to 255.
+ * @param right Input: right lever or steering, output: right track speed, in the range of -255 to 255.
+ */
+void travelMix(const TravelMixerConfig &config, int16_t &left, int16_t &right)
+{
+    if (config.mode == TRAVEL_MODE_MIXED)
+    {
+        int16_t throttle = left;
+        int16_t steer = abs(right) <= config.straightBand ? 0 : right;
+
+        left = throttle + steer;
+        right = throttle - steer;
+        _scaleToLimit(left, right, TRAVEL_MAX_SPEED);
+    }
+    else if ((left > 0) == (right > 0) && left != 0 && right != 0 && abs(left - right) <= config.straightBand)
+    {
+        left = right = (left + right) / 2;
+    }
+
+    if ((left > 0 && right < 0) || (left < 0 && right > 0))
+        _scaleToLimit(left, right, config.counterRotationMax);
+
+    left = (int32_t)left * config.trimLeft / TRAVEL_TRIM_FULL;
+    right = (int32_t)right * config.trimRight / TRAVEL_TRIM_FULL;
+}
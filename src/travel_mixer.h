@@ -0,0 +1,45 @@
+/**
+ * @file travel_mixer.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef TRAVEL_MIXER_H
+#define TRAVEL_MIXER_H
+
+#include <stdint.h>
+
+#define TRAVEL_MAX_SPEED  255
+#define TRAVEL_TRIM_FULL  1000 // Trim of a track that is not slowed down, permille
+
+// How the two travel levers are turned into the track commands
+enum TravelMode : uint8_t
+{
+    TRAVEL_MODE_TANK,  // Each lever drives its own track
+    TRAVEL_MODE_MIXED, // Left lever is the throttle, right lever the steering
+    // Total number of modes
+    TRAVEL_MODE_COUNT
+};
+
+struct TravelMixerConfig
+{
+    TravelMode mode;
+    uint16_t trimLeft;          // Scale of the left track, permille up to TRAVEL_TRIM_FULL
+    uint16_t trimRight;         // Scale of the right track, permille up to TRAVEL_TRIM_FULL
+    int16_t counterRotationMax; // Track speed limit while the tracks turn in opposite directions
+    int16_t straightBand;       // Steering, or the track difference in the tank mode, treated as straight
+};
+
+constexpr TravelMixerConfig TRAVEL_MIXER_DEFAULTS = {.mode = TRAVEL_MODE_TANK,
+    .trimLeft = TRAVEL_TRIM_FULL,
+    .trimRight = TRAVEL_TRIM_FULL,
+    .counterRotationMax = 160,
+    .straightBand = 24};
+
+bool travelMixerConfigValid(const TravelMixerConfig &config);
+void travelMix(const TravelMixerConfig &config, int16_t &left, int16_t &right);
+
+#endif // TRAVEL_MIXER_H
@@ -10,60 +10,347 @@
 #include "wifi_ota_manager.h"
 #include <WiFi.h>
 #include <ArduinoOTA.h>
+#include <Preferences.h>
+
+#include <esp_ota_ops.h>
+#include <esp_image_format.h>
 
 #include "constants.h"
+#include "esp_now_manager.h"
+#include "lights.h"
+#include "logger.h"
+#include "pwm_controller.h"
+#include "radio_manager.h"
+#include "supervisor.h"
+#include "task_plan.h"
+
+// NVS storage of the OTA password provisioned at runtime
+#define OTA_NVS_NAMESPACE    "ota"
+#define OTA_NVS_PASSWORD     "password"
+#define OTA_PASSWORD_MAX_LEN 64
+
+#define OTA_REBOOT_DELAY_MS 100 // Time to flush the logs before reboot
+
+
+OtaStateMachine otaStateMachine;
+ota_park_cb_t otaParkCallback = NULL;
+volatile bool otaRequested = false;
+
+/**
+ * @brief Defer the confirmation of a new firmware until the self-test passes.
+ * Overrides the weak function of the Arduino core that confirms the firmware right after boot.
+ */
+extern "C" bool verifyRollbackLater()
+{
+    return true;
+}
 
 // Callback function to handle WiFi connection event
 void onWiFiConnected(WiFiEvent_t event, WiFiEventInfo_t info)
 {
-    Serial.println("Connected to WiFi: " + WiFi.SSID());
+    logPrintf("Connected to WiFi: %.*s\n", info.wifi_sta_connected.ssid_len,
+              reinterpret_cast<const char *>(info.wifi_sta_connected.ssid));
 }
 
 // Callback function to handle IP address assignment event
 void onWiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info)
 {
-    Serial.println("Got IP address: " + WiFi.localIP().toString());
+    // The address is stored in the network byte order
+    const uint8_t *ip = reinterpret_cast<const uint8_t *>(&info.got_ip.ip_info.ip.addr);
+    logPrintf("Got IP address: %u.%u.%u.%u\n", ip[0], ip[1], ip[2], ip[3]);
 }
 
 // Callback function to handle WiFi disconnection event
 void onWiFiDisconnected(WiFiEvent_t event, WiFiEventInfo_t info)
 {
-    Serial.println("Disconnected from WiFi: " + String(reinterpret_cast<char *>(info.wifi_sta_disconnected.ssid)));
+    logPrintf("Disconnected from WiFi: %.*s\n", info.wifi_sta_disconnected.ssid_len,
+              reinterpret_cast<const char *>(info.wifi_sta_disconnected.ssid));
 }
 
 // Setup Wi-Fi connection
 void setupWiFi()
 {
+    static bool handlersRegistered = false;
+
     // Register WiFi event handlers
-    WiFi.onEvent(onWiFiConnected, ARDUINO_EVENT_WIFI_STA_CONNECTED);
-    WiFi.onEvent(onWiFiGotIP, ARDUINO_EVENT_WIFI_STA_GOT_IP);
-    WiFi.onEvent(onWiFiDisconnected, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    if (!handlersRegistered)
+    {
+        handlersRegistered = true;
+        WiFi.onEvent(onWiFiConnected, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+        WiFi.onEvent(onWiFiGotIP, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+        WiFi.onEvent(onWiFiDisconnected, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    }
 
     // Bugfix for setting the hostname. More info: https://github.com/espressif/arduino-esp32/issues/3438
     WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE, INADDR_NONE);
     WiFi.hostname(HOSTNAME);
 
-    // Set device as a Wi-Fi Station
-    WiFi.mode(WIFI_AP_STA);
+    // Set device as a Wi-Fi Station. The soft AP is not needed and would only add beacons.
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
 }
 
-// Setup Arduino OTA (Over-The-Air) update
-void setupOTA()
+// Disconnect from the Wi-Fi access point and stop reconnecting, the station stays up for ESP-NOW
+void stopWiFi()
 {
+    WiFi.setAutoReconnect(false);
+    WiFi.disconnect(false);
+}
+
+/**
+ * @brief Verify the written image. The image is read back from the flash in chunks and its SHA-256
+ * is compared with the digest appended to the image by the build.
+ *
+ * @return true if the image is valid.
+ */
+bool _verifyNewImage()
+{
+    // Update.end() has already selected the new partition for the next boot
+    const esp_partition_t *partition = esp_ota_get_boot_partition();
+    if (!partition || partition == esp_ota_get_running_partition())
+        return false;
+
+    esp_partition_pos_t pos = {.offset = partition->address, .size = partition->size};
+    esp_image_metadata_t metadata;
+    return esp_image_verify(ESP_IMAGE_VERIFY, &pos, &metadata) == ESP_OK;
+}
+
+void _onOtaStart()
+{
+    if (!otaStateMachine.begin())
+        return;
+
+    // The update blocks this task until it ends
+    supervisorPause();
+
+    // Stop all motors before the flash writes start stalling the tasks
+    if (otaParkCallback)
+        otaParkCallback();
+    lightsSetDimmed(true);
+    logPrintf("OTA update started, actuators parked\n");
+}
+
+void _onOtaProgress(unsigned int done, unsigned int total)
+{
+    otaStateMachine.progress(done, total);
+}
+
+void _onOtaEnd()
+{
+    if (!otaStateMachine.end())
+        return;
+
+    bool valid = _verifyNewImage();
+    otaStateMachine.verified(valid);
+
+    if (valid)
+    {
+        logPrintf("OTA update finished, image verified, rebooting\n");
+        delay(OTA_REBOOT_DELAY_MS);
+        esp_restart();
+    }
+
+    // Keep booting the running firmware
+    esp_ota_set_boot_partition(esp_ota_get_running_partition());
+    lightsSetDimmed(false);
+    supervisorResume();
+    logPrintf("OTA image verification failed\n");
+}
+
+void _onOtaError(ota_error_t error)
+{
+    otaStateMachine.error();
+    lightsSetDimmed(false);
+    supervisorResume();
+    logPrintf("OTA update failed: error %d\n", error);
+}
+
+// Start Arduino OTA (Over-The-Air) update service
+void _beginOTA()
+{
+    static char password[OTA_PASSWORD_MAX_LEN + 1] = OTA_PASSWORD;
+    Preferences prefs;
+
+    // Use the provisioned password, the compile-time one is only a fallback
+    if (prefs.begin(OTA_NVS_NAMESPACE, true))
+    {
+        if (prefs.isKey(OTA_NVS_PASSWORD))
+        {
+            size_t len = prefs.getBytes(OTA_NVS_PASSWORD, password, OTA_PASSWORD_MAX_LEN);
+            password[len] = '\0';
+        }
+        prefs.end();
+    }
+
     // Arduino OTA initializing
     ArduinoOTA.setHostname(HOSTNAME);
-    ArduinoOTA.setPassword(OTA_PASSWORD);
+    ArduinoOTA.setPassword(password);
+
+    // The reboot is done after the image verification
+    ArduinoOTA.setRebootOnSuccess(false);
 
     // Callback functions for OTA events
-    ArduinoOTA.onStart([]()
-                       { Serial.println("OTA update started"); });
-    ArduinoOTA.onEnd([]()
-                     { Serial.println("OTA update finished"); });
+    ArduinoOTA.onStart(_onOtaStart);
+    ArduinoOTA.onProgress(_onOtaProgress);
+    ArduinoOTA.onEnd(_onOtaEnd);
+    ArduinoOTA.onError(_onOtaError);
     ArduinoOTA.begin();
 }
 
-void handleOTA()
+/**
+ * @brief Run the self-test of a new firmware that is not confirmed yet.
+ * The firmware is confirmed when the PWM expander is reachable and ESP-NOW is up,
+ * otherwise the bootloader rolls back to the previous firmware.
+ */
+void _handleSelfTest()
+{
+    if (otaStateMachine.state() != OTA_SELF_TEST)
+        return;
+
+    switch (otaStateMachine.selfTestTick(millis(), pwmIsExpanderReady(), espNowIsReady()))
+    {
+        case OTA_IDLE:
+            esp_ota_mark_app_valid_cancel_rollback();
+            logPrintf("OTA self-test passed, firmware confirmed\n");
+            break;
+        case OTA_ROLLING_BACK:
+            logPrintf("OTA self-test failed (expander: %d, ESP-NOW: %d), rolling back\n",
+                      pwmIsExpanderReady(), espNowIsReady());
+            esp_ota_mark_app_invalid_rollback_and_reboot();
+            break;
+        default:
+            break;
+    }
+}
+
+// Task memory is allocated statically
+StackType_t otaTaskStack[TASK_PLAN[TASK_OTA].stackSize];
+StaticTask_t otaTaskBuffer;
+
+/**
+ * @brief Task function for the OTA service.
+ *
+ * The OTA update runs in this task, so it does not block the loop function. The OTA service is
+ * started and stopped here on request, ArduinoOTA is never accessed from other tasks.
+ *
+ * @param pvParameters A pointer to task parameters (not used in this function).
+ */
+void otaTask(void *pvParameters)
+{
+    const TickType_t xFrequency = pdMS_TO_TICKS(TASK_PLAN[TASK_OTA].periodMs);
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    bool otaStarted = false;
+
+    // Check if this is the first boot of a new firmware
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    esp_ota_img_states_t imageState;
+    if (esp_ota_get_state_partition(running, &imageState) == ESP_OK && imageState == ESP_OTA_IMG_PENDING_VERIFY)
+        otaStateMachine.startSelfTest(millis());
+
+    Serial.println("otaTask started");
+
+    // Main task loop
+    for (;;)
+    {
+        if (otaRequested && !otaStarted)
+        {
+            _beginOTA();
+            otaStarted = true;
+        }
+        else if (!otaRequested && otaStarted)
+        {
+            ArduinoOTA.end();
+            otaStarted = false;
+        }
+
+        // Blocks for the whole duration of an update
+        if (otaStarted)
+            ArduinoOTA.handle();
+
+        _handleSelfTest();
+
+        // Radio profile changes start and stop the Wi-Fi, so they are applied here on core 0
+        handleRadio();
+
+        supervisorFeed();
+
+        // Wait for the next cycle.
+        xTaskDelayUntil(&xLastWakeTime, xFrequency);
+    }
+}
+
+/**
+ * @brief Initializes the OTA task.
+ *
+ * @param parkCallback Function that stops all actuators when an update starts.
+ *
+ * @note This function should be called once during the setup phase of the program.
+ */
+void otaTaskInit(ota_park_cb_t parkCallback)
 {
-    ArduinoOTA.handle();
-}
\ No newline at end of file
+    otaParkCallback = parkCallback;
+
+    TaskHandle_t task = xTaskCreateStaticPinnedToCore(otaTask,
+                                                     TASK_PLAN[TASK_OTA].name,
+                                                     TASK_PLAN[TASK_OTA].stackSize,
+                                                     NULL,
+                                                     TASK_PLAN[TASK_OTA].priority,
+                                                     otaTaskStack,
+                                                     &otaTaskBuffer,
+                                                     TASK_PLAN[TASK_OTA].core);
+    if (task == NULL)
+    {
+        Serial.println("Failed to create otaTask");
+    }
+    taskPlanRegister(TASK_OTA, task);
+}
+
+// Enable the OTA service, it is started by the OTA task
+void setupOTA()
+{
+    otaRequested = true;
+}
+
+// Disable the OTA service, an update in progress is not interrupted
+void stopOTA()
+{
+    otaRequested = false;
+}
+
+bool otaActuatorsParked()
+{
+    return otaStateMachine.actuatorsParked();
+}
+
+OtaState otaGetState()
+{
+    return otaStateMachine.state();
+}
+
+uint8_t otaGetProgress()
+{
+    return otaStateMachine.progressPercent();
+}
+
+/**
+ * @brief Store a new OTA password in the NVS.
+ * @note The password takes effect after reboot.
+ *
+ * @param password The new password.
+ * @return true if the password was stored.
+ */
+bool setOtaPassword(const char *password)
+{
+    size_t len = strlen(password);
+    if (len == 0 || len > OTA_PASSWORD_MAX_LEN)
+        return false;
+
+    Preferences prefs;
+    if (!prefs.begin(OTA_NVS_NAMESPACE, false))
+        return false;
+
+    bool stored = prefs.putBytes(OTA_NVS_PASSWORD, password, len) == len;
+    prefs.end();
+    return stored;
+}
@@ -10,8 +10,19 @@
 #ifndef WIFI_OTA_MANAGER_H
 #define WIFI_OTA_MANAGER_H
 
+#include "ota_state_machine.h"
+
+// Stops all actuators
+typedef void (*ota_park_cb_t)(void);
+
 void setupWiFi();
+void stopWiFi();
+void otaTaskInit(ota_park_cb_t parkCallback);
 void setupOTA();
-void handleOTA();
+void stopOTA();
+bool otaActuatorsParked();
+OtaState otaGetState();
+uint8_t otaGetProgress();
+bool setOtaPassword(const char *password);
 
 #endif // WIFI_OTA_MANAGER_H
\ No newline at end of file
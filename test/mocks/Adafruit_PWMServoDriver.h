@@ -0,0 +1,76 @@
+/**
+ * @file Adafruit_PWMServoDriver.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MOCK_ADAFRUIT_PWM_SERVO_DRIVER_H
+#define MOCK_ADAFRUIT_PWM_SERVO_DRIVER_H
+
+#include <Wire.h>
+
+/*
+ * Host mock of the PCA9685 driver library. The initialization is written to the mocked bus like the
+ * library does it: a reset, then the prescaler and the auto-increment mode, so an absent device fails it.
+ */
+
+#define PCA9685_MODE1     0x00
+#define PCA9685_PRESCALE  0xFE
+#define MODE1_RESTART     0x80
+#define MODE1_AI          0x20
+#define MODE1_SLEEP       0x10
+#define PCA9685_OSC_HZ    25000000
+#define PCA9685_PRESCALE_MIN 3
+
+class Adafruit_PWMServoDriver
+{
+public:
+    Adafruit_PWMServoDriver(uint8_t address = 0x40, TwoWire &wire = Wire) : _address(address), _wire(&wire) {}
+
+    bool begin(uint8_t prescale = 0)
+    {
+        begins++;
+        reset();
+        return true;
+    }
+
+    void reset() { _write8(PCA9685_MODE1, MODE1_RESTART); }
+
+    void setPWMFreq(float frequency)
+    {
+        float prescale = PCA9685_OSC_HZ / (frequency * 4096.0f) - 1.0f + 0.5f;
+        uint8_t value = (uint8_t)constrain(prescale, (float)PCA9685_PRESCALE_MIN, 255.0f);
+
+        _write8(PCA9685_MODE1, MODE1_SLEEP);
+        _write8(PCA9685_PRESCALE, value);
+        _write8(PCA9685_MODE1, MODE1_RESTART | MODE1_AI);
+    }
+
+    uint8_t setPWM(uint8_t pin, uint16_t on, uint16_t off)
+    {
+        const uint8_t data[] = {(uint8_t)(0x06 + 4 * pin), (uint8_t)on, (uint8_t)(on >> 8), (uint8_t)off,
+                                (uint8_t)(off >> 8)};
+        _wire->beginTransmission(_address);
+        _wire->write(data, sizeof(data));
+        return _wire->endTransmission();
+    }
+
+    uint32_t begins = 0;
+
+private:
+    void _write8(uint8_t reg, uint8_t value)
+    {
+        _wire->beginTransmission(_address);
+        _wire->write(reg);
+        _wire->write(value);
+        _wire->endTransmission();
+    }
+
+    uint8_t _address;
+    TwoWire *_wire;
+};
+
+#endif // MOCK_ADAFRUIT_PWM_SERVO_DRIVER_H
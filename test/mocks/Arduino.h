@@ -0,0 +1,356 @@
+/**
+ * @file Arduino.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+/*
+ * Host mock of the Arduino core, the ESP-IDF and the FreeRTOS APIs used by the firmware modules that
+ * are built in the native environment. The time, the GPIO levels and the LEDC duties are plain
+ * variables the tests set and check. Tasks are never started and the critical sections are empty,
+ * the tests run the firmware code from one thread.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+using std::max;
+using std::min;
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+#define HIGH 1
+#define LOW  0
+
+#define INPUT             0x01
+#define OUTPUT            0x03
+#define INPUT_PULLUP      0x05
+#define OUTPUT_OPEN_DRAIN 0x12
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define MOCK_GPIO_COUNT 40
+#define MOCK_LEDC_COUNT 16
+
+typedef enum
+{
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7,
+    GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15,
+    GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_22, GPIO_NUM_23,
+    GPIO_NUM_24, GPIO_NUM_25, GPIO_NUM_26, GPIO_NUM_27, GPIO_NUM_28, GPIO_NUM_29, GPIO_NUM_30, GPIO_NUM_31,
+    GPIO_NUM_32, GPIO_NUM_33, GPIO_NUM_34, GPIO_NUM_35, GPIO_NUM_36, GPIO_NUM_37, GPIO_NUM_38, GPIO_NUM_39
+} gpio_num_t;
+
+// Mocked time, advanced by the tests
+inline uint32_t mockMicros = 0;
+
+// Mocked GPIO levels and LEDC duties
+inline uint8_t mockGpioLevels[MOCK_GPIO_COUNT] = {};
+inline uint8_t mockGpioModes[MOCK_GPIO_COUNT] = {};
+inline uint32_t mockLedcDuty[MOCK_LEDC_COUNT] = {};
+inline uint32_t mockLedcWrites = 0;
+
+// Optional hooks of the GPIO accesses, e.g. a device on a bit-banged bus
+inline void (*mockGpioWriteHook)(uint8_t pin, uint8_t value) = NULL;
+inline int (*mockGpioReadHook)(uint8_t pin) = NULL;
+
+// Attached interrupts
+inline void (*mockIsr[MOCK_GPIO_COUNT])(void *) = {};
+inline void *mockIsrArg[MOCK_GPIO_COUNT] = {};
+
+inline uint32_t micros() { return mockMicros; }
+inline uint32_t millis() { return mockMicros / 1000; }
+inline int64_t esp_timer_get_time() { return mockMicros; }
+inline void delay(uint32_t ms) { mockMicros += ms * 1000; }
+inline void delayMicroseconds(uint32_t us) { mockMicros += us; }
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < MOCK_GPIO_COUNT)
+        mockGpioModes[pin] = mode;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < MOCK_GPIO_COUNT)
+        mockGpioLevels[pin] = value;
+    if (mockGpioWriteHook)
+        mockGpioWriteHook(pin, value);
+}
+
+inline int digitalRead(uint8_t pin)
+{
+    if (mockGpioReadHook)
+        return mockGpioReadHook(pin);
+    return pin < MOCK_GPIO_COUNT ? mockGpioLevels[pin] : LOW;
+}
+
+inline int gpio_get_level(gpio_num_t pin) { return digitalRead(pin); }
+inline int gpio_set_level(gpio_num_t pin, uint32_t level)
+{
+    digitalWrite(pin, level);
+    return 0;
+}
+
+#define digitalPinToInterrupt(pin) (pin)
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode)
+{
+    if (pin < MOCK_GPIO_COUNT)
+    {
+        mockIsr[pin] = isr;
+        mockIsrArg[pin] = arg;
+    }
+}
+
+inline void detachInterrupt(uint8_t pin)
+{
+    if (pin < MOCK_GPIO_COUNT)
+        mockIsr[pin] = NULL;
+}
+
+// Set the pin level and call its interrupt like an edge on the pin
+inline void mockGpioEdge(uint8_t pin, uint8_t level)
+{
+    mockGpioLevels[pin] = level;
+    if (mockIsr[pin])
+        mockIsr[pin](mockIsrArg[pin]);
+}
+
+inline double ledcSetup(uint8_t channel, double frequency, uint8_t resolution) { return frequency; }
+inline void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+inline void ledcWrite(uint8_t channel, uint32_t duty)
+{
+    if (channel < MOCK_LEDC_COUNT)
+        mockLedcDuty[channel] = duty;
+    mockLedcWrites++;
+}
+
+// FreeRTOS
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t;
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct
+{
+    uint8_t reserved[64];
+} StaticTask_t;
+
+typedef struct
+{
+    int owner;
+} portMUX_TYPE;
+
+#define pdFALSE            0
+#define pdTRUE             1
+#define pdPASS             1
+#define portMAX_DELAY      0xFFFFFFFF
+#define portTICK_PERIOD_MS 1
+#define tskIDLE_PRIORITY   0
+#define tskNO_AFFINITY     0x7FFFFFFF
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux)      ((void)(mux))
+#define portEXIT_CRITICAL(mux)       ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)  ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)   ((void)(mux))
+#define portYIELD_FROM_ISR()
+
+// Handle of the task the tests pretend to run in, and the notifications given to each task
+#define MOCK_TASK_COUNT 16
+inline StaticTask_t *mockTasks[MOCK_TASK_COUNT] = {};
+inline uint32_t mockTaskNotifications[MOCK_TASK_COUNT] = {};
+inline TaskHandle_t mockCurrentTask = NULL;
+
+inline int mockTaskIndex(TaskHandle_t task)
+{
+    for (int i = 0; i < MOCK_TASK_COUNT; i++)
+    {
+        if (mockTasks[i] != NULL && mockTasks[i] == task)
+            return i;
+    }
+    return -1;
+}
+
+// Tasks are registered, never started
+inline TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize,
+                                                  void *parameters, UBaseType_t priority, StackType_t *stack,
+                                                  StaticTask_t *buffer, BaseType_t core)
+{
+    for (int i = 0; i < MOCK_TASK_COUNT; i++)
+    {
+        if (mockTasks[i] == NULL || mockTasks[i] == buffer)
+        {
+            mockTasks[i] = buffer;
+            mockTaskNotifications[i] = 0;
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return mockCurrentTask; }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    int index = mockTaskIndex(task);
+    if (index >= 0)
+        mockTaskNotifications[index]++;
+    return pdPASS;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if (woken)
+        *woken = pdFALSE;
+}
+
+// Take the notifications of the current task, the time passes only when there are none
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    int index = mockTaskIndex(mockCurrentTask);
+    uint32_t count = index >= 0 ? mockTaskNotifications[index] : 0;
+    if (count == 0)
+    {
+        mockMicros += ticks * 1000;
+        return 0;
+    }
+    mockTaskNotifications[index] = clear ? 0 : count - 1;
+    return count;
+}
+
+inline TickType_t xTaskGetTickCount() { return millis(); }
+inline BaseType_t xTaskDelayUntil(TickType_t *lastWake, TickType_t ticks)
+{
+    *lastWake += ticks;
+    return pdTRUE;
+}
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+// Queue with the copy semantics of FreeRTOS: the items are copied in and out under a spinlock, like
+// the critical section of the ESP-IDF port. Nothing blocks, a full or an empty queue fails at once.
+struct MockQueue
+{
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+    uint8_t *items;
+    UBaseType_t length, itemSize, head, count;
+};
+typedef MockQueue *QueueHandle_t;
+
+#define errQUEUE_FULL  0
+#define errQUEUE_EMPTY 0
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    QueueHandle_t queue = new MockQueue;
+    queue->items = new uint8_t[length * itemSize];
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+inline void vQueueDelete(QueueHandle_t queue)
+{
+    delete[] queue->items;
+    delete queue;
+}
+
+inline BaseType_t _mockQueuePut(QueueHandle_t queue, const void *item, bool overwrite)
+{
+    while (queue->lock.test_and_set(std::memory_order_acquire))
+        ;
+    BaseType_t result = errQUEUE_FULL;
+    if (overwrite)
+        queue->count = 0;
+    if (queue->count < queue->length)
+    {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + tail * queue->itemSize, item, queue->itemSize);
+        queue->count++;
+        result = pdPASS;
+    }
+    queue->lock.clear(std::memory_order_release);
+    return result;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    return _mockQueuePut(queue, item, false);
+}
+
+// Replace the item of a queue of length one, the mailbox pattern
+inline BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    return _mockQueuePut(queue, item, true);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    while (queue->lock.test_and_set(std::memory_order_acquire))
+        ;
+    BaseType_t result = errQUEUE_EMPTY;
+    if (queue->count > 0)
+    {
+        memcpy(item, queue->items + queue->head * queue->itemSize, queue->itemSize);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        result = pdPASS;
+    }
+    queue->lock.clear(std::memory_order_release);
+    return result;
+}
+
+// Serial port, the output is collected for the tests
+class HardwareSerial
+{
+public:
+    size_t write(const uint8_t *data, size_t len)
+    {
+        output.append((const char *)data, len);
+        return len;
+    }
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+    size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t println(const char *text = "") { return print(text) + print("\n"); }
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() {}
+
+    std::string output;
+};
+
+inline HardwareSerial Serial;
+
+#endif // MOCK_ARDUINO_H
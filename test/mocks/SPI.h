@@ -0,0 +1,15 @@
+/**
+ * @file SPI.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+// Included by the firmware for the expander library, nothing is used on the host
+
+#endif // MOCK_SPI_H
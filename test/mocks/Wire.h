@@ -0,0 +1,156 @@
+/**
+ * @file Wire.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MOCK_WIRE_H
+#define MOCK_WIRE_H
+
+#include <Arduino.h>
+
+/*
+ * Host mock of an I2C bus with PCA9685-like devices. Every write transaction sets the register pointer
+ * with its first byte and stores the rest with auto-increment. The bus time of a transaction is modeled
+ * from the clock frequency: start, address, data bytes with their ACK bits and stop. The mocked time
+ * advances by it, the exact sum is kept in busNs. Faults are injected by the tests: a device can be
+ * absent, NACK a number of transactions, or hold SDA low until the bus is cleared.
+ */
+
+#define MOCK_I2C_DEVICES       128
+#define MOCK_I2C_REGISTERS     256
+#define MOCK_I2C_BUFFER_LENGTH 128
+
+// Results of endTransmission() of the ESP32 core
+#define I2C_ERROR_OK      0
+#define I2C_ERROR_NACK    2 // Address or data NACK
+#define I2C_ERROR_TIMEOUT 5 // Bus is busy or locked
+
+class TwoWire
+{
+public:
+    TwoWire(uint8_t busNum) : busNum(busNum) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0)
+    {
+        if (frequency != 0)
+            clockHz = frequency;
+        sdaPin = sda;
+        sclPin = scl;
+        started = true;
+        begins++;
+        return true;
+    }
+
+    bool end()
+    {
+        started = false;
+        return true;
+    }
+
+    void setClock(uint32_t frequency) { clockHz = frequency; }
+    void setTimeOut(uint16_t timeOutMs) { timeoutMs = timeOutMs; }
+
+    void beginTransmission(uint8_t address)
+    {
+        txAddress = address & 0x7F;
+        txLength = 0;
+    }
+
+    size_t write(uint8_t data) { return write(&data, 1); }
+
+    size_t write(const uint8_t *data, size_t len)
+    {
+        size_t count = min(len, (size_t)(MOCK_I2C_BUFFER_LENGTH - txLength));
+        memcpy(txBuffer + txLength, data, count);
+        txLength += count;
+        return count;
+    }
+
+    uint8_t endTransmission(bool sendStop = true)
+    {
+        transactions++;
+
+        // A locked bus blocks the driver until its timeout
+        if (!started || sdaStuck)
+        {
+            _advance((uint64_t)timeoutMs * 1000000);
+            errors++;
+            return I2C_ERROR_TIMEOUT;
+        }
+
+        // An absent or failing device NACKs its address, the driver stops right after it
+        if (!present[txAddress] || nackCount[txAddress] > 0)
+        {
+            if (nackCount[txAddress] > 0)
+                nackCount[txAddress]--;
+            _advance(_bitsNs(1 + 9 + 1));
+            errors++;
+            return I2C_ERROR_NACK;
+        }
+
+        _advance(_bitsNs(1 + (1 + txLength) * 9 + 1));
+        bytes += txLength;
+        if (txLength > 0)
+        {
+            uint8_t reg = txBuffer[0];
+            for (size_t i = 1; i < txLength; i++)
+                registers[txAddress][reg++] = txBuffer[i];
+        }
+        return I2C_ERROR_OK;
+    }
+
+    uint8_t requestFrom(uint8_t address, uint8_t len) { return 0; }
+    int read() { return -1; }
+    int available() { return 0; }
+
+    // Register value of the device, LEDn_ON and LEDn_OFF are little endian pairs
+    uint16_t reg16(uint8_t address, uint8_t reg) const
+    {
+        return registers[address][reg] | (registers[address][(uint8_t)(reg + 1)] << 8);
+    }
+
+    uint8_t busNum;
+    uint32_t clockHz = 100000;
+    uint16_t timeoutMs = 50;
+    int sdaPin = -1;
+    int sclPin = -1;
+    bool started = false;
+
+    // Injected faults
+    bool present[MOCK_I2C_DEVICES] = {};
+    uint32_t nackCount[MOCK_I2C_DEVICES] = {};
+    bool sdaStuck = false;
+
+    // Statistics
+    uint32_t begins = 0;
+    uint32_t transactions = 0;
+    uint32_t errors = 0;
+    uint64_t bytes = 0;
+    uint64_t busNs = 0;
+
+    uint8_t registers[MOCK_I2C_DEVICES][MOCK_I2C_REGISTERS] = {};
+
+private:
+    uint64_t _bitsNs(uint32_t bits) const { return (uint64_t)bits * 1000000000ULL / clockHz; }
+
+    void _advance(uint64_t ns)
+    {
+        // The mocked time follows the sum, so the rounding does not accumulate
+        uint64_t before = busNs / 1000;
+        busNs += ns;
+        mockMicros += busNs / 1000 - before;
+    }
+
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[MOCK_I2C_BUFFER_LENGTH] = {};
+    size_t txLength = 0;
+};
+
+inline TwoWire Wire(0);
+inline TwoWire Wire1(1);
+
+#endif // MOCK_WIRE_H
@@ -0,0 +1,27 @@
+/**
+ * @file ledc_types.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef MOCK_HAL_LEDC_TYPES_H
+#define MOCK_HAL_LEDC_TYPES_H
+
+// Host mock of the ESP-IDF LEDC channel numbers
+typedef enum
+{
+    LEDC_CHANNEL_0,
+    LEDC_CHANNEL_1,
+    LEDC_CHANNEL_2,
+    LEDC_CHANNEL_3,
+    LEDC_CHANNEL_4,
+    LEDC_CHANNEL_5,
+    LEDC_CHANNEL_6,
+    LEDC_CHANNEL_7,
+    LEDC_CHANNEL_MAX
+} ledc_channel_t;
+
+#endif // MOCK_HAL_LEDC_TYPES_H
@@ -0,0 +1,41 @@
+/**
+ * @file fakes.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <Arduino.h>
+
+#include "event_loop.h"
+#include "pwm_controller.h"
+#include "supervisor.h"
+#include "task_plan.h"
+
+/*
+ * Firmware modules the benchmarked motor and lights code calls into. The PWM outputs are only stored,
+ * like the scheduler does before the writer task takes them, the tasks are not started.
+ */
+
+uint16_t fakePwmValues[256];
+
+void setPinPWM(uint8_t pin, uint16_t value)
+{
+    fakePwmValues[pin] = value;
+}
+
+void setMotorPwm(uint8_t posMotorPin, uint8_t negMotorPin, uint16_t posPinValue, uint16_t negPinValue)
+{
+    fakePwmValues[posMotorPin] = posPinValue;
+    fakePwmValues[negMotorPin] = negPinValue;
+}
+
+void eventLoopNotify() {}
+
+void eventLoopNotifyFromIsr() {}
+
+void supervisorFeed() {}
+
+void taskPlanRegister(TaskId id, TaskHandle_t handle) {}
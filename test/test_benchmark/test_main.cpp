@@ -0,0 +1,348 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <spsc_ring.h>
+#include <triple_buffer.h>
+#include <unity.h>
+
+#include "control_manager.h"
+#include "data_structures.h"
+#include "lights.h"
+#include "limit_debouncer.h"
+#include "link_security.h"
+#include "machine_config.h"
+#include "motor.h"
+#include "peer_arbiter.h"
+#include "pwm_scheduler.h"
+#include "travel_mixer.h"
+
+/*
+ * Host benchmarks of the receive-to-actuate path. The cases are the ones of the on-target benchmark
+ * in src/benchmark.cpp, built for the host with the hardware calls mocked. The results are printed as
+ * Google Benchmark JSON and written to the file named by the BENCHMARK_OUT environment variable,
+ * so two commits can be compared with its compare.py.
+ */
+
+// Passed by the native-benchmark environment
+#ifndef BENCHMARK_COMMIT
+#define BENCHMARK_COMMIT "unknown"
+#endif
+
+// Benchmark parameters
+#define BENCHMARK_WARMUP      1000
+#define BENCHMARK_BATCH       1000      // Iterations timed together, the clock is too coarse for one
+#define BENCHMARK_MIN_TIME_NS 200000000 // Minimum measured time of one case
+#define BENCHMARK_MAX_CASES   16
+
+struct BenchmarkCase
+{
+    const char *name;
+    void (*run)(uint32_t iteration);
+};
+
+struct BenchmarkResult
+{
+    const char *name;
+    uint64_t iterations;
+    double realNs; // Mean time of one iteration
+    double cpuNs;
+    double minNs; // Fastest and slowest batch, per iteration
+    double maxNs;
+};
+
+// Benchmarked motor of an expander axis
+Motor benchMotor(MACHINE_AXES[BOOM_AXIS]);
+
+// Receive path state, a copy of the one in esp_now_manager.cpp
+const uint8_t benchMac[PEER_MAC_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+PeerArbiter benchArbiter;
+ReplayWindow benchReplay;
+portMUX_TYPE benchMux = portMUX_INITIALIZER_UNLOCKED;
+controller_data_struct benchFrame;
+controller_data_struct benchParsed;
+uint32_t benchCounter = 0;
+
+PwmScheduler benchScheduler;
+LimitDebouncer benchDebouncer;
+
+// Handoffs of the commands to the control task, the lock-free ones of control_manager.cpp and the
+// FreeRTOS queues they replace
+TripleBuffer<ControlCommand> benchMailbox;
+SpscRing<ControlCommand, CONTROL_COMMAND_QUEUE_SIZE> benchRing;
+QueueHandle_t benchQueueMailbox = NULL;
+QueueHandle_t benchQueue = NULL;
+ControlCommand benchCommand = {CONTROL_COMMAND_AXIS, 0, 0, {}};
+
+// Results are accumulated here, so the compiler can't remove the benchmarked code
+volatile uint32_t benchSink = 0;
+
+const int16_t BENCH_SPEEDS[] = {0, 64, 128, 255, -32, -128, -255, 16};
+
+BenchmarkResult benchResults[BENCHMARK_MAX_CASES];
+size_t benchResultsCount = 0;
+
+/**
+ * @brief Filter and copy a Controller frame like the ESP-NOW receive callback.
+ */
+void _benchFrameParse(uint32_t iteration)
+{
+    benchFrame.counter = ++benchCounter;
+    const uint8_t *data = (const uint8_t *)&benchFrame;
+
+    portENTER_CRITICAL(&benchMux);
+    int index = benchArbiter.findPeer(benchMac);
+    portEXIT_CRITICAL(&benchMux);
+
+    uint32_t epoch, counter;
+    memcpy(&epoch, data + offsetof(controller_data_struct, epoch), sizeof(epoch));
+    memcpy(&counter, data + offsetof(controller_data_struct, counter), sizeof(counter));
+
+    portENTER_CRITICAL(&benchMux);
+    bool fresh = index >= 0 && benchReplay.check(epoch, counter);
+    PeerFrameResult result = fresh ? benchArbiter.onFrame(benchMac, millis()) : PEER_REJECTED_UNKNOWN;
+    portEXIT_CRITICAL(&benchMux);
+
+    if (result == PEER_ACCEPTED || result == PEER_ACCEPTED_HANDOVER)
+        memcpy(&benchParsed, data, sizeof(benchParsed));
+}
+
+void _benchTravelMix(uint32_t iteration)
+{
+    int16_t left = BENCH_SPEEDS[iteration % 8];
+    int16_t right = BENCH_SPEEDS[(iteration + 3) % 8];
+    travelMix(TRAVEL_MIXER_DEFAULTS, left, right);
+    benchSink = left + right;
+}
+
+void _benchMotorSetSpeed(uint32_t iteration)
+{
+    benchMotor.setSpeed(BENCH_SPEEDS[iteration % 8]);
+}
+
+/**
+ * @brief Update the limit switches and the position of a running motor, 1 ms apart.
+ */
+void _benchLimitUpdate(uint32_t iteration)
+{
+    mockMicros += 1000;
+    benchMotor.updateLimitSwitches(false);
+    benchMotor.updatePosition();
+}
+
+/**
+ * @brief Debounce a burst of five edges that ends on the opposite level.
+ */
+void _benchLimitBurst(uint32_t iteration)
+{
+    uint32_t start = iteration * 100000;
+    bool level = !benchDebouncer.state();
+
+    for (uint8_t i = 0; i < 5; i++)
+        benchDebouncer.edge(start + i * 300, i % 2 == 0 ? level : !level);
+    benchSink = benchDebouncer.update(start + 50000);
+}
+
+/**
+ * @brief Encode the changes of one motor and two lights into the expander bursts.
+ */
+void _benchPwmEncode(uint32_t iteration)
+{
+    uint16_t values[PWM_CHANNELS_PER_EXPANDER];
+    uint8_t buffer[PWM_BURST_BUFFER_SIZE];
+    uint8_t first = 0;
+    uint8_t count;
+
+    benchScheduler.set(14, iteration & 0xFFF);
+    benchScheduler.set(15, ~iteration & 0xFFF);
+    benchScheduler.set(0, iteration & 0x7FF);
+    benchScheduler.set(3, iteration & 0x3FF);
+    uint16_t mask = benchScheduler.take(0, values);
+
+    while (PwmScheduler::nextRun(mask, &first, &count))
+    {
+        benchSink = benchSink + PwmScheduler::encodeRun(values, benchScheduler.phases(0), first, count, buffer);
+        first += count;
+    }
+}
+
+/**
+ * @brief One cycle of the lights task, 20 ms apart so the blinking changes the targets.
+ */
+void _benchLightsTick(uint32_t iteration)
+{
+    mockMicros += 20000;
+    lightsTick();
+}
+
+/**
+ * @brief Hand a command over and take it back, the producer and the consumer sides of one handoff.
+ */
+void _benchHandoffTripleBuffer(uint32_t iteration)
+{
+    ControlCommand command = {};
+    benchCommand.speed = iteration;
+    benchMailbox.write(benchCommand);
+    benchMailbox.read(command);
+    benchSink = command.speed;
+}
+
+void _benchHandoffQueueOverwrite(uint32_t iteration)
+{
+    ControlCommand command = {};
+    benchCommand.speed = iteration;
+    xQueueOverwrite(benchQueueMailbox, &benchCommand);
+    xQueueReceive(benchQueueMailbox, &command, 0);
+    benchSink = command.speed;
+}
+
+void _benchHandoffSpscRing(uint32_t iteration)
+{
+    ControlCommand command = {};
+    benchCommand.speed = iteration;
+    benchRing.push(benchCommand);
+    benchRing.pop(command);
+    benchSink = command.speed;
+}
+
+void _benchHandoffQueue(uint32_t iteration)
+{
+    ControlCommand command = {};
+    benchCommand.speed = iteration;
+    xQueueSend(benchQueue, &benchCommand, 0);
+    xQueueReceive(benchQueue, &command, 0);
+    benchSink = command.speed;
+}
+
+const BenchmarkCase benchmarkCases[] = {
+    {"BM_FrameParse", _benchFrameParse},
+    {"BM_TravelMix", _benchTravelMix},
+    {"BM_MotorSetSpeed", _benchMotorSetSpeed},
+    {"BM_LimitUpdate", _benchLimitUpdate},
+    {"BM_LimitDebounceBurst", _benchLimitBurst},
+    {"BM_PwmEncode", _benchPwmEncode},
+    {"BM_LightsTick", _benchLightsTick},
+    {"BM_HandoffTripleBuffer", _benchHandoffTripleBuffer},
+    {"BM_HandoffQueueOverwrite", _benchHandoffQueueOverwrite},
+    {"BM_HandoffSpscRing", _benchHandoffSpscRing},
+    {"BM_HandoffQueue", _benchHandoffQueue},
+};
+
+/**
+ * @brief Run a case in timed batches until the minimum time is reached.
+ */
+BenchmarkResult _runCase(const BenchmarkCase &benchCase)
+{
+    using clock = std::chrono::steady_clock;
+
+    uint32_t iteration = 0;
+    for (; iteration < BENCHMARK_WARMUP; iteration++)
+        benchCase.run(iteration);
+
+    BenchmarkResult result = {benchCase.name, 0, 0, 0, 1e300, 0};
+    double totalNs = 0;
+    std::clock_t cpuStart = std::clock();
+
+    while (totalNs < BENCHMARK_MIN_TIME_NS)
+    {
+        clock::time_point start = clock::now();
+        for (uint32_t i = 0; i < BENCHMARK_BATCH; i++)
+            benchCase.run(iteration++);
+        double batchNs = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+        totalNs += batchNs;
+        result.iterations += BENCHMARK_BATCH;
+        result.minNs = min(result.minNs, batchNs / BENCHMARK_BATCH);
+        result.maxNs = max(result.maxNs, batchNs / BENCHMARK_BATCH);
+    }
+
+    result.realNs = totalNs / result.iterations;
+    result.cpuNs = (double)(std::clock() - cpuStart) * 1e9 / CLOCKS_PER_SEC / result.iterations;
+    return result;
+}
+
+void _printJson(FILE *out)
+{
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"host_name\": \"%s\",\n", HOSTNAME);
+    fprintf(out, "    \"executable\": \"native@%s\",\n", BENCHMARK_COMMIT);
+    fprintf(out, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(out, "    \"mhz_per_cpu\": 0,\n    \"cpu_scaling_enabled\": false,\n");
+    fprintf(out, "    \"library_build_type\": \"release\"\n  },\n  \"benchmarks\": [\n");
+
+    for (size_t i = 0; i < benchResultsCount; i++)
+    {
+        const BenchmarkResult &result = benchResults[i];
+        fprintf(out,
+                "    {\"name\": \"%s\", \"run_name\": \"%s\", \"run_type\": \"iteration\", "
+                "\"repetitions\": 1, \"repetition_index\": 0, \"threads\": 1, \"iterations\": %llu, "
+                "\"real_time\": %.2f, \"cpu_time\": %.2f, \"time_unit\": \"ns\", "
+                "\"min_ns\": %.2f, \"max_ns\": %.2f}%s\n",
+                result.name, result.name, (unsigned long long)result.iterations, result.realNs, result.cpuNs,
+                result.minNs, result.maxNs, i + 1 < benchResultsCount ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_control_path(void)
+{
+    // The boom motor runs on the mocked expander with its limit switches released
+    mockGpioLevels[MACHINE_AXES[BOOM_AXIS].posLimitPin] = HIGH;
+    mockGpioLevels[MACHINE_AXES[BOOM_AXIS].negLimitPin] = HIGH;
+    benchMotor.setupOutput();
+    benchMotor.setupLimitSwitches();
+
+    benchArbiter.addPeer(benchMac, PEER_PRIORITY_OPERATOR);
+    memset(&benchFrame, 0, sizeof(benchFrame));
+    benchQueueMailbox = xQueueCreate(1, sizeof(ControlCommand));
+    benchQueue = xQueueCreate(CONTROL_COMMAND_QUEUE_SIZE, sizeof(ControlCommand));
+
+    for (const BenchmarkCase &benchCase : benchmarkCases)
+    {
+        BenchmarkResult result = _runCase(benchCase);
+        TEST_ASSERT_GREATER_THAN(0, result.iterations);
+        TEST_ASSERT_TRUE(result.realNs > 0 && result.minNs <= result.realNs && result.realNs <= result.maxNs);
+        benchResults[benchResultsCount++] = result;
+    }
+    benchMotor.stop();
+    vQueueDelete(benchQueueMailbox);
+    vQueueDelete(benchQueue);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_control_path);
+    int failures = UNITY_END();
+
+    _printJson(stdout);
+    const char *path = getenv("BENCHMARK_OUT");
+    if (path != NULL)
+    {
+        FILE *out = fopen(path, "w");
+        if (out != NULL)
+        {
+            _printJson(out);
+            fclose(out);
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "event_loop_tracker.h"
+#include "limit_debouncer.h"
+#include "motor.h"
+#include "supervisor.h"
+
+/*
+ * The control task is simulated on a virtual clock with one axis and its limit switch: it waits for
+ * the next limit switch edge or the timeout derived from the debounce window, the position updates
+ * of the moving axis and the supervisor, then handles the switch like Motor::updateLimitSwitches().
+ */
+
+// Time from an interrupt to the running control task
+#define WAKE_LATENCY_US 40
+
+// Idle timeout of the control task
+#define IDLE_TIMEOUT_US (SUPERVISOR_FEED_INTERVAL_MS * 1000)
+
+// Limit switch edge of the simulation
+struct SimEdge
+{
+    uint32_t timeUs;
+    bool pressed;
+};
+
+EventLoopTracker tracker;
+LimitDebouncer debouncer;
+uint32_t nowUs;
+bool moving;
+const SimEdge *edges;
+size_t edgesCount;
+size_t nextEdge;
+
+// Timeout of the next wait, see controlTask() and Motor::nextUpdateUs()
+uint32_t _nextTimeoutUs()
+{
+    uint32_t timeout = debouncer.remainingUs(nowUs);
+    if (moving && timeout > POSITION_UPDATE_PERIOD_US)
+        timeout = POSITION_UPDATE_PERIOD_US;
+    return timeout < IDLE_TIMEOUT_US ? timeout : IDLE_TIMEOUT_US;
+}
+
+// One cycle of the control task, woken by an edge or by the tick timer
+void _cycle()
+{
+    uint32_t timeoutUs = _nextTimeoutUs();
+    uint32_t startUs = nowUs;
+    uint32_t timerUs = startUs + EventLoopTracker::timeoutMs(timeoutUs) * 1000;
+
+    bool event = nextEdge < edgesCount && (int32_t)(edges[nextEdge].timeUs - timerUs) < 0;
+    if (event)
+    {
+        // Every edge notifies the loop, the edges before the task runs are taken together
+        uint32_t wakeUs = edges[nextEdge].timeUs + WAKE_LATENCY_US;
+        while (nextEdge < edgesCount && (int32_t)(edges[nextEdge].timeUs - wakeUs) <= 0)
+        {
+            tracker.notify(edges[nextEdge].timeUs);
+            debouncer.edge(edges[nextEdge].timeUs, edges[nextEdge].pressed);
+            nextEdge++;
+        }
+        nowUs = wakeUs;
+    }
+    else
+    {
+        nowUs = timerUs;
+    }
+    tracker.wakeup(event, startUs, timeoutUs, nowUs);
+
+    // The pressed limit stops the axis
+    debouncer.update(nowUs);
+    if (debouncer.state())
+        moving = false;
+}
+
+void _runUntil(uint32_t endUs)
+{
+    while ((int32_t)(nowUs - endUs) < 0)
+        _cycle();
+}
+
+void setUp(void)
+{
+    tracker.reset(0);
+    debouncer.reset(false);
+    nowUs = 0;
+    moving = false;
+    edges = NULL;
+    edgesCount = 0;
+    nextEdge = 0;
+}
+
+void tearDown(void) {}
+
+void test_idle_loop_wakes_for_the_supervisor(void)
+{
+    _runUntil(10000000);
+
+    const EventLoopStats &stats = tracker.stats();
+    TEST_ASSERT_EQUAL(100, stats.wakeups);
+    TEST_ASSERT_EQUAL(100, stats.timerWakeups);
+    TEST_ASSERT_EQUAL(0, stats.eventWakeups);
+    TEST_ASSERT_EQUAL(1000000 / IDLE_TIMEOUT_US, stats.wakeupsPerSecond);
+    TEST_ASSERT_EQUAL(1000000 / IDLE_TIMEOUT_US, stats.maxWakeupsPerSecond);
+    TEST_ASSERT_EQUAL(0, stats.maxEventLatencyUs);
+    TEST_ASSERT_EQUAL(0, stats.maxTimerLateUs);
+}
+
+void test_moving_axis_wakes_for_the_position(void)
+{
+    moving = true;
+    _runUntil(2000000);
+
+    const EventLoopStats &stats = tracker.stats();
+    TEST_ASSERT_EQUAL(2000000 / POSITION_UPDATE_PERIOD_US, stats.wakeups);
+    TEST_ASSERT_EQUAL(1000000 / POSITION_UPDATE_PERIOD_US, stats.wakeupsPerSecond);
+    TEST_ASSERT_EQUAL(0, stats.maxTimerLateUs);
+}
+
+void test_limit_edge_stops_the_axis_without_polling(void)
+{
+    // The switch is pressed and bounces while the axis moves
+    const SimEdge bounce[] = {{250300, true}, {250600, false}, {250900, true}};
+    edges = bounce;
+    edgesCount = 3;
+    moving = true;
+
+    _runUntil(250300 + WAKE_LATENCY_US);
+    TEST_ASSERT_FALSE(moving);
+    TEST_ASSERT_EQUAL(1, tracker.stats().eventWakeups);
+    TEST_ASSERT_EQUAL(WAKE_LATENCY_US, tracker.stats().maxEventLatencyUs);
+
+    // Every bounce wakes the loop, then the burst ends with the debounce window after the last edge
+    _runUntil(250900 + WAKE_LATENCY_US);
+    TEST_ASSERT_EQUAL(3, tracker.stats().eventWakeups);
+    TEST_ASSERT_TRUE(debouncer.inBurst());
+    _cycle();
+    TEST_ASSERT_FALSE(debouncer.inBurst());
+    TEST_ASSERT_TRUE(debouncer.state());
+    TEST_ASSERT_EQUAL(250900 + LIMIT_DEBOUNCE_INITIAL_US + WAKE_LATENCY_US, nowUs);
+
+    // The window was requested after the wakeup latency and rounded up to the tick
+    TEST_ASSERT_EQUAL(WAKE_LATENCY_US, tracker.stats().maxTimerLateUs);
+    TEST_ASSERT_EQUAL(WAKE_LATENCY_US, tracker.stats().maxEventLatencyUs);
+
+    // The first second had 25 position updates, 3 edges, the debounce window and 8 idle wakeups
+    _runUntil(3000000);
+    TEST_ASSERT_EQUAL(37, tracker.stats().maxWakeupsPerSecond);
+    TEST_ASSERT_EQUAL(1000000 / IDLE_TIMEOUT_US, tracker.stats().wakeupsPerSecond);
+}
+
+void test_burst_of_edges_is_timed_from_the_first(void)
+{
+    // The edges come faster than the task wakes up
+    const SimEdge burst[] = {{500000, true}, {500010, false}, {500020, true}};
+    edges = burst;
+    edgesCount = 3;
+
+    _runUntil(500000 + WAKE_LATENCY_US);
+    TEST_ASSERT_EQUAL(1, tracker.stats().eventWakeups);
+    TEST_ASSERT_EQUAL(WAKE_LATENCY_US, tracker.stats().maxEventLatencyUs);
+    TEST_ASSERT_EQUAL(3, debouncer.stats().edges);
+}
+
+void test_worst_latency_is_kept(void)
+{
+    tracker.notify(100);
+    tracker.wakeup(true, 0, 1000, 250);
+    tracker.notify(1000);
+    tracker.wakeup(true, 250, 1000, 1020);
+    TEST_ASSERT_EQUAL(150, tracker.stats().maxEventLatencyUs);
+
+    // A timer wakeup does not take the time of a notification
+    tracker.wakeup(false, 1020, 3500, 5020);
+    TEST_ASSERT_EQUAL(150, tracker.stats().maxEventLatencyUs);
+    TEST_ASSERT_EQUAL(500, tracker.stats().maxTimerLateUs);
+    TEST_ASSERT_EQUAL(2, tracker.stats().eventWakeups);
+    TEST_ASSERT_EQUAL(1, tracker.stats().timerWakeups);
+}
+
+void test_notification_time_wraps_around(void)
+{
+    tracker.reset(UINT32_MAX - 1000000);
+    tracker.notify(UINT32_MAX - 20);
+    tracker.wakeup(true, UINT32_MAX - 100, 100000, 30);
+    TEST_ASSERT_EQUAL(51, tracker.stats().maxEventLatencyUs);
+    TEST_ASSERT_EQUAL(1, tracker.stats().wakeupsPerSecond);
+}
+
+void test_timeout_is_rounded_up_to_the_tick(void)
+{
+    TEST_ASSERT_EQUAL(0, EventLoopTracker::timeoutMs(0));
+    TEST_ASSERT_EQUAL(1, EventLoopTracker::timeoutMs(1));
+    TEST_ASSERT_EQUAL(1, EventLoopTracker::timeoutMs(1000));
+    TEST_ASSERT_EQUAL(2, EventLoopTracker::timeoutMs(1001));
+    TEST_ASSERT_EQUAL(4294968, EventLoopTracker::timeoutMs(UINT32_MAX));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_loop_wakes_for_the_supervisor);
+    RUN_TEST(test_moving_axis_wakes_for_the_position);
+    RUN_TEST(test_limit_edge_stops_the_axis_without_polling);
+    RUN_TEST(test_burst_of_edges_is_timed_from_the_first);
+    RUN_TEST(test_worst_latency_is_kept);
+    RUN_TEST(test_notification_time_wraps_around);
+    RUN_TEST(test_timeout_is_rounded_up_to_the_tick);
+    return UNITY_END();
+}
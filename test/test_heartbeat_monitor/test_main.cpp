@@ -0,0 +1,123 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "heartbeat_monitor.h"
+
+// Parameters of the supervisor
+#define MISSED_PERIODS  3
+#define MIN_DEADLINE_MS 1000
+
+HeartbeatMonitor monitor;
+
+void setUp(void)
+{
+    monitor = HeartbeatMonitor();
+}
+
+void tearDown(void) {}
+
+void test_slots_are_added_until_full(void)
+{
+    for (int i = 0; i < HEARTBEAT_MAX_SLOTS; i++)
+        TEST_ASSERT_EQUAL(i, monitor.add(1000, 0));
+
+    TEST_ASSERT_EQUAL(HEARTBEAT_NO_SLOT, monitor.add(1000, 0));
+    TEST_ASSERT_EQUAL(HEARTBEAT_MAX_SLOTS, monitor.count());
+
+    // Beats of unknown slots are ignored
+    monitor.beat(HEARTBEAT_NO_SLOT, 500);
+    monitor.beat(HEARTBEAT_MAX_SLOTS, 500);
+    TEST_ASSERT_EQUAL(0, monitor.silenceMs(HEARTBEAT_NO_SLOT, 500));
+    TEST_ASSERT_EQUAL(500, monitor.silenceMs(0, 500));
+}
+
+void test_deadline_counts_from_the_last_beat(void)
+{
+    int slot = monitor.add(1000, 100);
+
+    // The deadline itself is still on time, one tick past it is overdue
+    TEST_ASSERT_EQUAL(HEARTBEAT_NO_SLOT, monitor.overdue(1100));
+    TEST_ASSERT_EQUAL(slot, monitor.overdue(1101));
+
+    monitor.beat(slot, 1101);
+    TEST_ASSERT_EQUAL(0, monitor.silenceMs(slot, 1101));
+    TEST_ASSERT_EQUAL(HEARTBEAT_NO_SLOT, monitor.overdue(2101));
+    TEST_ASSERT_EQUAL(slot, monitor.overdue(2102));
+}
+
+void test_most_overdue_slot_is_reported(void)
+{
+    int fast = monitor.add(100, 0);
+    int slow = monitor.add(1000, 0);
+    monitor.add(5000, 0);
+
+    TEST_ASSERT_EQUAL(fast, monitor.overdue(500));
+
+    // The slow slot exceeds its deadline by more than the fast one
+    monitor.beat(fast, 1000);
+    TEST_ASSERT_EQUAL(slow, monitor.overdue(1200));
+    monitor.beat(slow, 1200);
+    TEST_ASSERT_EQUAL(fast, monitor.overdue(1400));
+}
+
+void test_paused_slot_is_not_checked(void)
+{
+    int slot = monitor.add(1000, 0);
+
+    monitor.pause(slot);
+    TEST_ASSERT_EQUAL(HEARTBEAT_NO_SLOT, monitor.overdue(60000));
+
+    // The deadline starts from the resume, not from the last beat
+    monitor.resume(slot, 60000);
+    TEST_ASSERT_EQUAL(HEARTBEAT_NO_SLOT, monitor.overdue(61000));
+    TEST_ASSERT_EQUAL(slot, monitor.overdue(61001));
+}
+
+void test_millis_wraparound(void)
+{
+    const uint32_t start = UINT32_MAX - 400;
+    int slot = monitor.add(1000, start);
+
+    TEST_ASSERT_EQUAL(HEARTBEAT_NO_SLOT, monitor.overdue(start + 1000));
+    TEST_ASSERT_EQUAL(1000, monitor.silenceMs(slot, start + 1000));
+    TEST_ASSERT_EQUAL(slot, monitor.overdue(start + 1001));
+
+    monitor.beat(slot, UINT32_MAX);
+    TEST_ASSERT_EQUAL(HEARTBEAT_NO_SLOT, monitor.overdue(999));
+    TEST_ASSERT_EQUAL(slot, monitor.overdue(1000));
+}
+
+void test_deadline_for_the_task_period(void)
+{
+    // Slow periodic tasks get three periods
+    TEST_ASSERT_EQUAL(3000, HeartbeatMonitor::deadlineFor(1000, 100, MISSED_PERIODS, MIN_DEADLINE_MS));
+    TEST_ASSERT_EQUAL(1002, HeartbeatMonitor::deadlineFor(334, 100, MISSED_PERIODS, MIN_DEADLINE_MS));
+
+    // Fast tasks are bounded by the flash writes
+    TEST_ASSERT_EQUAL(MIN_DEADLINE_MS, HeartbeatMonitor::deadlineFor(2, 100, MISSED_PERIODS, MIN_DEADLINE_MS));
+    TEST_ASSERT_EQUAL(MIN_DEADLINE_MS, HeartbeatMonitor::deadlineFor(333, 100, MISSED_PERIODS, MIN_DEADLINE_MS));
+
+    // Event-driven tasks use their longest wait
+    TEST_ASSERT_EQUAL(MIN_DEADLINE_MS, HeartbeatMonitor::deadlineFor(0, 100, MISSED_PERIODS, MIN_DEADLINE_MS));
+    TEST_ASSERT_EQUAL(1500, HeartbeatMonitor::deadlineFor(0, 500, MISSED_PERIODS, MIN_DEADLINE_MS));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_slots_are_added_until_full);
+    RUN_TEST(test_deadline_counts_from_the_last_beat);
+    RUN_TEST(test_most_overdue_slot_is_reported);
+    RUN_TEST(test_paused_slot_is_not_checked);
+    RUN_TEST(test_millis_wraparound);
+    RUN_TEST(test_deadline_for_the_task_period);
+    return UNITY_END();
+}
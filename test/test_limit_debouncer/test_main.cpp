@@ -0,0 +1,212 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "limit_debouncer.h"
+
+LimitDebouncer debouncer;
+
+/**
+ * @brief Feed a synthetic bounce trace: edges alternating from the given level, the gaps in microseconds.
+ *
+ * @return Time of the last edge.
+ */
+uint32_t _bounce(uint32_t startUs, bool level, const uint32_t *gapsUs, uint8_t count)
+{
+    uint32_t time = startUs;
+    debouncer.edge(time, level);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        time += gapsUs[i];
+        level = !level;
+        debouncer.edge(time, level);
+    }
+    return time;
+}
+
+// Close the burst started by the trace, the update comes just after the window
+uint32_t _settle(uint32_t lastEdgeUs)
+{
+    uint32_t end = lastEdgeUs + debouncer.stats().windowUs;
+    TEST_ASSERT_FALSE(debouncer.update(end - 1));
+    TEST_ASSERT_TRUE(debouncer.update(end));
+    return end;
+}
+
+void setUp(void)
+{
+    debouncer.reset(false);
+}
+
+void tearDown(void) {}
+
+void test_press_is_accepted_at_the_first_edge(void)
+{
+    debouncer.edge(1000, true);
+    TEST_ASSERT_TRUE(debouncer.state());
+    TEST_ASSERT_TRUE(debouncer.inBurst());
+    TEST_ASSERT_EQUAL(1, debouncer.stats().transitions);
+
+    // The bounces of the press do not release the switch
+    const uint32_t gaps[] = {300, 200, 400};
+    uint32_t last = _bounce(1500, false, gaps, 3);
+    TEST_ASSERT_TRUE(debouncer.state());
+    _settle(last);
+
+    TEST_ASSERT_TRUE(debouncer.state());
+    TEST_ASSERT_EQUAL(1, debouncer.stats().transitions);
+    TEST_ASSERT_EQUAL(4, debouncer.stats().bounces);
+    TEST_ASSERT_EQUAL(0, debouncer.stats().glitches);
+    TEST_ASSERT_EQUAL(last - 1000, debouncer.stats().maxBurstUs);
+}
+
+void test_release_waits_for_the_bounces(void)
+{
+    debouncer.reset(true);
+
+    const uint32_t gaps[] = {500, 800, 300, 400};
+    uint32_t last = _bounce(10000, false, gaps, 4);
+    TEST_ASSERT_TRUE(debouncer.state());
+    TEST_ASSERT_EQUAL(LIMIT_DEBOUNCE_INITIAL_US, debouncer.remainingUs(last));
+
+    // Every bounce restarts the window
+    TEST_ASSERT_EQUAL(1000, debouncer.remainingUs(last + LIMIT_DEBOUNCE_INITIAL_US - 1000));
+    _settle(last);
+    TEST_ASSERT_FALSE(debouncer.state());
+    TEST_ASSERT_FALSE(debouncer.inBurst());
+    TEST_ASSERT_EQUAL(1, debouncer.stats().transitions);
+    TEST_ASSERT_EQUAL(4, debouncer.stats().bounces);
+    TEST_ASSERT_EQUAL(UINT32_MAX, debouncer.remainingUs(last + LIMIT_DEBOUNCE_INITIAL_US));
+}
+
+void test_short_pulses_are_glitches(void)
+{
+    // A vibration pulse on a released switch is taken as a press, then released after the window
+    const uint32_t pressGaps[] = {200};
+    uint32_t last = _bounce(0, true, pressGaps, 1);
+    TEST_ASSERT_TRUE(debouncer.state());
+    _settle(last);
+    TEST_ASSERT_FALSE(debouncer.state());
+    TEST_ASSERT_EQUAL(2, debouncer.stats().transitions);
+    TEST_ASSERT_EQUAL(1, debouncer.stats().glitches);
+
+    // A dropout of a pressed switch never releases it
+    debouncer.reset(true);
+    const uint32_t releaseGaps[] = {300};
+    last = _bounce(50000, false, releaseGaps, 1);
+    TEST_ASSERT_TRUE(debouncer.state());
+    _settle(last);
+    TEST_ASSERT_TRUE(debouncer.state());
+    TEST_ASSERT_EQUAL(0, debouncer.stats().transitions);
+    TEST_ASSERT_EQUAL(1, debouncer.stats().glitches);
+}
+
+void test_window_tightens_for_a_clean_switch(void)
+{
+    uint32_t time = 0;
+    for (uint8_t i = 0; i < 100; i++)
+    {
+        debouncer.edge(time, i % 2 == 0);
+        time = _settle(time) + 100000;
+    }
+
+    // Single edges without bounces, only the margin is left within the minimum
+    TEST_ASSERT_EQUAL(LIMIT_DEBOUNCE_MIN_US, debouncer.stats().windowUs);
+    TEST_ASSERT_EQUAL(0, debouncer.stats().bounces);
+    TEST_ASSERT_EQUAL(100, debouncer.stats().transitions);
+}
+
+void test_window_follows_a_noisy_switch(void)
+{
+    // A 5 ms burst doubles the estimate at once
+    const uint32_t gaps[] = {1000, 1000, 1000, 1000, 1000};
+    uint32_t last = _bounce(0, true, gaps, 5);
+    _settle(last);
+    TEST_ASSERT_EQUAL(2 * 5000 + LIMIT_DEBOUNCE_MARGIN_US, debouncer.stats().windowUs);
+
+    // Shorter bursts lower the window slowly
+    const uint32_t shortGaps[] = {1000};
+    last = _bounce(1000000, true, shortGaps, 1);
+    _settle(last);
+    uint32_t estimate = 5000 - (5000 - 1000) / LIMIT_DEBOUNCE_DECAY;
+    TEST_ASSERT_EQUAL(2 * estimate + LIMIT_DEBOUNCE_MARGIN_US, debouncer.stats().windowUs);
+
+    // A very noisy switch is capped
+    const uint32_t longGaps[] = {40000, 40000, 40000};
+    last = _bounce(2000000, true, longGaps, 3);
+    _settle(last);
+    TEST_ASSERT_EQUAL(LIMIT_DEBOUNCE_MAX_US, debouncer.stats().windowUs);
+}
+
+void test_chattering_switch_closes_its_burst(void)
+{
+    // The switch bounces every millisecond and never settles, it is pressed from the first edge
+    uint32_t time = 0;
+    bool level = true;
+    while (time < LIMIT_BURST_MAX_US)
+    {
+        debouncer.edge(time, level);
+        TEST_ASSERT_TRUE(debouncer.state());
+        TEST_ASSERT_LESS_OR_EQUAL(LIMIT_BURST_MAX_US - time, debouncer.remainingUs(time));
+        TEST_ASSERT_FALSE(debouncer.update(time));
+        level = !level;
+        time += 1000;
+    }
+
+    // The burst ends at the bound with the current level, released after the last edge
+    TEST_ASSERT_EQUAL(0, debouncer.remainingUs(time));
+    TEST_ASSERT_TRUE(debouncer.update(time));
+    TEST_ASSERT_FALSE(debouncer.state());
+    TEST_ASSERT_FALSE(debouncer.inBurst());
+    TEST_ASSERT_EQUAL(1, debouncer.stats().chatters);
+    TEST_ASSERT_EQUAL(0, debouncer.stats().maxLateUs);
+    TEST_ASSERT_EQUAL(LIMIT_DEBOUNCE_MAX_US, debouncer.stats().windowUs);
+
+    // The next press is still taken at once
+    debouncer.edge(time + 100, true);
+    TEST_ASSERT_TRUE(debouncer.state());
+}
+
+void test_late_update_is_measured(void)
+{
+    debouncer.reset(true);
+    debouncer.edge(0, false);
+    TEST_ASSERT_TRUE(debouncer.update(LIMIT_DEBOUNCE_INITIAL_US + 750));
+    TEST_ASSERT_EQUAL(750, debouncer.stats().maxLateUs);
+    TEST_ASSERT_FALSE(debouncer.state());
+}
+
+void test_time_wraparound(void)
+{
+    const uint32_t start = UINT32_MAX - 3000;
+    const uint32_t gaps[] = {1000, 1500, 1000};
+
+    uint32_t last = _bounce(start, true, gaps, 3);
+    TEST_ASSERT_TRUE(last < start);
+    TEST_ASSERT_TRUE(debouncer.state());
+    TEST_ASSERT_EQUAL(LIMIT_DEBOUNCE_INITIAL_US, debouncer.remainingUs(last));
+    _settle(last);
+    TEST_ASSERT_FALSE(debouncer.state());
+    TEST_ASSERT_EQUAL(3500, debouncer.stats().maxBurstUs);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_press_is_accepted_at_the_first_edge);
+    RUN_TEST(test_release_waits_for_the_bounces);
+    RUN_TEST(test_short_pulses_are_glitches);
+    RUN_TEST(test_window_tightens_for_a_clean_switch);
+    RUN_TEST(test_window_follows_a_noisy_switch);
+    RUN_TEST(test_chattering_switch_closes_its_burst);
+    RUN_TEST(test_late_update_is_measured);
+    RUN_TEST(test_time_wraparound);
+    return UNITY_END();
+}
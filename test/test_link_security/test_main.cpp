@@ -0,0 +1,136 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "link_security.h"
+
+ReplayWindow window;
+
+void setUp(void)
+{
+    window.reset();
+}
+
+void tearDown(void) {}
+
+void test_first_frame_is_accepted(void)
+{
+    TEST_ASSERT_TRUE(window.check(7, 123456));
+    TEST_ASSERT_EQUAL(7, window.epoch());
+    TEST_ASSERT_EQUAL(123456, window.highest());
+    TEST_ASSERT_FALSE(window.check(7, 123456));
+}
+
+void test_newer_frames_are_accepted_once(void)
+{
+    for (uint32_t counter = 1; counter <= 200; counter++)
+        TEST_ASSERT_TRUE(window.check(0, counter));
+    for (uint32_t counter = 1; counter <= 200; counter++)
+        TEST_ASSERT_FALSE(window.check(0, counter));
+
+    // A gap in the counters is fine
+    TEST_ASSERT_TRUE(window.check(0, 100000));
+    TEST_ASSERT_EQUAL(100000, window.highest());
+}
+
+void test_out_of_order_frames_within_the_window(void)
+{
+    TEST_ASSERT_TRUE(window.check(0, 100));
+    TEST_ASSERT_TRUE(window.check(0, 110));
+    TEST_ASSERT_TRUE(window.check(0, 105));
+    TEST_ASSERT_FALSE(window.check(0, 105));
+
+    // Older than the window
+    TEST_ASSERT_FALSE(window.check(0, 110 - LINK_REPLAY_WINDOW));
+    TEST_ASSERT_TRUE(window.check(0, 110 - LINK_REPLAY_WINDOW + 1));
+    TEST_ASSERT_EQUAL(110, window.highest());
+}
+
+void test_large_jump_clears_the_window(void)
+{
+    TEST_ASSERT_TRUE(window.check(0, 10));
+    TEST_ASSERT_TRUE(window.check(0, 10 + LINK_REPLAY_WINDOW));
+    TEST_ASSERT_FALSE(window.check(0, 10));
+    TEST_ASSERT_TRUE(window.check(0, 11));
+    TEST_ASSERT_FALSE(window.check(0, 10 + LINK_REPLAY_WINDOW));
+}
+
+void test_rebooted_sender_is_accepted_in_a_new_epoch(void)
+{
+    for (uint32_t counter = 1000; counter < 1100; counter++)
+        window.check(3, counter);
+
+    // The rebooted Controller starts its counter again
+    TEST_ASSERT_FALSE(window.check(3, 1));
+    TEST_ASSERT_TRUE(window.check(4, 1));
+    TEST_ASSERT_TRUE(window.check(4, 2));
+    TEST_ASSERT_EQUAL(4, window.epoch());
+    TEST_ASSERT_EQUAL(2, window.highest());
+
+    // The frames of the previous boot can't be replayed anymore
+    TEST_ASSERT_FALSE(window.check(3, 1099));
+    TEST_ASSERT_FALSE(window.check(3, 5000));
+    TEST_ASSERT_FALSE(window.check(4, 1));
+}
+
+void test_reset_accepts_any_frame(void)
+{
+    window.check(9, 500);
+    window.reset();
+    TEST_ASSERT_TRUE(window.check(1, 1));
+    TEST_ASSERT_EQUAL(1, window.epoch());
+}
+
+void test_parse_link_key(void)
+{
+    const uint8_t expected[LINK_KEY_LEN] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                            0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+    uint8_t key[LINK_KEY_LEN];
+
+    TEST_ASSERT_TRUE(parseLinkKey("00112233445566778899aabbccddeeff", key));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, key, LINK_KEY_LEN);
+    TEST_ASSERT_TRUE(parseLinkKey("00112233445566778899AABBCCDDEEFF", key));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, key, LINK_KEY_LEN);
+}
+
+void test_parse_link_key_rejects_bad_input(void)
+{
+    uint8_t key[LINK_KEY_LEN];
+
+    TEST_ASSERT_FALSE(parseLinkKey("00112233445566778899aabbccddeef", key));   // Too short
+    TEST_ASSERT_FALSE(parseLinkKey("00112233445566778899aabbccddeeff0", key)); // Too long
+    TEST_ASSERT_FALSE(parseLinkKey("00112233445566778899aabbccddeefg", key));  // Not a digit
+    TEST_ASSERT_FALSE(parseLinkKey("", key));
+    TEST_ASSERT_FALSE(parseLinkKey("00000000000000000000000000000000", key)); // All zeros
+}
+
+void test_valid_link_key(void)
+{
+    uint8_t key[LINK_KEY_LEN] = {};
+
+    TEST_ASSERT_FALSE(isValidLinkKey(key));
+    key[LINK_KEY_LEN - 1] = 1;
+    TEST_ASSERT_TRUE(isValidLinkKey(key));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_frame_is_accepted);
+    RUN_TEST(test_newer_frames_are_accepted_once);
+    RUN_TEST(test_out_of_order_frames_within_the_window);
+    RUN_TEST(test_large_jump_clears_the_window);
+    RUN_TEST(test_rebooted_sender_is_accepted_in_a_new_epoch);
+    RUN_TEST(test_reset_accepts_any_frame);
+    RUN_TEST(test_parse_link_key);
+    RUN_TEST(test_parse_link_key_rejects_bad_input);
+    RUN_TEST(test_valid_link_key);
+    return UNITY_END();
+}
@@ -0,0 +1,254 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <atomic>
+#include <thread>
+#include <unity.h>
+
+#include <seqlock.h>
+#include <spsc_ring.h>
+#include <triple_buffer.h>
+
+/*
+ * The stress tests run the producer and the consumer in two threads, as on the two cores of the ESP32.
+ * They check the values only, the native-tsan environment also checks the memory ordering.
+ */
+
+// Values handed over in the stress tests
+#define STRESS_VALUES 200000
+
+// Value whose fields are all derived from the sequence, a torn copy has mismatching fields
+struct StressValue
+{
+    uint32_t sequence;
+    uint32_t inverted;
+    uint64_t squared;
+    int16_t levers[6];
+};
+
+StressValue _makeValue(uint32_t sequence)
+{
+    StressValue value = {sequence, ~sequence, (uint64_t)sequence * sequence, {}};
+    for (uint8_t i = 0; i < 6; i++)
+        value.levers[i] = (int16_t)(sequence + i);
+    return value;
+}
+
+bool _isConsistent(const StressValue &value)
+{
+    if (value.inverted != ~value.sequence || value.squared != (uint64_t)value.sequence * value.sequence)
+        return false;
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        if (value.levers[i] != (int16_t)(value.sequence + i))
+            return false;
+    }
+    return true;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_spsc_ring_keeps_the_order(void)
+{
+    SpscRing<uint32_t, 4> ring;
+    uint32_t value;
+
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.pop(value));
+
+    // The indexes wrap around the buffer several times
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        TEST_ASSERT_TRUE(ring.push(i * 2));
+        TEST_ASSERT_TRUE(ring.push(i * 2 + 1));
+        TEST_ASSERT_EQUAL(2, ring.size());
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL(i * 2, value);
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL(i * 2 + 1, value);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL(0, ring.dropped());
+}
+
+void test_spsc_ring_rejects_when_full(void)
+{
+    SpscRing<uint32_t, 4> ring;
+    uint32_t value;
+
+    for (uint32_t i = 0; i < 4; i++)
+        TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_FALSE(ring.push(4));
+    TEST_ASSERT_FALSE(ring.push(5));
+    TEST_ASSERT_EQUAL(2, ring.dropped());
+    TEST_ASSERT_EQUAL(4, ring.size());
+
+    // The rejected elements did not overwrite the queued ones
+    TEST_ASSERT_TRUE(ring.pop(value));
+    TEST_ASSERT_EQUAL(0, value);
+    TEST_ASSERT_TRUE(ring.push(6));
+    const uint32_t expected[] = {1, 2, 3, 6};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL(expected[i], value);
+    }
+}
+
+void test_spsc_ring_stress(void)
+{
+    static SpscRing<StressValue, 8> ring;
+    uint32_t retries = 0;
+
+    std::thread producer([&retries]() {
+        for (uint32_t i = 0; i < STRESS_VALUES; i++)
+        {
+            while (!ring.push(_makeValue(i)))
+            {
+                retries++;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t torn = 0;
+    uint32_t outOfOrder = 0;
+    StressValue value;
+    while (expected < STRESS_VALUES)
+    {
+        if (!ring.pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        torn += !_isConsistent(value);
+        outOfOrder += value.sequence != expected;
+        expected = value.sequence + 1;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(0, outOfOrder);
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL(retries, ring.dropped());
+}
+
+void test_triple_buffer_returns_the_newest_value(void)
+{
+    TripleBuffer<uint32_t> buffer;
+    uint32_t value = 7;
+
+    TEST_ASSERT_FALSE(buffer.read(value));
+    TEST_ASSERT_EQUAL(7, value);
+
+    buffer.write(1);
+    buffer.write(2);
+    buffer.write(3);
+    TEST_ASSERT_TRUE(buffer.read(value));
+    TEST_ASSERT_EQUAL(3, value);
+    TEST_ASSERT_FALSE(buffer.read(value));
+
+    // Every buffer is used by every side in turn
+    for (uint32_t i = 10; i < 20; i++)
+    {
+        buffer.write(i);
+        TEST_ASSERT_TRUE(buffer.read(value));
+        TEST_ASSERT_EQUAL(i, value);
+    }
+}
+
+void test_triple_buffer_stress(void)
+{
+    static TripleBuffer<StressValue> buffer;
+    std::atomic<bool> done(false);
+
+    std::thread producer([&done]() {
+        for (uint32_t i = 1; i <= STRESS_VALUES; i++)
+            buffer.write(_makeValue(i));
+        done.store(true, std::memory_order_release);
+    });
+
+    uint32_t last = 0;
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    StressValue value;
+    for (;;)
+    {
+        // The producer may finish between the read and the check, so one more read follows it
+        bool finished = done.load(std::memory_order_acquire);
+        if (buffer.read(value))
+        {
+            reads++;
+            torn += !_isConsistent(value);
+            backwards += value.sequence <= last;
+            last = value.sequence;
+        }
+        else if (finished)
+        {
+            break;
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(0, backwards);
+    TEST_ASSERT_EQUAL(STRESS_VALUES, last);
+    TEST_ASSERT_GREATER_THAN(0, reads);
+}
+
+void test_seqlock_stress(void)
+{
+    static Seqlock<StressValue> snapshot;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> backwards(0);
+
+    snapshot.write(_makeValue(0));
+
+    auto reader = [&done, &torn, &backwards]() {
+        uint32_t last = 0;
+        while (!done.load(std::memory_order_acquire))
+        {
+            StressValue value = snapshot.read();
+            if (!_isConsistent(value))
+                torn++;
+            if (value.sequence < last)
+                backwards++;
+            last = value.sequence;
+        }
+    };
+    std::thread first(reader);
+    std::thread second(reader);
+
+    for (uint32_t i = 1; i <= STRESS_VALUES; i++)
+        snapshot.write(_makeValue(i));
+    done.store(true, std::memory_order_release);
+    first.join();
+    second.join();
+
+    TEST_ASSERT_EQUAL(0, torn.load());
+    TEST_ASSERT_EQUAL(0, backwards.load());
+    TEST_ASSERT_EQUAL(STRESS_VALUES, snapshot.read().sequence);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_spsc_ring_keeps_the_order);
+    RUN_TEST(test_spsc_ring_rejects_when_full);
+    RUN_TEST(test_spsc_ring_stress);
+    RUN_TEST(test_triple_buffer_returns_the_newest_value);
+    RUN_TEST(test_triple_buffer_stress);
+    RUN_TEST(test_seqlock_stress);
+    return UNITY_END();
+}
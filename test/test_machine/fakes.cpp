@@ -0,0 +1,31 @@
+/**
+ * @file fakes.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include "fakes.h"
+#include "event_loop.h"
+#include "pwm_controller.h"
+
+uint16_t fakePwmValues[256];
+uint32_t fakeEventLoopNotifications = 0;
+
+void setPinPWM(uint8_t pin, uint16_t value)
+{
+    fakePwmValues[pin] = value;
+}
+
+void setMotorPwm(uint8_t posMotorPin, uint8_t negMotorPin, uint16_t posPinValue, uint16_t negPinValue)
+{
+    fakePwmValues[posMotorPin] = posPinValue;
+    fakePwmValues[negMotorPin] = negPinValue;
+}
+
+void eventLoopNotifyFromIsr()
+{
+    fakeEventLoopNotifications++;
+}
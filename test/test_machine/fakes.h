@@ -0,0 +1,19 @@
+/**
+ * @file fakes.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef FAKES_H
+#define FAKES_H
+
+#include <stdint.h>
+
+// Expander channel values written by the motors
+extern uint16_t fakePwmValues[256];
+extern uint32_t fakeEventLoopNotifications;
+
+#endif // FAKES_H
@@ -0,0 +1,11 @@
+/**
+ * @file firmware.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+// The motors are built only for this suite, the PWM and event loop calls are faked in fakes.cpp
+#include "motor.cpp"
@@ -0,0 +1,317 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <Arduino.h>
+#include <new>
+#include <unity.h>
+
+#include "fakes.h"
+#include "machine.h"
+#include "pwm_controller.h"
+
+/**
+ * @brief Describe a plain axis without switches and end of travel.
+ */
+constexpr AxisConfig _axis(MotorOutput output, uint8_t posPin, uint8_t negPin, uint8_t lever, uint16_t slowZone = 0)
+{
+    return {.name = "axis",
+            .output = output,
+            .posMotorPin = posPin,
+            .negMotorPin = negPin,
+            .breakMode = true,
+            .reverse = false,
+            .posLimitPin = GPIO_NUM_NC,
+            .negLimitPin = GPIO_NUM_NC,
+            .centerPin = GPIO_NUM_NC,
+            .leverIndex = lever,
+            .deadband = 0,
+            .maxSpeed = 255,
+            .travelMs = 0,
+            .slowZone = slowZone};
+}
+
+// Machine with the expander and the LEDC outputs mixed, the axes in another order than the levers
+constexpr AxisConfig MIXED_AXES[] = {
+    {.name = "bucket",
+     .output = MOTOR_OUTPUT_EXPANDER,
+     .posMotorPin = 0,
+     .negMotorPin = 1,
+     .breakMode = true,
+     .reverse = false,
+     .posLimitPin = GPIO_NUM_19,
+     .negLimitPin = GPIO_NUM_23,
+     .centerPin = GPIO_NUM_NC,
+     .leverIndex = BUCKET_LEVER,
+     .deadband = 0,
+     .maxSpeed = 255,
+     .travelMs = 0,
+     .slowZone = 0},
+    {.name = "swing",
+     .output = MOTOR_OUTPUT_LEDC,
+     .posMotorPin = GPIO_NUM_25,
+     .negMotorPin = GPIO_NUM_26,
+     .breakMode = false,
+     .reverse = true,
+     .posLimitPin = GPIO_NUM_NC,
+     .negLimitPin = GPIO_NUM_NC,
+     .centerPin = GPIO_NUM_NC,
+     .leverIndex = SWING_LEVER,
+     .deadband = 0,
+     .maxSpeed = 255,
+     .travelMs = 0,
+     .slowZone = 0},
+    {.name = "stick",
+     .output = MOTOR_OUTPUT_LEDC,
+     .posMotorPin = GPIO_NUM_32,
+     .negMotorPin = GPIO_NUM_33,
+     .breakMode = false,
+     .reverse = false,
+     .posLimitPin = GPIO_NUM_NC,
+     .negLimitPin = GPIO_NUM_NC,
+     .centerPin = GPIO_NUM_NC,
+     .leverIndex = STICK_LEVER,
+     .deadband = 20,
+     .maxSpeed = 128,
+     .travelMs = 0,
+     .slowZone = 0},
+    _axis(MOTOR_OUTPUT_EXPANDER, 2, 3, LEFT_TRAVEL_LEVER),
+};
+
+// Invalid descriptions
+constexpr AxisConfig DUPLICATE_PINS[] = {_axis(MOTOR_OUTPUT_EXPANDER, 0, 1, 0), _axis(MOTOR_OUTPUT_EXPANDER, 1, 2, 1)};
+constexpr AxisConfig SHORTED_AXIS[] = {_axis(MOTOR_OUTPUT_EXPANDER, 3, 3, 0)};
+constexpr AxisConfig BAD_LEVER[] = {_axis(MOTOR_OUTPUT_EXPANDER, 0, 1, LEVERS_COUNT)};
+constexpr AxisConfig BAD_SLOW_ZONE[] = {_axis(MOTOR_OUTPUT_EXPANDER, 0, 1, 0, 501)};
+constexpr AxisConfig TOO_MANY_LEDC[] = {
+    _axis(MOTOR_OUTPUT_LEDC, 0, 1, 0),   _axis(MOTOR_OUTPUT_LEDC, 2, 3, 1),   _axis(MOTOR_OUTPUT_LEDC, 4, 5, 2),
+    _axis(MOTOR_OUTPUT_LEDC, 12, 13, 3), _axis(MOTOR_OUTPUT_LEDC, 14, 15, 4), _axis(MOTOR_OUTPUT_LEDC, 16, 17, 5),
+    _axis(MOTOR_OUTPUT_LEDC, 18, 19, 0)};
+
+// Valid edge cases
+constexpr AxisConfig SAME_PINS_OTHER_OUTPUT[] = {_axis(MOTOR_OUTPUT_EXPANDER, 4, 5, 0), _axis(MOTOR_OUTPUT_LEDC, 4, 5, 1)};
+constexpr AxisConfig ALL_LEDC[] = {
+    _axis(MOTOR_OUTPUT_LEDC, 0, 1, 0),   _axis(MOTOR_OUTPUT_LEDC, 2, 3, 1),   _axis(MOTOR_OUTPUT_LEDC, 4, 5, 2),
+    _axis(MOTOR_OUTPUT_LEDC, 12, 13, 3), _axis(MOTOR_OUTPUT_LEDC, 14, 15, 4), _axis(MOTOR_OUTPUT_LEDC, 16, 17, 5)};
+constexpr AxisConfig MAX_SLOW_ZONE[] = {_axis(MOTOR_OUTPUT_EXPANDER, 0, 1, 0, 500)};
+
+// Axis with an end of travel and a limit switch at its positive end
+constexpr AxisConfig POSITION_AXIS[] = {
+    {.name = "boom",
+     .output = MOTOR_OUTPUT_EXPANDER,
+     .posMotorPin = 0,
+     .negMotorPin = 1,
+     .breakMode = true,
+     .reverse = false,
+     .posLimitPin = GPIO_NUM_19,
+     .negLimitPin = GPIO_NUM_NC,
+     .centerPin = GPIO_NUM_NC,
+     .leverIndex = BOOM_LEVER,
+     .deadband = 0,
+     .maxSpeed = 255,
+     .travelMs = 4000,
+     .slowZone = 0},
+};
+
+// The descriptions are checked when the firmware is compiled
+static_assert(isValidMachine(MACHINE_AXES), "The machine description must be valid");
+static_assert(isValidMachine(MIXED_AXES), "Mixed outputs must be valid");
+static_assert(ledcChannelOf(MIXED_AXES, 0) == MOTOR_LEDC_FIRST_CHANNEL, "Expander axes take no LEDC channel");
+static_assert(ledcChannelOf(MIXED_AXES, 2) == MOTOR_LEDC_FIRST_CHANNEL + 2, "LEDC axes take two channels");
+
+const int16_t NEUTRAL[LEVERS_COUNT] = {0, 0, 0, 0, 0, 0};
+
+Machine<4, MIXED_AXES> *machine = NULL;
+
+void setUp(void)
+{
+    memset(fakePwmValues, 0x55, sizeof(fakePwmValues));
+    memset(mockLedcDuty, 0x55, sizeof(mockLedcDuty));
+    mockGpioLevels[GPIO_NUM_19] = HIGH;
+    mockGpioLevels[GPIO_NUM_23] = HIGH;
+
+    // Every test starts with new motors
+    static Machine<4, MIXED_AXES> instance;
+    instance.~Machine();
+    machine = new (&instance) Machine<4, MIXED_AXES>();
+    machine->setupOutputs();
+}
+
+void tearDown(void) {}
+
+void test_descriptions_are_validated(void)
+{
+    TEST_ASSERT_FALSE(isValidMachine(DUPLICATE_PINS));
+    TEST_ASSERT_FALSE(isValidMachine(SHORTED_AXIS));
+    TEST_ASSERT_FALSE(isValidMachine(BAD_LEVER));
+    TEST_ASSERT_FALSE(isValidMachine(BAD_SLOW_ZONE));
+    TEST_ASSERT_FALSE(isValidMachine(TOO_MANY_LEDC));
+
+    TEST_ASSERT_TRUE(isValidMachine(SAME_PINS_OTHER_OUTPUT));
+    TEST_ASSERT_TRUE(isValidMachine(ALL_LEDC));
+    TEST_ASSERT_TRUE(isValidMachine(MAX_SLOW_ZONE));
+}
+
+void test_ledc_channels_follow_the_table(void)
+{
+    TEST_ASSERT_EQUAL(MOTOR_LEDC_FIRST_CHANNEL, ledcChannelOf(MIXED_AXES, 1));
+    TEST_ASSERT_EQUAL(MOTOR_LEDC_FIRST_CHANNEL + 4, ledcChannelOf(MIXED_AXES, 3));
+    TEST_ASSERT_EQUAL(MOTOR_LEDC_CHANNELS, ledcChannelOf(ALL_LEDC, 6));
+    TEST_ASSERT_EQUAL(MOTOR_LEDC_FIRST_CHANNEL + 2, ledcChannelOf(SAME_PINS_OTHER_OUTPUT, 2));
+}
+
+void test_outputs_are_stopped_at_setup(void)
+{
+    // Braking axes short the motor, the others let it coast
+    TEST_ASSERT_EQUAL(PWM_ON, fakePwmValues[0]);
+    TEST_ASSERT_EQUAL(PWM_ON, fakePwmValues[1]);
+    TEST_ASSERT_EQUAL(PWM_OFF, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL]);
+    TEST_ASSERT_EQUAL(PWM_OFF, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL + 3]);
+    TEST_ASSERT_EQUAL(0x5555, fakePwmValues[GPIO_NUM_25]);
+}
+
+void test_levers_are_dispatched_by_the_table(void)
+{
+    // Boom, bucket, stick, swing, left and right travel
+    const int16_t levers[LEVERS_COUNT] = {255, 100, -200, 50, 70, -255};
+    machine->applyLevers(levers);
+
+    // Expander axes
+    TEST_ASSERT_EQUAL(100, fakePwmValues[0]);
+    TEST_ASSERT_EQUAL(PWM_OFF, fakePwmValues[1]);
+    TEST_ASSERT_EQUAL(70, fakePwmValues[2]);
+    TEST_ASSERT_EQUAL(PWM_OFF, fakePwmValues[3]);
+
+    // The swing is reversed
+    TEST_ASSERT_EQUAL(-50, machine->motor(1).commandedSpeed());
+    TEST_ASSERT_EQUAL(PWM_OFF, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL]);
+    TEST_ASSERT_EQUAL(50, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL + 1]);
+
+    // The stick is scaled to its maximum speed
+    TEST_ASSERT_EQUAL(-100, machine->motor(2).commandedSpeed());
+    TEST_ASSERT_EQUAL(PWM_OFF, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL + 2]);
+    TEST_ASSERT_EQUAL(100, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL + 3]);
+
+    // The stick ignores the lever within its deadband
+    int16_t small[LEVERS_COUNT] = {0, 0, 0, 0, 0, 0};
+    small[STICK_LEVER] = 20;
+    machine->applyLevers(small);
+    TEST_ASSERT_EQUAL(0, machine->motor(2).commandedSpeed());
+    TEST_ASSERT_EQUAL(PWM_OFF, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL + 2]);
+}
+
+void test_stop_all_brakes_immediately(void)
+{
+    const int16_t levers[LEVERS_COUNT] = {100, 100, 100, 100, 100, 100};
+    machine->applyLevers(levers);
+    machine->stopAll();
+
+    for (size_t i = 0; i < 4; i++)
+        TEST_ASSERT_EQUAL(0, machine->motor(i).commandedSpeed());
+    TEST_ASSERT_EQUAL(PWM_ON, fakePwmValues[2]);
+    TEST_ASSERT_EQUAL(PWM_ON, fakePwmValues[3]);
+    TEST_ASSERT_EQUAL(PWM_ON, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL]);
+    TEST_ASSERT_EQUAL(PWM_ON, mockLedcDuty[MOTOR_LEDC_FIRST_CHANNEL + 3]);
+}
+
+void test_limits_mask_uses_the_lever_bits(void)
+{
+    // The positive limit of the bucket is pressed at the start
+    mockGpioLevels[GPIO_NUM_19] = LOW;
+    machine->setupLimitSwitches();
+
+    TEST_ASSERT_TRUE(machine->motor(0).posLimitReached);
+    TEST_ASSERT_EQUAL(1U << (BUCKET_LEVER * 2), machine->limitsMask());
+
+    // The motor can't drive into the pressed limit, only away from it
+    int16_t levers[LEVERS_COUNT] = {0, 0, 0, 0, 0, 0};
+    levers[BUCKET_LEVER] = 200;
+    machine->applyLevers(levers);
+    TEST_ASSERT_EQUAL(0, machine->motor(0).commandedSpeed());
+    levers[BUCKET_LEVER] = -200;
+    machine->applyLevers(levers);
+    TEST_ASSERT_EQUAL(-200, machine->motor(0).commandedSpeed());
+
+    // Released and debounced by the update
+    mockGpioEdge(GPIO_NUM_19, HIGH);
+    mockMicros += LIMIT_DEBOUNCE_MAX_US + 1000;
+    machine->updateLimitSwitches();
+    TEST_ASSERT_EQUAL(0, machine->limitsMask());
+    machine->applyLevers(NEUTRAL);
+}
+
+void test_short_limit_pulse_stops_the_motor(void)
+{
+    machine->setupLimitSwitches();
+    int16_t levers[LEVERS_COUNT] = {0, 0, 0, 0, 0, 0};
+    levers[BUCKET_LEVER] = 200;
+    machine->applyLevers(levers);
+    TEST_ASSERT_EQUAL(200, machine->motor(0).commandedSpeed());
+
+    // The pulse has ended long before the update takes its edges
+    mockGpioEdge(GPIO_NUM_19, LOW);
+    mockMicros += 300;
+    mockGpioEdge(GPIO_NUM_19, HIGH);
+    mockMicros += LIMIT_DEBOUNCE_MAX_US + 1000;
+    machine->updateLimitSwitches();
+    TEST_ASSERT_EQUAL(0, machine->motor(0).commandedSpeed());
+    TEST_ASSERT_EQUAL(PWM_ON, fakePwmValues[0]);
+    TEST_ASSERT_EQUAL(0, machine->nextUpdateUs(mockMicros));
+
+    // The next update closes the burst as a glitch
+    machine->updateLimitSwitches();
+    TEST_ASSERT_EQUAL(0, machine->limitsMask());
+    LimitSwitchStats stats;
+    TEST_ASSERT_TRUE(machine->motor(0).limitSwitchStats(true, stats));
+    TEST_ASSERT_EQUAL(1, stats.glitches);
+}
+
+void test_idle_machine_has_no_deadline(void)
+{
+    TEST_ASSERT_EQUAL(UINT32_MAX, machine->nextUpdateUs(mockMicros));
+}
+
+void test_blocked_axis_has_no_position_deadline(void)
+{
+    static Machine<1, POSITION_AXIS> boom;
+    boom.setupOutputs();
+    boom.setupLimitSwitches();
+
+    int16_t levers[LEVERS_COUNT] = {0, 0, 0, 0, 0, 0};
+    levers[BOOM_LEVER] = 200;
+    boom.applyLevers(levers);
+    TEST_ASSERT_EQUAL(200, boom.motor(0).commandedSpeed());
+    TEST_ASSERT_EQUAL(POSITION_UPDATE_PERIOD_US, boom.nextUpdateUs(mockMicros));
+
+    // The axis reaches its limit, the debouncer closes the burst of the press
+    mockGpioEdge(GPIO_NUM_19, LOW);
+    boom.updateLimitSwitches();
+    TEST_ASSERT_TRUE(boom.motor(0).posLimitReached);
+    mockMicros += LIMIT_DEBOUNCE_MAX_US + 1000;
+    boom.updateLimitSwitches();
+
+    // The lever is still held, but the standing axis has nothing to integrate
+    boom.applyLevers(levers);
+    TEST_ASSERT_EQUAL(0, boom.motor(0).commandedSpeed());
+    TEST_ASSERT_EQUAL(UINT32_MAX, boom.nextUpdateUs(mockMicros));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_descriptions_are_validated);
+    RUN_TEST(test_ledc_channels_follow_the_table);
+    RUN_TEST(test_outputs_are_stopped_at_setup);
+    RUN_TEST(test_levers_are_dispatched_by_the_table);
+    RUN_TEST(test_stop_all_brakes_immediately);
+    RUN_TEST(test_limits_mask_uses_the_lever_bits);
+    RUN_TEST(test_short_limit_pulse_stops_the_motor);
+    RUN_TEST(test_idle_machine_has_no_deadline);
+    RUN_TEST(test_blocked_axis_has_no_position_deadline);
+    return UNITY_END();
+}
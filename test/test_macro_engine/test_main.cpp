@@ -0,0 +1,287 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <string.h>
+#include <unity.h>
+
+#include "macro_engine.h"
+
+MacroEngine engine;
+int16_t levers[LEVERS_COUNT];
+
+const int16_t NEUTRAL[LEVERS_COUNT] = {0, 0, 0, 0, 0, 0};
+const int16_t BOOM_UP[LEVERS_COUNT] = {200, 0, 0, 0, 0, 0};
+const int16_t BUCKET_IN[LEVERS_COUNT] = {0, 0, 150, 0, 0, 0};
+
+/**
+ * @brief Record the samples every 20 ms like the control frames, from the start time to the end time.
+ */
+void _recordFor(uint32_t fromMs, uint32_t toMs, const int16_t vector[LEVERS_COUNT], uint16_t limits = 0)
+{
+    for (uint32_t now = fromMs; now < toMs; now += 20)
+        engine.record(now, vector, limits);
+}
+
+void setUp(void)
+{
+    engine = MacroEngine();
+    memset(levers, 0x55, sizeof(levers));
+}
+
+void tearDown(void) {}
+
+void test_recording_merges_samples_into_steps(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, 500, NEUTRAL); // Idle time before the first movement is skipped
+    _recordFor(500, 1500, BOOM_UP);
+    _recordFor(1500, 2000, BUCKET_IN);
+    _recordFor(2000, 2400, NEUTRAL);
+    TEST_ASSERT_TRUE(engine.stopRecording(2400));
+
+    // The trailing idle step is dropped
+    const Macro &macro = engine.macro();
+    TEST_ASSERT_EQUAL(MACRO_IDLE, engine.state());
+    TEST_ASSERT_EQUAL(2, macro.stepsCount);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BOOM_UP, macro.steps[0].levers, LEVERS_COUNT);
+    TEST_ASSERT_EQUAL(1000, macro.steps[0].durationMs);
+    TEST_ASSERT_EQUAL(MACRO_STEP_HOLD, macro.steps[0].type);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BUCKET_IN, macro.steps[1].levers, LEVERS_COUNT);
+    TEST_ASSERT_EQUAL(500, macro.steps[1].durationMs);
+}
+
+void test_recording_tolerates_lever_noise(void)
+{
+    int16_t noisy[LEVERS_COUNT];
+    memcpy(noisy, BOOM_UP, sizeof(noisy));
+
+    engine.startRecording(0, 0);
+    engine.record(0, BOOM_UP, 0);
+    noisy[0] += MACRO_RECORD_TOLERANCE;
+    engine.record(20, noisy, 0);
+    noisy[0] -= 2 * MACRO_RECORD_TOLERANCE;
+    engine.record(40, noisy, 0);
+    TEST_ASSERT_TRUE(engine.stopRecording(60));
+    TEST_ASSERT_EQUAL(1, engine.macro().stepsCount);
+}
+
+void test_empty_recording(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, 1000, NEUTRAL);
+    TEST_ASSERT_FALSE(engine.stopRecording(1000));
+    TEST_ASSERT_FALSE(engine.startPlayback(1000, 0));
+    TEST_ASSERT_EQUAL(MACRO_IDLE, engine.state());
+}
+
+void test_long_steps_are_split(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, MACRO_MAX_STEP_DURATION + 1000, BOOM_UP);
+    engine.stopRecording(MACRO_MAX_STEP_DURATION + 1000);
+
+    TEST_ASSERT_EQUAL(2, engine.macro().stepsCount);
+    TEST_ASSERT_EQUAL(MACRO_MAX_STEP_DURATION, engine.macro().steps[0].durationMs);
+}
+
+void test_recording_stops_when_full(void)
+{
+    engine.startRecording(0, 0);
+    for (uint32_t i = 0; i < MACRO_MAX_STEPS + 10; i++)
+        engine.record(i * 100, i % 2 ? BOOM_UP : BUCKET_IN, 0);
+
+    TEST_ASSERT_EQUAL(MACRO_IDLE, engine.state());
+    TEST_ASSERT_EQUAL(MACRO_MAX_STEPS, engine.macro().stepsCount);
+    TEST_ASSERT_FALSE(engine.stopRecording(100000));
+}
+
+void test_playback_follows_the_recorded_timing(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, 1000, BOOM_UP);
+    _recordFor(1000, 1500, BUCKET_IN);
+    engine.stopRecording(1500);
+
+    TEST_ASSERT_TRUE(engine.startPlayback(10000, 0));
+    TEST_ASSERT_TRUE(engine.tick(10000, 0, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BOOM_UP, levers, LEVERS_COUNT);
+    TEST_ASSERT_TRUE(engine.tick(10999, 0, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BOOM_UP, levers, LEVERS_COUNT);
+    TEST_ASSERT_TRUE(engine.tick(11000, 0, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BUCKET_IN, levers, LEVERS_COUNT);
+
+    TEST_ASSERT_FALSE(engine.tick(11500, 0, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(NEUTRAL, levers, LEVERS_COUNT);
+    TEST_ASSERT_EQUAL(MACRO_STOP_FINISHED, engine.stopReason());
+    TEST_ASSERT_EQUAL(MACRO_IDLE, engine.state());
+}
+
+void test_late_ticks_do_not_drift(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, 100, BOOM_UP);
+    _recordFor(100, 200, BUCKET_IN);
+    _recordFor(200, 300, BOOM_UP);
+    engine.stopRecording(300);
+
+    // One late tick skips the whole second step, the third one ends on time
+    engine.startPlayback(0, 0);
+    TEST_ASSERT_TRUE(engine.tick(250, 0, levers));
+    TEST_ASSERT_EQUAL(2, engine.currentStep());
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BOOM_UP, levers, LEVERS_COUNT);
+    TEST_ASSERT_FALSE(engine.tick(300, 0, levers));
+}
+
+void test_waypoint_step_waits_for_the_limit_switch(void)
+{
+    const uint16_t boomUpLimit = 1U << MACRO_LIMIT_BIT(0, false);
+
+    engine.startRecording(0, 0);
+    _recordFor(0, 400, BOOM_UP);
+    engine.record(400, BUCKET_IN, boomUpLimit);
+    _recordFor(420, 800, BUCKET_IN, boomUpLimit);
+    engine.stopRecording(800);
+
+    const Macro &macro = engine.macro();
+    TEST_ASSERT_EQUAL(2, macro.stepsCount);
+    TEST_ASSERT_EQUAL(MACRO_STEP_UNTIL_WAYPOINT, macro.steps[0].type);
+    TEST_ASSERT_EQUAL(MACRO_LIMIT_BIT(0, false), macro.steps[0].waypointBit);
+    TEST_ASSERT_EQUAL(400 * MACRO_WAYPOINT_TIMEOUT_PCT / 100, macro.steps[0].durationMs);
+
+    // The step lasts past its recorded time until the switch fires
+    engine.startPlayback(0, 0);
+    TEST_ASSERT_TRUE(engine.tick(700, 0, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BOOM_UP, levers, LEVERS_COUNT);
+    TEST_ASSERT_TRUE(engine.tick(720, boomUpLimit, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BUCKET_IN, levers, LEVERS_COUNT);
+    TEST_ASSERT_TRUE(engine.tick(1100, boomUpLimit, levers));
+    TEST_ASSERT_FALSE(engine.tick(1120, boomUpLimit, levers));
+    TEST_ASSERT_EQUAL(MACRO_STOP_FINISHED, engine.stopReason());
+}
+
+void test_waypoint_gets_minimum_timeout(void)
+{
+    engine.startRecording(0, 0);
+    engine.record(0, BOOM_UP, 0);
+    engine.record(20, BOOM_UP, 1);
+    engine.stopRecording(40);
+    TEST_ASSERT_EQUAL(MACRO_WAYPOINT_MIN_TIMEOUT, engine.macro().steps[0].durationMs);
+}
+
+void test_missed_waypoint_stops_playback(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, 400, BOOM_UP);
+    engine.record(400, BUCKET_IN, 1);
+    _recordFor(420, 800, BUCKET_IN, 1);
+    engine.stopRecording(800);
+
+    engine.startPlayback(0, 0);
+    TEST_ASSERT_TRUE(engine.tick(799, 0, levers));
+    TEST_ASSERT_FALSE(engine.tick(800, 0, levers));
+    TEST_ASSERT_EQUAL(MACRO_STOP_WAYPOINT_MISSED, engine.stopReason());
+    TEST_ASSERT_EQUAL(0, engine.currentStep());
+    TEST_ASSERT_EQUAL_INT16_ARRAY(NEUTRAL, levers, LEVERS_COUNT);
+}
+
+void test_unexpected_limit_switch_guards_playback(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, 1000, BOOM_UP);
+    engine.stopRecording(1000);
+
+    // A switch already pressed at the start is no reason to stop, a new one is
+    engine.startPlayback(0, 1U << 3);
+    TEST_ASSERT_TRUE(engine.tick(100, 1U << 3, levers));
+    TEST_ASSERT_FALSE(engine.tick(200, (1U << 3) | (1U << 4), levers));
+    TEST_ASSERT_EQUAL(MACRO_STOP_GUARD, engine.stopReason());
+}
+
+void test_operator_abort(void)
+{
+    engine.startRecording(0, 0);
+    _recordFor(0, 1000, BOOM_UP);
+    engine.stopRecording(1000);
+
+    int16_t input[LEVERS_COUNT] = {0, 0, 0, 0, 0, 0};
+    input[4] = MACRO_ABORT_THRESHOLD;
+    TEST_ASSERT_FALSE(MacroEngine::isOperatorInput(input));
+    input[4] = -MACRO_ABORT_THRESHOLD - 1;
+    TEST_ASSERT_TRUE(MacroEngine::isOperatorInput(input));
+
+    engine.startPlayback(0, 0);
+    engine.abort(MACRO_STOP_OPERATOR);
+    TEST_ASSERT_EQUAL(MACRO_IDLE, engine.state());
+    TEST_ASSERT_EQUAL(MACRO_STOP_OPERATOR, engine.stopReason());
+    TEST_ASSERT_FALSE(engine.tick(100, 0, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(NEUTRAL, levers, LEVERS_COUNT);
+}
+
+void test_state_machine_rejects_wrong_transitions(void)
+{
+    // Nothing to stop or abort while idle
+    TEST_ASSERT_FALSE(engine.stopRecording(0));
+    engine.abort(MACRO_STOP_OPERATOR);
+    TEST_ASSERT_EQUAL(MACRO_STOP_NONE, engine.stopReason());
+
+    engine.startRecording(0, 0);
+    _recordFor(0, 100, BOOM_UP);
+    TEST_ASSERT_FALSE(engine.startPlayback(100, 0));
+    engine.stopRecording(100);
+
+    engine.startPlayback(100, 0);
+    TEST_ASSERT_FALSE(engine.startPlayback(150, 0));
+    TEST_ASSERT_FALSE(engine.stopRecording(150));
+    engine.record(150, BUCKET_IN, 0);
+    TEST_ASSERT_EQUAL(1, engine.macro().stepsCount);
+}
+
+void test_load(void)
+{
+    static Macro macro;
+    macro.stepsCount = 1;
+    memcpy(macro.steps[0].levers, BUCKET_IN, sizeof(BUCKET_IN));
+    macro.steps[0].durationMs = 300;
+    macro.steps[0].type = MACRO_STEP_HOLD;
+    macro.steps[0].waypointBit = MACRO_NO_WAYPOINT;
+
+    engine.load(macro);
+    TEST_ASSERT_TRUE(engine.startPlayback(0, 0));
+    TEST_ASSERT_TRUE(engine.tick(0, 0, levers));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(BUCKET_IN, levers, LEVERS_COUNT);
+
+    // Not replaced while playing, and never with an oversized macro
+    macro.stepsCount = 2;
+    engine.load(macro);
+    TEST_ASSERT_EQUAL(1, engine.macro().stepsCount);
+    engine.abort(MACRO_STOP_OPERATOR);
+    macro.stepsCount = MACRO_MAX_STEPS + 1;
+    engine.load(macro);
+    TEST_ASSERT_EQUAL(1, engine.macro().stepsCount);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_recording_merges_samples_into_steps);
+    RUN_TEST(test_recording_tolerates_lever_noise);
+    RUN_TEST(test_empty_recording);
+    RUN_TEST(test_long_steps_are_split);
+    RUN_TEST(test_recording_stops_when_full);
+    RUN_TEST(test_playback_follows_the_recorded_timing);
+    RUN_TEST(test_late_ticks_do_not_drift);
+    RUN_TEST(test_waypoint_step_waits_for_the_limit_switch);
+    RUN_TEST(test_waypoint_gets_minimum_timeout);
+    RUN_TEST(test_missed_waypoint_stops_playback);
+    RUN_TEST(test_unexpected_limit_switch_guards_playback);
+    RUN_TEST(test_operator_abort);
+    RUN_TEST(test_state_machine_rejects_wrong_transitions);
+    RUN_TEST(test_load);
+    return UNITY_END();
+}
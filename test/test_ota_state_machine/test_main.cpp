@@ -0,0 +1,169 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "ota_state_machine.h"
+
+OtaStateMachine ota;
+
+void setUp(void)
+{
+    ota = OtaStateMachine();
+}
+
+void tearDown(void) {}
+
+void test_update_parks_the_actuators_until_reboot(void)
+{
+    TEST_ASSERT_EQUAL(OTA_IDLE, ota.state());
+    TEST_ASSERT_FALSE(ota.actuatorsParked());
+
+    TEST_ASSERT_TRUE(ota.begin());
+    TEST_ASSERT_EQUAL(OTA_RECEIVING, ota.state());
+    TEST_ASSERT_TRUE(ota.actuatorsParked());
+    TEST_ASSERT_EQUAL(0, ota.progressPercent());
+
+    // A second update is not accepted during the transfer
+    TEST_ASSERT_FALSE(ota.begin());
+
+    ota.progress(512 * 1024, 1024 * 1024);
+    TEST_ASSERT_EQUAL(50, ota.progressPercent());
+
+    TEST_ASSERT_TRUE(ota.end());
+    TEST_ASSERT_EQUAL(OTA_VERIFYING, ota.state());
+    TEST_ASSERT_EQUAL(100, ota.progressPercent());
+    TEST_ASSERT_TRUE(ota.actuatorsParked());
+
+    ota.verified(true);
+    TEST_ASSERT_EQUAL(OTA_REBOOTING, ota.state());
+    TEST_ASSERT_TRUE(ota.actuatorsParked());
+}
+
+void test_progress_is_bounded(void)
+{
+    // No progress before the update starts
+    ota.progress(10, 100);
+    TEST_ASSERT_EQUAL(0, ota.progressPercent());
+
+    ota.begin();
+    ota.progress(10, 0);
+    TEST_ASSERT_EQUAL(0, ota.progressPercent());
+    ota.progress(4000000000UL, 4000000001UL);
+    TEST_ASSERT_EQUAL(99, ota.progressPercent());
+    ota.progress(200, 100);
+    TEST_ASSERT_EQUAL(100, ota.progressPercent());
+}
+
+void test_invalid_image_resumes_control(void)
+{
+    ota.begin();
+    ota.end();
+    ota.verified(false);
+
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.state());
+    TEST_ASSERT_FALSE(ota.actuatorsParked());
+
+    // A failed update can be repeated
+    TEST_ASSERT_TRUE(ota.begin());
+    TEST_ASSERT_EQUAL(OTA_RECEIVING, ota.state());
+}
+
+void test_error_aborts_the_update(void)
+{
+    ota.begin();
+    ota.error();
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.state());
+    TEST_ASSERT_FALSE(ota.actuatorsParked());
+
+    ota.begin();
+    ota.end();
+    ota.error();
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.state());
+
+    // The verification result of an aborted update is ignored
+    ota.verified(true);
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.state());
+}
+
+void test_out_of_order_events_are_ignored(void)
+{
+    TEST_ASSERT_FALSE(ota.end());
+    ota.verified(true);
+    ota.error();
+    TEST_ASSERT_EQUAL(OTA_IDLE, ota.state());
+
+    // The valid image is not aborted while rebooting into it
+    ota.begin();
+    ota.end();
+    ota.verified(true);
+    ota.error();
+    TEST_ASSERT_FALSE(ota.end());
+    TEST_ASSERT_FALSE(ota.begin());
+    TEST_ASSERT_EQUAL(OTA_REBOOTING, ota.state());
+}
+
+void test_self_test_confirms_the_image(void)
+{
+    ota.startSelfTest(1000);
+    TEST_ASSERT_EQUAL(OTA_SELF_TEST, ota.state());
+    TEST_ASSERT_FALSE(ota.actuatorsParked());
+
+    // No update is accepted before the running image is confirmed
+    TEST_ASSERT_FALSE(ota.begin());
+
+    TEST_ASSERT_EQUAL(OTA_SELF_TEST, ota.selfTestTick(2000, false, true));
+    TEST_ASSERT_EQUAL(OTA_SELF_TEST, ota.selfTestTick(3000, true, false));
+    TEST_ASSERT_EQUAL(OTA_IDLE, ota.selfTestTick(1000 + OTA_SELF_TEST_TIMEOUT_MS - 1, true, true));
+    TEST_ASSERT_TRUE(ota.begin());
+}
+
+void test_failed_self_test_rolls_back(void)
+{
+    ota.startSelfTest(1000);
+    TEST_ASSERT_EQUAL(OTA_SELF_TEST, ota.selfTestTick(1000 + OTA_SELF_TEST_TIMEOUT_MS - 1, false, true));
+    TEST_ASSERT_EQUAL(OTA_ROLLING_BACK, ota.selfTestTick(1000 + OTA_SELF_TEST_TIMEOUT_MS, false, true));
+    TEST_ASSERT_TRUE(ota.actuatorsParked());
+
+    // The checks passing too late do not stop the rollback
+    TEST_ASSERT_EQUAL(OTA_ROLLING_BACK, ota.selfTestTick(1000 + OTA_SELF_TEST_TIMEOUT_MS + 1, true, true));
+    TEST_ASSERT_FALSE(ota.begin());
+}
+
+void test_self_test_timeout_over_millis_wraparound(void)
+{
+    const uint32_t start = UINT32_MAX - 1000;
+
+    ota.startSelfTest(start);
+    TEST_ASSERT_EQUAL(OTA_SELF_TEST, ota.selfTestTick(start + OTA_SELF_TEST_TIMEOUT_MS - 1, false, false));
+    TEST_ASSERT_EQUAL(OTA_ROLLING_BACK, ota.selfTestTick(start + OTA_SELF_TEST_TIMEOUT_MS, false, false));
+}
+
+void test_state_names(void)
+{
+    TEST_ASSERT_EQUAL_STRING("idle", otaStateToString(OTA_IDLE));
+    TEST_ASSERT_EQUAL_STRING("self-test", otaStateToString(OTA_SELF_TEST));
+    TEST_ASSERT_EQUAL_STRING("rolling back", otaStateToString(OTA_ROLLING_BACK));
+    TEST_ASSERT_EQUAL_STRING("unknown", otaStateToString((OtaState)100));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_update_parks_the_actuators_until_reboot);
+    RUN_TEST(test_progress_is_bounded);
+    RUN_TEST(test_invalid_image_resumes_control);
+    RUN_TEST(test_error_aborts_the_update);
+    RUN_TEST(test_out_of_order_events_are_ignored);
+    RUN_TEST(test_self_test_confirms_the_image);
+    RUN_TEST(test_failed_self_test_rolls_back);
+    RUN_TEST(test_self_test_timeout_over_millis_wraparound);
+    RUN_TEST(test_state_names);
+    return UNITY_END();
+}
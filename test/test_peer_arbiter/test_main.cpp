@@ -0,0 +1,149 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "peer_arbiter.h"
+
+PeerArbiter arbiter;
+
+const uint8_t OPERATOR_A[PEER_MAC_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+const uint8_t OPERATOR_B[PEER_MAC_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+const uint8_t SUPERVISOR[PEER_MAC_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x03};
+const uint8_t UNKNOWN[PEER_MAC_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x04};
+
+void setUp(void)
+{
+    arbiter = PeerArbiter();
+    arbiter.addPeer(OPERATOR_A, PEER_PRIORITY_OPERATOR);
+    arbiter.addPeer(OPERATOR_B, PEER_PRIORITY_OPERATOR);
+    arbiter.addPeer(SUPERVISOR, PEER_PRIORITY_SUPERVISOR);
+}
+
+void tearDown(void) {}
+
+void test_peer_table(void)
+{
+    TEST_ASSERT_EQUAL(3, arbiter.count());
+    TEST_ASSERT_EQUAL(1, arbiter.findPeer(OPERATOR_B));
+    TEST_ASSERT_EQUAL(-1, arbiter.findPeer(UNKNOWN));
+
+    // Adding a known peer only updates its priority
+    TEST_ASSERT_EQUAL(1, arbiter.addPeer(OPERATOR_B, PEER_PRIORITY_SUPERVISOR));
+    TEST_ASSERT_EQUAL(3, arbiter.count());
+    TEST_ASSERT_EQUAL(PEER_PRIORITY_SUPERVISOR, arbiter.peer(1).priority);
+
+    TEST_ASSERT_EQUAL(3, arbiter.addPeer(UNKNOWN, PEER_PRIORITY_OPERATOR));
+    const uint8_t extra[PEER_MAC_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x05};
+    TEST_ASSERT_EQUAL(-1, arbiter.addPeer(extra, PEER_PRIORITY_OPERATOR));
+}
+
+void test_unknown_sender_is_rejected(void)
+{
+    TEST_ASSERT_EQUAL(PEER_REJECTED_UNKNOWN, arbiter.onFrame(UNKNOWN, 0));
+    TEST_ASSERT_EQUAL(PEER_NONE, arbiter.activeIndex());
+}
+
+void test_first_sender_takes_control(void)
+{
+    TEST_ASSERT_TRUE(arbiter.isActiveTimedOut(0));
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_A, 100));
+    TEST_ASSERT_EQUAL(0, arbiter.activeIndex());
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED, arbiter.onFrame(OPERATOR_A, 120));
+    TEST_ASSERT_EQUAL(120, arbiter.peer(0).lastSeenMs);
+
+    // Same priority can't take over while the active peer talks
+    TEST_ASSERT_EQUAL(PEER_REJECTED_LOWER_PRIORITY, arbiter.onFrame(OPERATOR_B, 140));
+    TEST_ASSERT_EQUAL(0, arbiter.activeIndex());
+}
+
+void test_silent_peer_loses_control(void)
+{
+    arbiter.onFrame(OPERATOR_A, 0);
+
+    TEST_ASSERT_FALSE(arbiter.isActiveTimedOut(PEER_ACTIVE_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL(PEER_REJECTED_LOWER_PRIORITY, arbiter.onFrame(OPERATOR_B, PEER_ACTIVE_TIMEOUT_MS));
+    TEST_ASSERT_TRUE(arbiter.isActiveTimedOut(PEER_ACTIVE_TIMEOUT_MS + 1));
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_B, PEER_ACTIVE_TIMEOUT_MS + 1));
+    TEST_ASSERT_EQUAL(1, arbiter.activeIndex());
+
+    // A timed out peer is not locked out, it gets control back once the other one goes silent
+    TEST_ASSERT_EQUAL(PEER_REJECTED_LOWER_PRIORITY, arbiter.onFrame(OPERATOR_A, PEER_ACTIVE_TIMEOUT_MS + 2));
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_A, 2 * PEER_ACTIVE_TIMEOUT_MS + 2));
+}
+
+void test_higher_priority_overrides_and_locks_out(void)
+{
+    arbiter.onFrame(OPERATOR_A, 0);
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(SUPERVISOR, 10));
+    TEST_ASSERT_EQUAL(2, arbiter.activeIndex());
+    TEST_ASSERT_EQUAL(10 + PEER_LOCKOUT_MS, arbiter.peer(0).lockedUntilMs);
+
+    // The overridden peer stays locked out even after the supervisor goes silent
+    TEST_ASSERT_EQUAL(PEER_REJECTED_LOCKED_OUT, arbiter.onFrame(OPERATOR_A, 20));
+    TEST_ASSERT_EQUAL(PEER_REJECTED_LOCKED_OUT, arbiter.onFrame(OPERATOR_A, 10 + PEER_LOCKOUT_MS - 1));
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_A, 10 + PEER_LOCKOUT_MS));
+    TEST_ASSERT_EQUAL(0, arbiter.activeIndex());
+
+    // Another operator was never overridden and may take control of a silent supervisor
+    setUp();
+    arbiter.onFrame(OPERATOR_A, 0);
+    arbiter.onFrame(SUPERVISOR, 10);
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_B, 20 + PEER_ACTIVE_TIMEOUT_MS));
+}
+
+void test_lockout_survives_time_wraparound(void)
+{
+    const uint32_t start = UINT32_MAX - 100;
+
+    arbiter.onFrame(OPERATOR_A, start);
+    arbiter.onFrame(SUPERVISOR, start + 10);
+    TEST_ASSERT_EQUAL(PEER_REJECTED_LOCKED_OUT, arbiter.onFrame(OPERATOR_A, start + 200));
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED, arbiter.onFrame(SUPERVISOR, start + 200));
+    TEST_ASSERT_FALSE(arbiter.isActiveTimedOut(start + 300));
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_A, start + 10 + PEER_LOCKOUT_MS));
+}
+
+void test_never_overridden_peer_is_not_locked_out(void)
+{
+    // After 24.8 days of uptime the time is in the upper half of the range
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_A, 0x80000010));
+}
+
+void test_remove_peer_keeps_the_active_one(void)
+{
+    arbiter.onFrame(SUPERVISOR, 0);
+    TEST_ASSERT_EQUAL(2, arbiter.activeIndex());
+
+    // The last entry moves into the removed slot, the active index follows it
+    TEST_ASSERT_TRUE(arbiter.removePeer(OPERATOR_A));
+    TEST_ASSERT_FALSE(arbiter.removePeer(OPERATOR_A));
+    TEST_ASSERT_EQUAL(2, arbiter.count());
+    TEST_ASSERT_EQUAL(0, arbiter.activeIndex());
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED, arbiter.onFrame(SUPERVISOR, 10));
+
+    // Removing the active peer releases control
+    TEST_ASSERT_TRUE(arbiter.removePeer(SUPERVISOR));
+    TEST_ASSERT_EQUAL(PEER_NONE, arbiter.activeIndex());
+    TEST_ASSERT_EQUAL(PEER_ACCEPTED_HANDOVER, arbiter.onFrame(OPERATOR_B, 20));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_peer_table);
+    RUN_TEST(test_unknown_sender_is_rejected);
+    RUN_TEST(test_first_sender_takes_control);
+    RUN_TEST(test_silent_peer_loses_control);
+    RUN_TEST(test_higher_priority_overrides_and_locks_out);
+    RUN_TEST(test_lockout_survives_time_wraparound);
+    RUN_TEST(test_never_overridden_peer_is_not_locked_out);
+    RUN_TEST(test_remove_peer_keeps_the_active_one);
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "position_estimator.h"
+
+// Axis with a 4 s full travel, a 20 % slow zone and a limit switch at the positive end only
+#define TRAVEL_MS 4000
+#define SLOW_ZONE (POSITION_FULL_TRAVEL / 5)
+
+PositionEstimator estimator(TRAVEL_MS, 200, true, false);
+
+void setUp(void)
+{
+    estimator = PositionEstimator(TRAVEL_MS, 200, true, false);
+}
+
+void tearDown(void) {}
+
+void test_disabled_estimator_passes_the_speed(void)
+{
+    PositionEstimator endless(0, 200, false, false);
+
+    TEST_ASSERT_FALSE(endless.enabled());
+    endless.calibrate(0);
+    endless.update(-255, 10000000);
+    TEST_ASSERT_EQUAL(0, endless.position());
+    TEST_ASSERT_EQUAL(-255, endless.limit(-255));
+}
+
+void test_full_speed_covers_the_travel_in_its_time(void)
+{
+    estimator.calibrate(0);
+    estimator.update(255, TRAVEL_MS * 1000UL / 2);
+    TEST_ASSERT_EQUAL(POSITION_CENTER, estimator.position());
+    estimator.update(255, TRAVEL_MS * 1000UL / 2);
+    TEST_ASSERT_EQUAL(POSITION_FULL_TRAVEL, estimator.position());
+
+    // Half the speed takes twice the time
+    estimator.update(-128, TRAVEL_MS * 1000UL);
+    TEST_ASSERT_INT_WITHIN(POSITION_FULL_TRAVEL / 255, POSITION_CENTER, estimator.position());
+}
+
+void test_short_steps_add_up(void)
+{
+    // 10 ms position updates, the rounding error is below one unit per step
+    estimator.calibrate(0);
+    for (uint16_t i = 0; i < 400; i++)
+        estimator.update(100, 10000);
+
+    int32_t expected = (int64_t)POSITION_FULL_TRAVEL * 100 / 255;
+    TEST_ASSERT_INT_WITHIN(400, expected, estimator.position());
+    TEST_ASSERT_TRUE(estimator.position() <= expected);
+}
+
+void test_estimate_stays_within_the_ends(void)
+{
+    estimator.calibrate(POSITION_FULL_TRAVEL - 1000);
+    estimator.update(255, 1000000);
+    TEST_ASSERT_EQUAL(POSITION_FULL_TRAVEL, estimator.position());
+
+    // The way back starts from the end, not from beyond it
+    estimator.update(-255, 40000);
+    TEST_ASSERT_EQUAL(POSITION_FULL_TRAVEL - 10000, estimator.position());
+
+    estimator.calibrate(1000);
+    estimator.update(-255, 1000000);
+    TEST_ASSERT_EQUAL(0, estimator.position());
+}
+
+void test_uncalibrated_axis_is_not_limited(void)
+{
+    TEST_ASSERT_FALSE(estimator.calibrated());
+    TEST_ASSERT_EQUAL(POSITION_CENTER, estimator.position());
+
+    // The estimate reaches the end, but the position is unknown since the boot
+    estimator.update(255, TRAVEL_MS * 1000UL);
+    TEST_ASSERT_EQUAL(POSITION_FULL_TRAVEL, estimator.position());
+    TEST_ASSERT_EQUAL(255, estimator.limit(255));
+    TEST_ASSERT_EQUAL(-255, estimator.limit(-255));
+}
+
+void test_speed_falls_in_the_slow_zone(void)
+{
+    // Outside of the slow zone
+    estimator.calibrate(POSITION_FULL_TRAVEL - SLOW_ZONE);
+    TEST_ASSERT_EQUAL(255, estimator.limit(255));
+
+    // Halfway through the zone the maximum is halfway between the creep and the full speed
+    estimator.calibrate(POSITION_FULL_TRAVEL - SLOW_ZONE / 2);
+    int16_t halfway = POSITION_CREEP_SPEED + (POSITION_MAX_SPEED - POSITION_CREEP_SPEED) / 2;
+    TEST_ASSERT_EQUAL(halfway, estimator.limit(255));
+    TEST_ASSERT_EQUAL(100, estimator.limit(100));
+
+    // Close to the end only the creep speed is left, away from it the speed is free
+    estimator.calibrate(POSITION_FULL_TRAVEL - 1);
+    TEST_ASSERT_EQUAL(POSITION_CREEP_SPEED, estimator.limit(255));
+    TEST_ASSERT_EQUAL(-255, estimator.limit(-255));
+
+    // The negative end is mirrored
+    estimator.calibrate(SLOW_ZONE / 2);
+    TEST_ASSERT_EQUAL(-halfway, estimator.limit(-255));
+    TEST_ASSERT_EQUAL(255, estimator.limit(255));
+}
+
+void test_end_with_a_switch_creeps_onto_it(void)
+{
+    estimator.calibrate(POSITION_FULL_TRAVEL);
+    TEST_ASSERT_EQUAL(POSITION_CREEP_SPEED, estimator.limit(255));
+    TEST_ASSERT_EQUAL(50, estimator.limit(50));
+    TEST_ASSERT_EQUAL(0, estimator.limit(0));
+}
+
+void test_end_without_a_switch_stops(void)
+{
+    estimator.calibrate(0);
+    TEST_ASSERT_EQUAL(0, estimator.limit(-255));
+    TEST_ASSERT_EQUAL(0, estimator.limit(-1));
+    TEST_ASSERT_EQUAL(255, estimator.limit(255));
+}
+
+void test_axis_without_slow_zone_stops_only_at_the_end(void)
+{
+    PositionEstimator swing(TRAVEL_MS, 0, false, false);
+
+    swing.calibrate(POSITION_CENTER);
+    TEST_ASSERT_EQUAL(255, swing.limit(255));
+    swing.calibrate(POSITION_FULL_TRAVEL - 1);
+    TEST_ASSERT_EQUAL(255, swing.limit(255));
+    swing.calibrate(POSITION_FULL_TRAVEL);
+    TEST_ASSERT_EQUAL(0, swing.limit(255));
+    TEST_ASSERT_EQUAL(-255, swing.limit(-255));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_disabled_estimator_passes_the_speed);
+    RUN_TEST(test_full_speed_covers_the_travel_in_its_time);
+    RUN_TEST(test_short_steps_add_up);
+    RUN_TEST(test_estimate_stays_within_the_ends);
+    RUN_TEST(test_uncalibrated_axis_is_not_limited);
+    RUN_TEST(test_speed_falls_in_the_slow_zone);
+    RUN_TEST(test_end_with_a_switch_creeps_onto_it);
+    RUN_TEST(test_end_without_a_switch_stops);
+    RUN_TEST(test_axis_without_slow_zone_stops_only_at_the_end);
+    return UNITY_END();
+}
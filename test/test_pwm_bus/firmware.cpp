@@ -0,0 +1,18 @@
+/**
+ * @file firmware.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+// Four expanders alternating between the two buses, so the channel count grows on both buses together
+#define PWM_EXPANDERS_TABLE {{0x40, 0}, {0x41, 1}, {0x42, 0}, {0x43, 1}}
+
+// The PWM controller is built only for this suite on the mocked buses, the tasks are never started
+#include "pwm_controller.cpp"
+
+// Both buses are used, each gets its own stack
+static_assert(PWM_USED_BUS_COUNT == 2, "Both buses must be used");
+static_assert(sizeof(pwmTaskStacks) == 2 * TASK_PLAN[TASK_PWM].stackSize, "Stacks must be sized by the used buses");
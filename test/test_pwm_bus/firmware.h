@@ -0,0 +1,28 @@
+/**
+ * @file firmware.h
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#ifndef FIRMWARE_H
+#define FIRMWARE_H
+
+#include <Arduino.h>
+
+#include "pwm_controller.h"
+#include "pwm_scheduler.h"
+#include "task_plan.h"
+
+// Internals of pwm_controller.cpp run by the tests in place of the writer tasks
+#define TEST_BUS_COUNT      2
+#define TEST_EXPANDER_COUNT 4
+
+extern PwmScheduler pwmScheduler;
+
+bool _initExpanders(uint8_t busIndex);
+bool _flushBus(uint8_t busIndex);
+
+#endif // FIRMWARE_H
@@ -0,0 +1,229 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <Adafruit_PWMServoDriver.h>
+#include <Arduino.h>
+#include <Wire.h>
+#include <unity.h>
+
+#include "firmware.h"
+
+/*
+ * Bus time of one frame of the PWM writer tasks with 16, 32 and 64 channels on the mocked I2C buses.
+ * The buses are written in parallel, so a frame takes as long as the slowest bus.
+ */
+
+TwoWire *const testBuses[TEST_BUS_COUNT] = {&Wire, &Wire1};
+const uint8_t testAddresses[TEST_EXPANDER_COUNT] = {0x40, 0x41, 0x42, 0x43};
+
+uint32_t testFaultReports = 0;
+uint16_t testRound = 0;
+
+void _onPwmFault(bool fault)
+{
+    testFaultReports++;
+}
+
+/**
+ * @brief Write the pending channels of both buses like their writer tasks.
+ *
+ * @param busNs Output: bus time of the frame on every bus.
+ * @return Bus time of the frame, the longest of the buses.
+ */
+uint64_t _writeFrame(uint64_t busNs[TEST_BUS_COUNT] = NULL)
+{
+    uint64_t frameNs = 0;
+    for (uint8_t bus = 0; bus < TEST_BUS_COUNT; bus++)
+    {
+        uint64_t start = testBuses[bus]->busNs;
+        TEST_ASSERT_TRUE(_flushBus(bus));
+        uint64_t duration = testBuses[bus]->busNs - start;
+        frameNs = max(frameNs, duration);
+        if (busNs != NULL)
+            busNs[bus] = duration;
+    }
+    return frameNs;
+}
+
+/**
+ * @brief Change the first channels to new values.
+ */
+void _changeChannels(uint8_t count)
+{
+    testRound++;
+    for (uint8_t channel = 0; channel < count; channel++)
+        setPinPWM(channel, 1 + (channel * 7 + testRound * 13) % (PWM_ON - 1));
+}
+
+/**
+ * @brief Bus time of the channels written one transaction each, like the single-channel driver calls.
+ */
+uint64_t _unbatchedNs(uint8_t count)
+{
+    uint64_t busNs[TEST_BUS_COUNT] = {};
+    for (uint8_t channel = 0; channel < count; channel++)
+    {
+        uint8_t expander = channel / PWM_CHANNELS_PER_EXPANDER;
+        TwoWire *wire = testBuses[expander % TEST_BUS_COUNT];
+        Adafruit_PWMServoDriver driver(testAddresses[expander], *wire);
+
+        uint64_t start = wire->busNs;
+        driver.setPWM(channel % PWM_CHANNELS_PER_EXPANDER, 0, 2048);
+        busNs[expander % TEST_BUS_COUNT] += wire->busNs - start;
+    }
+    return max(busNs[0], busNs[1]);
+}
+
+// Bus time of one transaction with len bytes after the address at the default 100 kHz clock
+uint64_t _transactionNs(size_t len)
+{
+    return (1 + (1 + len) * 9 + 1) * 10000ULL;
+}
+
+void setUp(void)
+{
+    static bool started = false;
+
+    for (uint8_t bus = 0; bus < TEST_BUS_COUNT; bus++)
+    {
+        *testBuses[bus] = TwoWire(bus);
+        for (uint8_t i = 0; i < TEST_EXPANDER_COUNT; i++)
+            testBuses[bus]->present[testAddresses[i]] = i % TEST_BUS_COUNT == bus;
+        testBuses[bus]->begin();
+    }
+
+    if (!started)
+    {
+        pwmTaskInit(_onPwmFault);
+        started = true;
+    }
+
+    // Boot of the writer tasks: all channels are written once
+    for (uint8_t bus = 0; bus < TEST_BUS_COUNT; bus++)
+        TEST_ASSERT_TRUE(_initExpanders(bus));
+    _writeFrame();
+}
+
+void tearDown(void) {}
+
+void test_writer_task_per_used_bus(void)
+{
+    TEST_ASSERT_NOT_NULL(mockTasks[0]);
+    TEST_ASSERT_NOT_NULL(mockTasks[1]);
+    TEST_ASSERT_TRUE(mockTasks[0] != mockTasks[1]);
+    TEST_ASSERT_NULL(mockTasks[2]);
+    TEST_ASSERT_TRUE(pwmIsExpanderReady());
+}
+
+void test_boot_frame_writes_all_channels(void)
+{
+    // The frame of setUp() wrote every expander in one burst
+    for (uint8_t bus = 0; bus < TEST_BUS_COUNT; bus++)
+        TEST_ASSERT_EQUAL(0, testBuses[bus]->errors);
+
+    _changeChannels(PWM_CHANNELS_PER_EXPANDER * TEST_EXPANDER_COUNT);
+    uint32_t transactions = Wire.transactions + Wire1.transactions;
+    _writeFrame();
+    TEST_ASSERT_EQUAL(TEST_EXPANDER_COUNT, Wire.transactions + Wire1.transactions - transactions);
+}
+
+void test_frame_writes_the_values(void)
+{
+    setPinPWM(PWM_CHANNEL(2, 5), PWM_ON / 2);
+    setPinPWM(PWM_CHANNEL(3, 0), PWM_OFF);
+    setPinPWM(PWM_CHANNEL(1, 15), PWM_ON);
+    _writeFrame();
+
+    uint8_t reg = PCA9685_LED0_ON_L + 5 * PCA9685_BYTES_PER_LED;
+    uint16_t on = Wire.reg16(0x42, reg);
+    uint16_t off = Wire.reg16(0x42, reg + 2);
+    TEST_ASSERT_EQUAL(map(PWM_ON / 2, 0, PWM_ON, 0, 4095), (off - on) & 0xFFF);
+
+    // Full off and full on do not switch at all
+    TEST_ASSERT_EQUAL(PCA9685_FULL, Wire1.reg16(0x43, PCA9685_LED0_ON_L + 2));
+    reg = PCA9685_LED0_ON_L + 15 * PCA9685_BYTES_PER_LED;
+    TEST_ASSERT_EQUAL(PCA9685_FULL, Wire1.reg16(0x41, reg));
+    TEST_ASSERT_EQUAL(0, Wire1.reg16(0x41, reg + 2));
+}
+
+void test_frame_time_by_channel_count(void)
+{
+    const uint8_t counts[] = {16, 32, 64};
+    uint64_t batchedNs[3];
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        uint64_t busNs[TEST_BUS_COUNT];
+        _changeChannels(counts[i]);
+        batchedNs[i] = _writeFrame(busNs);
+        uint64_t unbatchedNs = _unbatchedNs(counts[i]);
+
+        char message[160];
+        snprintf(message, sizeof(message), "%2d channels: frame %5lu us (bus 0 %5lu us, bus 1 %5lu us), unbatched %5lu us",
+                 counts[i], (unsigned long)(batchedNs[i] / 1000), (unsigned long)(busNs[0] / 1000),
+                 (unsigned long)(busNs[1] / 1000), (unsigned long)(unbatchedNs / 1000));
+        TEST_MESSAGE(message);
+
+        TEST_ASSERT_LESS_THAN(unbatchedNs, batchedNs[i]);
+    }
+
+    // One burst per expander, the second bus takes every other expander
+    TEST_ASSERT_EQUAL(_transactionNs(PWM_BURST_BUFFER_SIZE), batchedNs[0]);
+    TEST_ASSERT_EQUAL(batchedNs[0], batchedNs[1]);
+    TEST_ASSERT_EQUAL(2 * batchedNs[0], batchedNs[2]);
+}
+
+void test_single_change_frame_is_flat(void)
+{
+    // A motor command changes one channel, its frame does not grow with the other expanders
+    uint64_t busNs[TEST_BUS_COUNT];
+
+    setPinPWM(PWM_CHANNEL(0, 14), 100);
+    TEST_ASSERT_EQUAL(_transactionNs(1 + PCA9685_BYTES_PER_LED), _writeFrame(busNs));
+    TEST_ASSERT_EQUAL(0, busNs[1]);
+
+    setPinPWM(PWM_CHANNEL(3, 14), 100);
+    TEST_ASSERT_EQUAL(_transactionNs(1 + PCA9685_BYTES_PER_LED), _writeFrame(busNs));
+    TEST_ASSERT_EQUAL(0, busNs[0]);
+
+    // Both inputs of a motor are adjacent and go in one transaction
+    setPinPWM(PWM_CHANNEL(2, 4), 200);
+    setPinPWM(PWM_CHANNEL(2, 5), 0);
+    TEST_ASSERT_EQUAL(_transactionNs(1 + 2 * PCA9685_BYTES_PER_LED), _writeFrame());
+
+    // Unchanged values are not written again
+    setPinPWM(PWM_CHANNEL(2, 4), 200);
+    TEST_ASSERT_EQUAL(0, _writeFrame());
+}
+
+void test_latest_value_wins(void)
+{
+    // A slow bus never builds up a backlog, only the newest value of a channel is written
+    for (uint16_t value = 1; value <= 100; value++)
+        setPinPWM(PWM_CHANNEL(1, 3), value);
+
+    uint32_t transactions = Wire1.transactions;
+    _writeFrame();
+    TEST_ASSERT_EQUAL(1, Wire1.transactions - transactions);
+
+    uint8_t reg = PCA9685_LED0_ON_L + 3 * PCA9685_BYTES_PER_LED;
+    TEST_ASSERT_EQUAL(map(100, 0, PWM_ON, 0, 4095), (Wire1.reg16(0x41, reg + 2) - Wire1.reg16(0x41, reg)) & 0xFFF);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_writer_task_per_used_bus);
+    RUN_TEST(test_boot_frame_writes_all_channels);
+    RUN_TEST(test_frame_writes_the_values);
+    RUN_TEST(test_frame_time_by_channel_count);
+    RUN_TEST(test_single_change_frame_is_flat);
+    RUN_TEST(test_latest_value_wins);
+    return UNITY_END();
+}
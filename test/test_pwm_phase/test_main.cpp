@@ -0,0 +1,132 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <string.h>
+#include <unity.h>
+
+#include "pwm_phase.h"
+
+// Three motors on the first expander, the two inputs of a motor in one group, and a pump on the second one
+const PwmLoad LOADS[] = {
+    {.channel = 0, .group = 0, .currentMa = 1000},
+    {.channel = 1, .group = 0, .currentMa = 1000},
+    {.channel = 2, .group = 1, .currentMa = 2500},
+    {.channel = 3, .group = 1, .currentMa = 2000},
+    {.channel = 8, .group = 2, .currentMa = 500},
+    {.channel = 9, .group = 2, .currentMa = 500},
+    {.channel = PWM_CHANNELS_PER_EXPANDER + 4, .group = 3, .currentMa = 3000},
+};
+#define LOADS_COUNT (sizeof(LOADS) / sizeof(LOADS[0]))
+
+uint16_t phases[PWM_CHANNELS_PER_EXPANDER];
+uint16_t values[PWM_CHANNELS_PER_EXPANDER];
+
+void setUp(void)
+{
+    memset(phases, 0x55, sizeof(phases));
+    memset(values, 0, sizeof(values));
+}
+
+void tearDown(void) {}
+
+void test_heaviest_groups_are_furthest_apart(void)
+{
+    pwmPlanPhases(LOADS, LOADS_COUNT, 0, phases);
+
+    // The group current is its largest load, the groups take the van der Corput points in that order
+    TEST_ASSERT_EQUAL(0, phases[2]);
+    TEST_ASSERT_EQUAL(0, phases[3]);
+    TEST_ASSERT_EQUAL(PWM_PERIOD_COUNTS / 2, phases[0]);
+    TEST_ASSERT_EQUAL(PWM_PERIOD_COUNTS / 2, phases[1]);
+    TEST_ASSERT_EQUAL(PWM_PERIOD_COUNTS / 4, phases[8]);
+    TEST_ASSERT_EQUAL(PWM_PERIOD_COUNTS / 4, phases[9]);
+
+    // Pins without a load and the loads of the other expander are left at 0
+    TEST_ASSERT_EQUAL(0, phases[4]);
+    TEST_ASSERT_EQUAL(0, phases[15]);
+}
+
+void test_every_expander_is_planned_on_its_own(void)
+{
+    // The pump is the only load of its expander, the motors of the first one do not shift it
+    pwmPlanPhases(LOADS, LOADS_COUNT, 1, phases);
+    for (uint8_t pin = 0; pin < PWM_CHANNELS_PER_EXPANDER; pin++)
+        TEST_ASSERT_EQUAL(0, phases[pin]);
+
+    pwmPlanPhases(LOADS, LOADS_COUNT, 2, phases);
+    for (uint8_t pin = 0; pin < PWM_CHANNELS_PER_EXPANDER; pin++)
+        TEST_ASSERT_EQUAL(0, phases[pin]);
+}
+
+void test_equal_groups_keep_their_order(void)
+{
+    PwmLoad loads[PWM_CHANNELS_PER_EXPANDER];
+    for (uint8_t i = 0; i < PWM_CHANNELS_PER_EXPANDER; i++)
+        loads[i] = {.channel = i, .group = i, .currentMa = 1000};
+
+    pwmPlanPhases(loads, PWM_CHANNELS_PER_EXPANDER, 0, phases);
+
+    const uint16_t expected[] = {0, 2048, 1024, 3072, 512, 2560, 1536, 3584,
+                                 256, 2304, 1280, 3328, 768, 2816, 1792, 3840};
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected, phases, PWM_CHANNELS_PER_EXPANDER);
+}
+
+void test_spread_phases_lower_the_peak(void)
+{
+    PwmLoad loads[4];
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        loads[i] = {.channel = i, .group = i, .currentMa = 1000};
+        values[i] = PWM_PERIOD_COUNTS / 4;
+    }
+
+    // All loads turn on together
+    memset(phases, 0, sizeof(phases));
+    TEST_ASSERT_EQUAL(4000, pwmPeakCurrentMa(loads, 4, 0, phases, values));
+
+    // A quarter of the period each, the planned loads never overlap
+    pwmPlanPhases(loads, 4, 0, phases);
+    TEST_ASSERT_EQUAL(1000, pwmPeakCurrentMa(loads, 4, 0, phases, values));
+
+    // Half of the period each, two loads overlap at most
+    for (uint8_t i = 0; i < 4; i++)
+        values[i] = PWM_PERIOD_COUNTS / 2;
+    TEST_ASSERT_EQUAL(2000, pwmPeakCurrentMa(loads, 4, 0, phases, values));
+}
+
+void test_peak_counts_full_and_off_channels(void)
+{
+    pwmPlanPhases(LOADS, LOADS_COUNT, 0, phases);
+
+    // Nothing is on
+    TEST_ASSERT_EQUAL(0, pwmPeakCurrentMa(LOADS, LOADS_COUNT, 0, phases, values));
+
+    // A fully on load adds to every other load, the inputs of the motor are never on together
+    values[2] = 4095;
+    values[0] = 100;
+    TEST_ASSERT_EQUAL(3500, pwmPeakCurrentMa(LOADS, LOADS_COUNT, 0, phases, values));
+    values[2] = 0;
+    TEST_ASSERT_EQUAL(1000, pwmPeakCurrentMa(LOADS, LOADS_COUNT, 0, phases, values));
+
+    // The pump on the second expander runs from the values of its own pins
+    values[4] = 4095;
+    TEST_ASSERT_EQUAL(1000, pwmPeakCurrentMa(LOADS, LOADS_COUNT, 0, phases, values));
+    TEST_ASSERT_EQUAL(3000, pwmPeakCurrentMa(LOADS, LOADS_COUNT, 1, phases, values));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_heaviest_groups_are_furthest_apart);
+    RUN_TEST(test_every_expander_is_planned_on_its_own);
+    RUN_TEST(test_equal_groups_keep_their_order);
+    RUN_TEST(test_spread_phases_lower_the_peak);
+    RUN_TEST(test_peak_counts_full_and_off_channels);
+    return UNITY_END();
+}
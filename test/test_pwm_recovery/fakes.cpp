@@ -0,0 +1,17 @@
+/**
+ * @file fakes.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <Arduino.h>
+
+#include "supervisor.h"
+#include "task_plan.h"
+
+void supervisorFeed() {}
+
+void taskPlanRegister(TaskId id, TaskHandle_t handle) {}
@@ -0,0 +1,295 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+// The PWM controller is built into this suite, the tests run its writer task cycles on the mocked bus
+#include "pwm_controller.cpp"
+
+/*
+ * I2C faults injected into the mocked bus of the expander: NACKs, a slave holding SDA low until it is
+ * clocked and an expander that is gone. The outputs must be restored from the commanded values after
+ * a recovery and disabled while the recovery fails.
+ */
+
+#define TEST_ADDRESS PCA9685_I2C_ADDRESS
+
+PwmBus *const testBus = &pwmBuses[0];
+bool testPending = true;
+
+// Reports of the fault callback, 1 for a fault and 0 for the enabled outputs
+int testReports[8];
+uint8_t testReportsCount = 0;
+
+// Slave holding SDA low, released after the number of SCL clocks
+uint8_t testStuckClocks = 0;
+uint8_t testClocks = 0;
+uint8_t testStops = 0;
+uint8_t testSclLevel = HIGH;
+
+void _onPwmFault(bool fault)
+{
+    if (testReportsCount < sizeof(testReports) / sizeof(testReports[0]))
+        testReports[testReportsCount++] = fault;
+}
+
+int _readGpio(uint8_t pin)
+{
+    if (pin == I2C0_SDA_PIN && Wire.sdaStuck)
+        return LOW;
+    return mockGpioLevels[pin];
+}
+
+void _writeGpio(uint8_t pin, uint8_t value)
+{
+    // Clock: SCL rises
+    if (pin == I2C0_SCL_PIN && value == HIGH && testSclLevel == LOW && Wire.sdaStuck)
+    {
+        testClocks++;
+        if (testClocks >= testStuckClocks)
+            Wire.sdaStuck = false;
+    }
+    if (pin == I2C0_SCL_PIN)
+        testSclLevel = value;
+
+    // STOP: SDA rises while SCL is high
+    if (pin == I2C0_SDA_PIN && value == HIGH && mockGpioLevels[I2C0_SCL_PIN] == HIGH)
+        testStops++;
+}
+
+/**
+ * @brief Run cycles of the writer task of the bus. The task waits for the changes made by the test
+ * before every cycle, the first cycle after the start writes all channels.
+ */
+void _runTask(uint8_t cycles)
+{
+    for (uint8_t i = 0; i < cycles; i++)
+    {
+        if (!testPending)
+            testPending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SUPERVISOR_FEED_INTERVAL_MS)) > 0;
+        _serviceBus(testBus, testPending);
+        testPending = false;
+    }
+}
+
+/**
+ * @brief Check the value of the channel in the expander registers.
+ */
+void _assertChannel(uint8_t pin, uint16_t value)
+{
+    uint8_t reg = PCA9685_LED0_ON_L + pin * PCA9685_BYTES_PER_LED;
+    uint16_t on = Wire.reg16(TEST_ADDRESS, reg);
+    uint16_t off = Wire.reg16(TEST_ADDRESS, reg + 2);
+    uint16_t pwmValue = map(value, 0, PWM_ON, 0, MAX_PWM_VALUE);
+
+    if (pwmValue == 0)
+        TEST_ASSERT_EQUAL(PCA9685_FULL, off);
+    else if (pwmValue >= MAX_PWM_VALUE)
+        TEST_ASSERT_EQUAL(PCA9685_FULL, on);
+    else
+        TEST_ASSERT_EQUAL(pwmValue, (off - on) & 0xFFF);
+}
+
+void _setChannels()
+{
+    setMotorPwm(14, 15, 700, PWM_OFF);
+    setMotorPwm(4, 5, PWM_ON, PWM_ON);
+    setPinPWM(LEFT_HEADLIGHT_PIN, 300);
+}
+
+void _assertChannels()
+{
+    _assertChannel(14, 700);
+    _assertChannel(15, PWM_OFF);
+    _assertChannel(4, PWM_ON);
+    _assertChannel(5, PWM_ON);
+    _assertChannel(LEFT_HEADLIGHT_PIN, 300);
+    _assertChannel(8, PWM_OFF);
+}
+
+void _bootBus(bool present)
+{
+    Wire.present[TEST_ADDRESS] = present;
+    _startBus(testBus);
+}
+
+void setUp(void)
+{
+    mockMicros = 0;
+    Wire = TwoWire(0);
+    mockGpioReadHook = _readGpio;
+    mockGpioWriteHook = _writeGpio;
+    testStuckClocks = testClocks = testStops = 0;
+    testSclLevel = HIGH;
+
+    // Power-on state of the controller
+    pwmScheduler = PwmScheduler();
+    pwmLoadsCount = 0;
+    testBus->fault = false;
+    testBus->written = false;
+    testBus->stats = PwmBusStats{};
+    pwmOutputsEnabled = false;
+    pwmI2cErrors = 0;
+    pwmRecoveries = 0;
+    testReportsCount = 0;
+    testPending = true;
+    Serial.output.clear();
+
+    pwmTaskInit(_onPwmFault);
+    mockCurrentTask = testBus->task;
+}
+
+void tearDown(void)
+{
+    mockGpioReadHook = NULL;
+    mockGpioWriteHook = NULL;
+}
+
+void test_boot_writes_all_channels(void)
+{
+    _bootBus(true);
+    _runTask(1);
+
+    TEST_ASSERT_TRUE(pwmIsExpanderReady());
+    for (uint8_t pin = 0; pin < PWM_CHANNELS_PER_EXPANDER; pin++)
+        _assertChannel(pin, PWM_OFF);
+
+    // The outputs are enabled once all channels were written
+    TEST_ASSERT_EQUAL(1, testReportsCount);
+    TEST_ASSERT_EQUAL(0, testReports[0]);
+    TEST_ASSERT_EQUAL(0, pwmGetHealth().i2cErrors);
+    TEST_ASSERT_EQUAL(1, pwmGetBusStats(0).frames);
+}
+
+void test_nack_is_recovered_and_channels_restored(void)
+{
+    _bootBus(true);
+    _runTask(1);
+    _setChannels();
+    _runTask(1);
+    _assertChannels();
+
+    // The expander was reset and NACKs the next frame
+    memset(Wire.registers[TEST_ADDRESS], 0, MOCK_I2C_REGISTERS);
+    Wire.nackCount[TEST_ADDRESS] = 1;
+    setPinPWM(RIGHT_HEADLIGHT_PIN, 100);
+    _runTask(2);
+
+    // All channels are written again from the commanded values, the outputs stay enabled
+    _assertChannels();
+    _assertChannel(RIGHT_HEADLIGHT_PIN, 100);
+    PwmHealth health = pwmGetHealth();
+    TEST_ASSERT_EQUAL(1, health.i2cErrors);
+    TEST_ASSERT_EQUAL(1, health.recoveries);
+    TEST_ASSERT_FALSE(health.fault);
+    TEST_ASSERT_EQUAL(1, testReportsCount);
+}
+
+void test_stuck_sda_is_released_by_clocking(void)
+{
+    _bootBus(true);
+    _runTask(1);
+    _setChannels();
+
+    // A slave holds SDA low in the middle of a byte, the driver times out
+    Wire.sdaStuck = true;
+    testStuckClocks = 5;
+    _runTask(2);
+
+    TEST_ASSERT_EQUAL(5, testClocks);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, testStops);
+    TEST_ASSERT_TRUE(Wire.started);
+    _assertChannels();
+
+    PwmHealth health = pwmGetHealth();
+    TEST_ASSERT_EQUAL(1, health.i2cErrors);
+    TEST_ASSERT_EQUAL(1, health.recoveries);
+    TEST_ASSERT_FALSE(health.fault);
+}
+
+void test_clocking_is_bounded(void)
+{
+    _bootBus(true);
+    _runTask(1);
+
+    // A bus held low for good gets at most nine clocks per clear
+    Wire.sdaStuck = true;
+    testStuckClocks = 255;
+    setPinPWM(RIGHT_HEADLIGHT_PIN, 100);
+    _runTask(1);
+
+    TEST_ASSERT_EQUAL(I2C_CLEAR_CLOCKS * PWM_RECOVERY_ATTEMPTS, testClocks);
+    TEST_ASSERT_TRUE(pwmHasFault());
+}
+
+void test_failed_recovery_disables_outputs_until_the_expander_returns(void)
+{
+    _bootBus(true);
+    _runTask(1);
+
+    // The expander is gone, every recovery attempt fails
+    Wire.present[TEST_ADDRESS] = false;
+    setPinPWM(RIGHT_HEADLIGHT_PIN, 100);
+    _runTask(1);
+
+    TEST_ASSERT_TRUE(pwmHasFault());
+    TEST_ASSERT_EQUAL(PWM_RECOVERY_ATTEMPTS, pwmGetHealth().recoveries);
+    TEST_ASSERT_EQUAL(2, testReportsCount);
+    TEST_ASSERT_EQUAL(1, testReports[1]);
+    TEST_ASSERT_TRUE(Serial.output.find("PWM output of bus 0 failed") != std::string::npos);
+
+    // The commands are kept while faulty, the bus is not written between the retries
+    _setChannels();
+    uint32_t transactions = Wire.transactions;
+    _runTask(PWM_RECOVERY_RETRY_MS / SUPERVISOR_FEED_INTERVAL_MS - 2);
+    TEST_ASSERT_EQUAL(transactions, Wire.transactions);
+
+    // The expander returns, the next retry restores the channels
+    Wire.present[TEST_ADDRESS] = true;
+    _runTask(3);
+
+    TEST_ASSERT_FALSE(pwmHasFault());
+    TEST_ASSERT_EQUAL(3, testReportsCount);
+    TEST_ASSERT_EQUAL(0, testReports[2]);
+    TEST_ASSERT_TRUE(Serial.output.find("PWM output of bus 0 recovered") != std::string::npos);
+    _assertChannels();
+    _assertChannel(RIGHT_HEADLIGHT_PIN, 100);
+}
+
+void test_boot_without_expander(void)
+{
+    _bootBus(false);
+
+    // The outputs were never enabled, the motor drivers stay asleep without a report
+    TEST_ASSERT_FALSE(pwmIsExpanderReady());
+    TEST_ASSERT_TRUE(pwmHasFault());
+    TEST_ASSERT_EQUAL(0, testReportsCount);
+    TEST_ASSERT_TRUE(Serial.output.find("PWM expander 0x40 is not responding") != std::string::npos);
+
+    _setChannels();
+    Wire.present[TEST_ADDRESS] = true;
+    _runTask(PWM_RECOVERY_RETRY_MS / SUPERVISOR_FEED_INTERVAL_MS + 2);
+
+    TEST_ASSERT_TRUE(pwmIsExpanderReady());
+    TEST_ASSERT_EQUAL(1, testReportsCount);
+    TEST_ASSERT_EQUAL(0, testReports[0]);
+    _assertChannels();
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_boot_writes_all_channels);
+    RUN_TEST(test_nack_is_recovered_and_channels_restored);
+    RUN_TEST(test_stuck_sda_is_released_by_clocking);
+    RUN_TEST(test_clocking_is_bounded);
+    RUN_TEST(test_failed_recovery_disables_outputs_until_the_expander_returns);
+    RUN_TEST(test_boot_without_expander);
+    return UNITY_END();
+}
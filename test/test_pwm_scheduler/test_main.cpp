@@ -0,0 +1,177 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <string.h>
+#include <unity.h>
+
+#include "pwm_scheduler.h"
+
+PwmScheduler scheduler;
+uint16_t values[PWM_CHANNELS_PER_EXPANDER];
+uint16_t phases[PWM_CHANNELS_PER_EXPANDER];
+uint8_t buffer[PWM_BURST_BUFFER_SIZE];
+
+// Read a little-endian register pair of the burst
+uint16_t _word(size_t offset)
+{
+    return buffer[offset] | (buffer[offset + 1] << 8);
+}
+
+void setUp(void)
+{
+    scheduler = PwmScheduler();
+    memset(values, 0, sizeof(values));
+    memset(phases, 0, sizeof(phases));
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void tearDown(void) {}
+
+void test_only_changes_are_taken(void)
+{
+    TEST_ASSERT_EQUAL_HEX16(0, scheduler.take(0, values));
+
+    TEST_ASSERT_TRUE(scheduler.set(3, 1000));
+    TEST_ASSERT_FALSE(scheduler.set(3, 1000));
+    TEST_ASSERT_FALSE(scheduler.set(4, 0));
+    TEST_ASSERT_TRUE(scheduler.set(15, 4095));
+
+    TEST_ASSERT_EQUAL_HEX16((1U << 3) | (1U << 15), scheduler.take(0, values));
+    TEST_ASSERT_EQUAL(1000, values[3]);
+    TEST_ASSERT_EQUAL(4095, values[15]);
+    TEST_ASSERT_EQUAL_HEX16(0, scheduler.take(0, values));
+}
+
+void test_latest_value_is_kept(void)
+{
+    scheduler.set(7, 100);
+    scheduler.set(7, 200);
+    scheduler.set(7, 300);
+
+    TEST_ASSERT_EQUAL_HEX16(1U << 7, scheduler.take(0, values));
+    TEST_ASSERT_EQUAL(300, values[7]);
+
+    // Going back to the written value is a change again
+    TEST_ASSERT_TRUE(scheduler.set(7, 100));
+    scheduler.values(0, values);
+    TEST_ASSERT_EQUAL(100, values[7]);
+    TEST_ASSERT_EQUAL_HEX16(1U << 7, scheduler.take(0, values));
+}
+
+void test_expanders_are_separate(void)
+{
+    TEST_ASSERT_TRUE(scheduler.set(PWM_CHANNELS_PER_EXPANDER + 2, 500));
+    TEST_ASSERT_FALSE(scheduler.set(PWM_MAX_CHANNELS, 500));
+
+    TEST_ASSERT_EQUAL_HEX16(0, scheduler.take(0, values));
+    TEST_ASSERT_EQUAL_HEX16(1U << 2, scheduler.take(1, values));
+    TEST_ASSERT_EQUAL(500, values[2]);
+    TEST_ASSERT_EQUAL_HEX16(0, scheduler.take(PWM_MAX_EXPANDERS, values));
+}
+
+void test_phases_and_invalidate_write_every_channel(void)
+{
+    for (uint8_t pin = 0; pin < PWM_CHANNELS_PER_EXPANDER; pin++)
+        phases[pin] = pin * 256;
+    phases[1] = 0x1FFF;
+    scheduler.setPhases(2, phases);
+
+    TEST_ASSERT_EQUAL(0xFFF, scheduler.phases(2)[1]);
+    TEST_ASSERT_EQUAL(15 * 256, scheduler.phases(2)[15]);
+    TEST_ASSERT_EQUAL(0, scheduler.phases(0)[15]);
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, scheduler.take(2, values));
+
+    scheduler.invalidate(3);
+    TEST_ASSERT_EQUAL_HEX16(0, scheduler.take(2, values));
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, scheduler.take(3, values));
+}
+
+void test_runs_of_adjacent_channels(void)
+{
+    // Channels 0, 5-6 and 12-14
+    const uint16_t mask = 0x7061;
+    const uint8_t expectedFirst[] = {0, 5, 12};
+    const uint8_t expectedCount[] = {1, 2, 3};
+
+    uint8_t first = 0;
+    uint8_t count = 0;
+    for (uint8_t run = 0; run < 3; run++)
+    {
+        TEST_ASSERT_TRUE(PwmScheduler::nextRun(mask, &first, &count));
+        TEST_ASSERT_EQUAL(expectedFirst[run], first);
+        TEST_ASSERT_EQUAL(expectedCount[run], count);
+        first += count;
+    }
+    TEST_ASSERT_FALSE(PwmScheduler::nextRun(mask, &first, &count));
+
+    first = 0;
+    TEST_ASSERT_TRUE(PwmScheduler::nextRun(0xFFFF, &first, &count));
+    TEST_ASSERT_EQUAL(0, first);
+    TEST_ASSERT_EQUAL(PWM_CHANNELS_PER_EXPANDER, count);
+
+    first = 0;
+    TEST_ASSERT_TRUE(PwmScheduler::nextRun(0x8000, &first, &count));
+    TEST_ASSERT_EQUAL(15, first);
+    TEST_ASSERT_EQUAL(1, count);
+
+    first = 0;
+    TEST_ASSERT_FALSE(PwmScheduler::nextRun(0, &first, &count));
+}
+
+void test_run_is_encoded_from_its_register(void)
+{
+    values[4] = 0;
+    values[5] = 4095;
+    values[6] = 1000;
+    values[7] = 200;
+    phases[4] = 100;
+    phases[5] = 100;
+    phases[6] = 512;
+    phases[7] = 4000;
+
+    size_t len = PwmScheduler::encodeRun(values, phases, 4, 4, buffer);
+    TEST_ASSERT_EQUAL(1 + 4 * PCA9685_BYTES_PER_LED, len);
+    TEST_ASSERT_EQUAL_HEX8(PCA9685_LED0_ON_L + 4 * PCA9685_BYTES_PER_LED, buffer[0]);
+
+    // Off and on channels do not switch at their phase
+    TEST_ASSERT_EQUAL_HEX16(0, _word(1));
+    TEST_ASSERT_EQUAL_HEX16(PCA9685_FULL, _word(3));
+    TEST_ASSERT_EQUAL_HEX16(PCA9685_FULL, _word(5));
+    TEST_ASSERT_EQUAL_HEX16(0, _word(7));
+
+    // The others turn on at their phase, the off count wraps around the period
+    TEST_ASSERT_EQUAL(512, _word(9));
+    TEST_ASSERT_EQUAL(1512, _word(11));
+    TEST_ASSERT_EQUAL(4000, _word(13));
+    TEST_ASSERT_EQUAL(104, _word(15));
+}
+
+void test_full_expander_fits_the_buffer(void)
+{
+    for (uint8_t pin = 0; pin < PWM_CHANNELS_PER_EXPANDER; pin++)
+        values[pin] = 2048;
+
+    size_t len = PwmScheduler::encodeRun(values, phases, 0, PWM_CHANNELS_PER_EXPANDER, buffer);
+    TEST_ASSERT_EQUAL(PWM_BURST_BUFFER_SIZE, len);
+    TEST_ASSERT_EQUAL_HEX8(PCA9685_LED0_ON_L, buffer[0]);
+    TEST_ASSERT_EQUAL(2048, _word(PWM_BURST_BUFFER_SIZE - 2));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_only_changes_are_taken);
+    RUN_TEST(test_latest_value_is_kept);
+    RUN_TEST(test_expanders_are_separate);
+    RUN_TEST(test_phases_and_invalidate_write_every_channel);
+    RUN_TEST(test_runs_of_adjacent_channels);
+    RUN_TEST(test_run_is_encoded_from_its_register);
+    RUN_TEST(test_full_expander_fits_the_buffer);
+    return UNITY_END();
+}
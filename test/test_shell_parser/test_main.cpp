@@ -0,0 +1,246 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "shell_parser.h"
+
+ShellParser parser;
+
+void setUp(void)
+{
+    parser = ShellParser();
+}
+
+void tearDown(void) {}
+
+/**
+ * @brief Feed the bytes and return the result of the last one.
+ */
+ShellResult _feed(const uint8_t *data, size_t len)
+{
+    ShellResult result = SHELL_PENDING;
+    for (size_t i = 0; i < len; i++)
+        result = parser.feed(data[i]);
+    return result;
+}
+
+ShellResult _feed(const char *text)
+{
+    return _feed((const uint8_t *)text, strlen(text));
+}
+
+void test_text_line_is_split_into_words(void)
+{
+    TEST_ASSERT_EQUAL(SHELL_PENDING, _feed("speed 2"));
+    TEST_ASSERT_EQUAL(SHELL_LINE, _feed("  \t-100\r\n"));
+    TEST_ASSERT_EQUAL(3, parser.line().argc);
+    TEST_ASSERT_EQUAL_STRING("speed", parser.line().argv[0]);
+    TEST_ASSERT_EQUAL_STRING("2", parser.line().argv[1]);
+    TEST_ASSERT_EQUAL_STRING("-100", parser.line().argv[2]);
+
+    TEST_ASSERT_EQUAL(SHELL_LINE, _feed("stats\n"));
+    TEST_ASSERT_EQUAL(1, parser.line().argc);
+    TEST_ASSERT_EQUAL_STRING("stats", parser.line().argv[0]);
+}
+
+void test_empty_lines_are_ignored(void)
+{
+    TEST_ASSERT_EQUAL(SHELL_PENDING, _feed("\n"));
+    TEST_ASSERT_EQUAL(SHELL_PENDING, _feed("  \t \r\n"));
+}
+
+void test_extra_words_are_dropped(void)
+{
+    TEST_ASSERT_EQUAL(SHELL_LINE, _feed("a b c d e f\n"));
+    TEST_ASSERT_EQUAL(SHELL_MAX_ARGS, parser.line().argc);
+    TEST_ASSERT_EQUAL_STRING("d", parser.line().argv[SHELL_MAX_ARGS - 1]);
+}
+
+void test_long_line_is_dropped(void)
+{
+    char line[SHELL_MAX_LINE + 2];
+
+    // The longest line fits
+    memset(line, 'x', SHELL_MAX_LINE - 1);
+    line[SHELL_MAX_LINE - 1] = '\n';
+    line[SHELL_MAX_LINE] = '\0';
+    TEST_ASSERT_EQUAL(SHELL_LINE, _feed(line));
+    TEST_ASSERT_EQUAL(SHELL_MAX_LINE - 1, strlen(parser.line().argv[0]));
+
+    // One more character drops the whole line, the next one is parsed again
+    memset(line, 'x', SHELL_MAX_LINE);
+    line[SHELL_MAX_LINE] = '\n';
+    line[SHELL_MAX_LINE + 1] = '\0';
+    TEST_ASSERT_EQUAL(SHELL_ERROR, _feed(line));
+    TEST_ASSERT_EQUAL(SHELL_LINE, _feed("help\n"));
+    TEST_ASSERT_EQUAL_STRING("help", parser.line().argv[0]);
+}
+
+void test_crc16_check_value(void)
+{
+    // Check value of CRC-16/CCITT-FALSE
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, shellCrc16((const uint8_t *)"123456789", 9));
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, shellCrc16(NULL, 0));
+}
+
+void test_cobs_round_trip(void)
+{
+    const uint8_t data[] = {0x00, 0x11, 0x00, 0x00, 0x22, 0x33, 0x00};
+    const uint8_t expected[] = {0x01, 0x02, 0x11, 0x01, 0x03, 0x22, 0x33, 0x01};
+    uint8_t encoded[16];
+    uint8_t decoded[16];
+
+    size_t len = shellCobsEncode(data, sizeof(data), encoded);
+    TEST_ASSERT_EQUAL(sizeof(expected), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, encoded, len);
+    TEST_ASSERT_EQUAL(sizeof(data), shellCobsDecode(encoded, len, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, decoded, sizeof(data));
+}
+
+void test_cobs_long_run_without_zeros(void)
+{
+    uint8_t data[300];
+    uint8_t encoded[310];
+    uint8_t decoded[300];
+
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = 1 + i % 255;
+
+    size_t len = shellCobsEncode(data, sizeof(data), encoded);
+    TEST_ASSERT_EQUAL(sizeof(data) + 2, len);
+    TEST_ASSERT_EQUAL(0xFF, encoded[0]);
+    for (size_t i = 0; i < len; i++)
+        TEST_ASSERT_NOT_EQUAL(0, encoded[i]);
+    TEST_ASSERT_EQUAL(sizeof(data), shellCobsDecode(encoded, len, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, decoded, sizeof(data));
+}
+
+void test_cobs_rejects_bad_data(void)
+{
+    uint8_t decoded[4];
+    const uint8_t zeroCode[] = {0x02, 0x11, 0x00, 0x22};
+    const uint8_t cutBlock[] = {0x05, 0x11, 0x22};
+    const uint8_t tooLong[] = {0x06, 0x11, 0x22, 0x33, 0x44, 0x55};
+
+    TEST_ASSERT_EQUAL(0, shellCobsDecode(zeroCode, sizeof(zeroCode), decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL(0, shellCobsDecode(cutBlock, sizeof(cutBlock), decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL(0, shellCobsDecode(tooLong, sizeof(tooLong), decoded, sizeof(decoded)));
+}
+
+void test_binary_frames_round_trip(void)
+{
+    uint8_t payload[SHELL_MAX_PAYLOAD];
+    uint8_t encoded[SHELL_COBS_BUFFER];
+
+    parser.setMode(SHELL_MODE_BINARY);
+    TEST_ASSERT_EQUAL(SHELL_MODE_BINARY, parser.mode());
+
+    for (size_t len = 0; len <= SHELL_MAX_PAYLOAD; len++)
+    {
+        // Payloads with zeros at every third byte
+        for (size_t i = 0; i < len; i++)
+            payload[i] = i % 3 == 0 ? 0 : (uint8_t)(len * 31 + i);
+
+        size_t size = shellEncodeFrame(0x40 + len, payload, len, encoded);
+        TEST_ASSERT_GREATER_THAN(0, size);
+        TEST_ASSERT_LESS_OR_EQUAL(SHELL_COBS_BUFFER, size);
+        TEST_ASSERT_EQUAL(0, encoded[size - 1]);
+
+        TEST_ASSERT_EQUAL(SHELL_FRAME, _feed(encoded, size));
+        TEST_ASSERT_EQUAL(0x40 + len, parser.frame().opcode);
+        TEST_ASSERT_EQUAL(len, parser.frame().len);
+        TEST_ASSERT_EQUAL_MEMORY(payload, parser.frame().payload, len);
+    }
+
+    TEST_ASSERT_EQUAL(0, shellEncodeFrame(0x01, payload, SHELL_MAX_PAYLOAD + 1, encoded));
+}
+
+void test_damaged_frames_are_rejected(void)
+{
+    const uint8_t payload[] = {0x01, 0x00, 0xFF, 0x7F};
+    uint8_t encoded[SHELL_COBS_BUFFER];
+
+    parser.setMode(SHELL_MODE_BINARY);
+    size_t size = shellEncodeFrame(0x10, payload, sizeof(payload), encoded);
+
+    // Any flipped bit is caught by the COBS structure or the CRC
+    for (size_t byte = 0; byte < size - 1; byte++)
+    {
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            uint8_t damaged[SHELL_COBS_BUFFER];
+            memcpy(damaged, encoded, size);
+            damaged[byte] ^= 1 << bit;
+            if (damaged[byte] == 0)
+                continue; // A new delimiter, tested below
+
+            TEST_ASSERT_EQUAL(SHELL_ERROR, _feed(damaged, size));
+        }
+    }
+
+    // A delimiter in the middle splits the frame into two damaged ones
+    uint8_t split[SHELL_COBS_BUFFER];
+    memcpy(split, encoded, size);
+    split[3] = 0;
+    TEST_ASSERT_EQUAL(SHELL_ERROR, _feed(split, 4));
+    TEST_ASSERT_EQUAL(SHELL_ERROR, _feed(split + 4, size - 4));
+
+    // The parser resynchronizes on the next delimiter
+    TEST_ASSERT_EQUAL(SHELL_FRAME, _feed(encoded, size));
+    TEST_ASSERT_EQUAL(sizeof(payload), parser.frame().len);
+}
+
+void test_oversized_frame_is_dropped(void)
+{
+    uint8_t noise[SHELL_COBS_BUFFER * 2];
+    memset(noise, 0x55, sizeof(noise));
+
+    parser.setMode(SHELL_MODE_BINARY);
+    TEST_ASSERT_EQUAL(SHELL_PENDING, _feed(noise, sizeof(noise)));
+    TEST_ASSERT_EQUAL(SHELL_ERROR, parser.feed(0));
+
+    // Repeated delimiters are idle bytes
+    TEST_ASSERT_EQUAL(SHELL_PENDING, parser.feed(0));
+}
+
+void test_mode_switch_drops_partial_input(void)
+{
+    const uint8_t payload[] = {0x05};
+    uint8_t encoded[SHELL_COBS_BUFFER];
+    size_t size = shellEncodeFrame(0x20, payload, sizeof(payload), encoded);
+
+    TEST_ASSERT_EQUAL(SHELL_PENDING, _feed("speed 1 1"));
+    parser.setMode(SHELL_MODE_BINARY);
+    TEST_ASSERT_EQUAL(SHELL_FRAME, _feed(encoded, size));
+
+    TEST_ASSERT_EQUAL(SHELL_PENDING, _feed(encoded, size - 1));
+    parser.setMode(SHELL_MODE_TEXT);
+    TEST_ASSERT_EQUAL(SHELL_LINE, _feed("stop\n"));
+    TEST_ASSERT_EQUAL(1, parser.line().argc);
+    TEST_ASSERT_EQUAL_STRING("stop", parser.line().argv[0]);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_text_line_is_split_into_words);
+    RUN_TEST(test_empty_lines_are_ignored);
+    RUN_TEST(test_extra_words_are_dropped);
+    RUN_TEST(test_long_line_is_dropped);
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_cobs_round_trip);
+    RUN_TEST(test_cobs_long_run_without_zeros);
+    RUN_TEST(test_cobs_rejects_bad_data);
+    RUN_TEST(test_binary_frames_round_trip);
+    RUN_TEST(test_damaged_frames_are_rejected);
+    RUN_TEST(test_oversized_frame_is_dropped);
+    RUN_TEST(test_mode_switch_drops_partial_input);
+    return UNITY_END();
+}
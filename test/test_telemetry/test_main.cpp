@@ -0,0 +1,224 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <unity.h>
+
+#include "telemetry.h"
+
+TelemetryEncoder encoder;
+TelemetryDecoder decoder;
+int32_t values[TLM_FIELD_COUNT];
+uint8_t frame[TELEMETRY_MAX_SIZE];
+
+// Frames sent until all slow fields were in a frame after a keyframe
+#define SLOW_ROUND ((TLM_FIELD_COUNT - TLM_FIRST_SLOW_FIELD + TELEMETRY_SLOW_PER_FRAME - 1) / TELEMETRY_SLOW_PER_FRAME)
+
+void setUp(void)
+{
+    encoder = TelemetryEncoder();
+    decoder = TelemetryDecoder();
+    for (uint8_t field = 0; field < TLM_FIELD_COUNT; field++)
+        values[field] = field * 100 - 700;
+}
+
+void tearDown(void) {}
+
+size_t _send()
+{
+    return encoder.encode(values, frame);
+}
+
+void _assertFields(uint8_t first, uint8_t last)
+{
+    for (uint8_t field = first; field < last; field++)
+        TEST_ASSERT_EQUAL(values[field], decoder.value((TelemetryField)field));
+}
+
+void test_varint_round_trip(void)
+{
+    const int32_t samples[] = {0, 1, -1, 63, -64, 64, -65, 8191, 100000, -100000, INT32_MAX, INT32_MIN};
+    const size_t lengths[] = {1, 1, 1, 1, 1, 2, 2, 2, 3, 3, 5, 5};
+    uint8_t buffer[5];
+
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++)
+    {
+        int32_t value = 0;
+        size_t len = telemetryPutVarint(samples[i], buffer);
+        TEST_ASSERT_EQUAL(lengths[i], len);
+        TEST_ASSERT_EQUAL(len, telemetryGetVarint(buffer, len, &value));
+        TEST_ASSERT_EQUAL(samples[i], value);
+
+        // A cut varint is not read
+        TEST_ASSERT_EQUAL(0, telemetryGetVarint(buffer, len - 1, &value));
+    }
+}
+
+void test_keyframe_carries_all_fields(void)
+{
+    size_t len = _send();
+
+    TEST_ASSERT_EQUAL(TELEMETRY_FLAG_KEYFRAME | TELEMETRY_VERSION, frame[0]);
+    TEST_ASSERT_EQUAL(1, frame[1]);
+    TEST_ASSERT_TRUE(decoder.decode(frame, len));
+    _assertFields(0, TLM_FIELD_COUNT);
+}
+
+void test_keyframe_fits_with_the_largest_values(void)
+{
+    for (uint8_t field = 0; field < TLM_FIELD_COUNT; field++)
+        values[field] = INT32_MIN;
+
+    size_t len = _send();
+    TEST_ASSERT_EQUAL(TELEMETRY_HEADER_SIZE + TLM_FIELD_COUNT * TELEMETRY_MAX_ENTRY_SIZE, len);
+    TEST_ASSERT_LESS_OR_EQUAL(TELEMETRY_MAX_SIZE, len);
+    TEST_ASSERT_TRUE(decoder.decode(frame, len));
+    _assertFields(0, TLM_FIELD_COUNT);
+}
+
+void test_delta_frames_round_trip(void)
+{
+    TEST_ASSERT_TRUE(decoder.decode(frame, _send()));
+
+    for (uint8_t i = 1; i < TELEMETRY_KEYFRAME_INTERVAL; i++)
+    {
+        values[TLM_BOOM_DUTY] = (i * 37) % 511 - 255;
+        values[TLM_LIMITS] = i & 0x0F;
+        values[TLM_UPTIME] += 1;
+        values[TLM_BATTERY] -= 3;
+
+        size_t len = _send();
+        TEST_ASSERT_EQUAL(TELEMETRY_VERSION, frame[0]);
+        TEST_ASSERT_TRUE(decoder.decode(frame, len));
+
+        // Fast fields are sent in every frame
+        _assertFields(0, TLM_FIRST_SLOW_FIELD);
+    }
+
+    // The slow fields are current once all of them had their turn
+    for (uint8_t i = 0; i < SLOW_ROUND; i++)
+        TEST_ASSERT_TRUE(decoder.decode(frame, _send()));
+    _assertFields(0, TLM_FIELD_COUNT);
+}
+
+void test_delta_frames_are_small(void)
+{
+    _send();
+
+    // Small changes take one byte per field and value
+    values[TLM_SWING_DUTY] += 20;
+    size_t len = _send();
+    TEST_ASSERT_EQUAL(TELEMETRY_HEADER_SIZE + (TLM_FIRST_SLOW_FIELD + TELEMETRY_SLOW_PER_FRAME) * 2, len);
+}
+
+void test_lost_frames_do_not_corrupt_the_next_ones(void)
+{
+    TEST_ASSERT_TRUE(decoder.decode(frame, _send()));
+
+    for (uint8_t i = 1; i < 3 * TELEMETRY_KEYFRAME_INTERVAL; i++)
+    {
+        for (uint8_t field = 0; field < TLM_FIELD_COUNT; field++)
+            values[field] += (i * 7 + field * 3) % 9 - 4;
+
+        size_t len = _send();
+        if (i % 5 == 2 || i % 7 == 3)
+            continue;
+
+        // Every frame refers to the keyframe, not to the previous frame
+        TEST_ASSERT_TRUE(decoder.decode(frame, len));
+        _assertFields(0, TLM_FIRST_SLOW_FIELD);
+    }
+}
+
+void test_frames_of_a_lost_keyframe_are_dropped(void)
+{
+    TEST_ASSERT_TRUE(decoder.decode(frame, _send()));
+    for (uint8_t i = 1; i < TELEMETRY_KEYFRAME_INTERVAL; i++)
+        _send();
+
+    // The second keyframe is lost
+    values[TLM_BOOM_DUTY] = 200;
+    size_t len = _send();
+    TEST_ASSERT_TRUE(frame[0] & TELEMETRY_FLAG_KEYFRAME);
+    TEST_ASSERT_EQUAL(2, frame[1]);
+
+    values[TLM_BOOM_DUTY] = 201;
+    TEST_ASSERT_FALSE(decoder.decode(frame, _send()));
+    TEST_ASSERT_EQUAL(-700, decoder.value(TLM_BOOM_DUTY));
+
+    // The decoder recovers with the next keyframe
+    for (uint8_t i = 2; i < TELEMETRY_KEYFRAME_INTERVAL; i++)
+        _send();
+    values[TLM_BOOM_DUTY] = 202;
+    len = _send();
+    TEST_ASSERT_EQUAL(3, frame[1]);
+    TEST_ASSERT_TRUE(decoder.decode(frame, len));
+    _assertFields(0, TLM_FIELD_COUNT);
+}
+
+void test_counters_wrap_around(void)
+{
+    values[TLM_LINK_ACCEPTED] = INT32_MAX - 5;
+    values[TLM_UPTIME] = -3;
+    TEST_ASSERT_TRUE(decoder.decode(frame, _send()));
+
+    // The counters are unsigned on both sides, the difference stays small over the wraparound
+    values[TLM_LINK_ACCEPTED] = (int32_t)((uint32_t)INT32_MAX + 10);
+    values[TLM_UPTIME] = 4;
+    for (uint8_t i = 0; i < SLOW_ROUND; i++)
+        TEST_ASSERT_TRUE(decoder.decode(frame, _send()));
+
+    TEST_ASSERT_EQUAL(INT32_MIN + 9, decoder.value(TLM_LINK_ACCEPTED));
+    TEST_ASSERT_EQUAL(4, decoder.value(TLM_UPTIME));
+}
+
+void test_malformed_frames_change_nothing(void)
+{
+    TEST_ASSERT_TRUE(decoder.decode(frame, _send()));
+    values[TLM_BOOM_DUTY] = 100;
+    size_t len = _send();
+    uint8_t bad[TELEMETRY_MAX_SIZE];
+
+    // Other format version
+    memcpy(bad, frame, len);
+    bad[0] = (bad[0] & ~TELEMETRY_VERSION_MASK) | (TELEMETRY_VERSION + 1);
+    TEST_ASSERT_FALSE(decoder.decode(bad, len));
+
+    // Unknown field after valid entries
+    memcpy(bad, frame, len);
+    bad[len] = TLM_FIELD_COUNT;
+    bad[len + 1] = 0;
+    TEST_ASSERT_FALSE(decoder.decode(bad, len + 2));
+
+    // Varint cut at the end of the frame
+    memcpy(bad, frame, len);
+    bad[len] = TLM_BOOM_DUTY;
+    bad[len + 1] = 0x80;
+    TEST_ASSERT_FALSE(decoder.decode(bad, len + 2));
+
+    TEST_ASSERT_FALSE(decoder.decode(frame, 1));
+    TEST_ASSERT_EQUAL(-700, decoder.value(TLM_BOOM_DUTY));
+
+    TEST_ASSERT_TRUE(decoder.decode(frame, len));
+    TEST_ASSERT_EQUAL(100, decoder.value(TLM_BOOM_DUTY));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_varint_round_trip);
+    RUN_TEST(test_keyframe_carries_all_fields);
+    RUN_TEST(test_keyframe_fits_with_the_largest_values);
+    RUN_TEST(test_delta_frames_round_trip);
+    RUN_TEST(test_delta_frames_are_small);
+    RUN_TEST(test_lost_frames_do_not_corrupt_the_next_ones);
+    RUN_TEST(test_frames_of_a_lost_keyframe_are_dropped);
+    RUN_TEST(test_counters_wrap_around);
+    RUN_TEST(test_malformed_frames_change_nothing);
+    return UNITY_END();
+}
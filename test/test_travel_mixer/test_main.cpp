@@ -0,0 +1,145 @@
+/**
+ * @file test_main.cpp
+ * @author SenMorgan https://github.com/SenMorgan
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026 Sen Morgan
+ *
+ */
+
+#include <stdio.h>
+#include <unity.h>
+
+#include "travel_mixer.h"
+
+TravelMixerConfig config;
+
+/**
+ * @brief Mix the levers and check the track speeds.
+ */
+void _assertMix(int16_t left, int16_t right, int16_t expectedLeft, int16_t expectedRight)
+{
+    char message[48];
+    snprintf(message, sizeof(message), "levers %d, %d", left, right);
+    travelMix(config, left, right);
+    TEST_ASSERT_EQUAL_MESSAGE(expectedLeft, left, message);
+    TEST_ASSERT_EQUAL_MESSAGE(expectedRight, right, message);
+}
+
+void setUp(void)
+{
+    config = TRAVEL_MIXER_DEFAULTS;
+}
+
+void tearDown(void) {}
+
+void test_config_validation(void)
+{
+    TEST_ASSERT_TRUE(travelMixerConfigValid(config));
+
+    TravelMixerConfig bad = config;
+    bad.mode = TRAVEL_MODE_COUNT;
+    TEST_ASSERT_FALSE(travelMixerConfigValid(bad));
+    bad = config;
+    bad.trimLeft = TRAVEL_TRIM_FULL + 1;
+    TEST_ASSERT_FALSE(travelMixerConfigValid(bad));
+    bad = config;
+    bad.trimRight = TRAVEL_TRIM_FULL + 1;
+    TEST_ASSERT_FALSE(travelMixerConfigValid(bad));
+    bad = config;
+    bad.counterRotationMax = -1;
+    TEST_ASSERT_FALSE(travelMixerConfigValid(bad));
+    bad = config;
+    bad.straightBand = TRAVEL_MAX_SPEED + 1;
+    TEST_ASSERT_FALSE(travelMixerConfigValid(bad));
+}
+
+void test_tank_mode_drives_each_track(void)
+{
+    _assertMix(0, 0, 0, 0);
+    _assertMix(200, 100, 200, 100);
+    _assertMix(-255, -100, -255, -100);
+    _assertMix(255, 0, 255, 0);
+    _assertMix(0, -30, 0, -30);
+}
+
+void test_tank_mode_holds_small_differences_straight(void)
+{
+    _assertMix(200, 180, 190, 190);
+    _assertMix(-180, -204, -192, -192);
+    _assertMix(255, 255 - 24, 243, 243);
+    _assertMix(255, 255 - 25, 255, 230);
+
+    // A track that stands or turns the other way is not straightened
+    _assertMix(20, 0, 20, 0);
+    _assertMix(10, -10, 10, -10);
+}
+
+void test_counter_rotation_keeps_the_turn_radius(void)
+{
+    _assertMix(255, -255, 160, -160);
+    _assertMix(200, -50, 160, -40);
+    _assertMix(-100, 200, -80, 160);
+
+    // Below the limit nothing changes
+    _assertMix(160, -160, 160, -160);
+
+    config.counterRotationMax = 0;
+    _assertMix(100, -100, 0, 0);
+    _assertMix(100, 100, 100, 100);
+}
+
+void test_mixed_mode_throttle_and_steering(void)
+{
+    config.mode = TRAVEL_MODE_MIXED;
+
+    _assertMix(200, 0, 200, 200);
+    _assertMix(-200, 0, -200, -200);
+
+    // Steering within the band is straight travel
+    _assertMix(200, 24, 200, 200);
+    _assertMix(200, -24, 200, 200);
+    _assertMix(100, 50, 150, 50);
+
+    // The sum over the full speed is scaled down with the ratio of the tracks
+    _assertMix(200, 100, 255, 85);
+    _assertMix(-200, 100, -85, -255);
+    _assertMix(-255, 255, 0, -255);
+}
+
+void test_mixed_mode_pivot_is_limited(void)
+{
+    config.mode = TRAVEL_MODE_MIXED;
+
+    _assertMix(0, 255, 160, -160);
+    _assertMix(0, -100, -100, 100);
+    _assertMix(50, 200, 160, -96);
+}
+
+void test_trim_slows_down_the_faster_track(void)
+{
+    config.trimLeft = 900;
+    _assertMix(200, 200, 180, 200);
+    _assertMix(-255, -255, -229, -255);
+
+    // The trim follows the straight band and the counter-rotation limit
+    _assertMix(200, 190, 175, 195);
+    _assertMix(255, -255, 144, -160);
+
+    config.trimLeft = TRAVEL_TRIM_FULL;
+    config.trimRight = 0;
+    _assertMix(100, 100, 100, 0);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_config_validation);
+    RUN_TEST(test_tank_mode_drives_each_track);
+    RUN_TEST(test_tank_mode_holds_small_differences_straight);
+    RUN_TEST(test_counter_rotation_keeps_the_turn_radius);
+    RUN_TEST(test_mixed_mode_throttle_and_steering);
+    RUN_TEST(test_mixed_mode_pivot_is_limited);
+    RUN_TEST(test_trim_slows_down_the_faster_track);
+    return UNITY_END();
+}